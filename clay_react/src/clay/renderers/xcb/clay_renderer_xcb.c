@@ -55,6 +55,7 @@ typedef struct {
     int image_byte_order;
     bool swap_bytes;
     uint8_t *buffer;
+    size_t buffer_capacity;
     uint32_t red_mask;
     uint32_t green_mask;
     uint32_t blue_mask;
@@ -765,7 +766,8 @@ static bool Clay_XCB_Init(Clay_XCB_Renderer *renderer,
     int pad = format->scanline_pad;
     renderer->stride = ((renderer->width * (int)format->bits_per_pixel + pad - 1) & ~(pad - 1)) / 8;
 
-    renderer->buffer = (uint8_t *)calloc((size_t)renderer->stride * (size_t)renderer->height, 1);
+    renderer->buffer_capacity = (size_t)renderer->stride * (size_t)renderer->height;
+    renderer->buffer = (uint8_t *)calloc(renderer->buffer_capacity, 1);
     if (!renderer->buffer) return false;
 
     renderer->image_byte_order = setup->image_byte_order;
@@ -797,24 +799,36 @@ static void Clay_XCB_Shutdown(Clay_XCB_Renderer *renderer) {
     }
     free(renderer->buffer);
     renderer->buffer = NULL;
+    renderer->buffer_capacity = 0;
 }
 
 static bool Clay_XCB_Resize(Clay_XCB_Renderer *renderer, int width, int height) {
     if (!renderer || width <= 0 || height <= 0) return false;
 
-    renderer->width = width;
-    renderer->height = height;
-
     const xcb_setup_t *setup = xcb_get_setup(renderer->connection);
     const xcb_format_t *format = clay_xcb_find_format(setup, renderer->depth);
     if (!format) return false;
 
     int pad = format->scanline_pad;
-    renderer->stride = ((renderer->width * (int)format->bits_per_pixel + pad - 1) & ~(pad - 1)) / 8;
+    int stride = ((width * (int)format->bits_per_pixel + pad - 1) & ~(pad - 1)) / 8;
+    size_t needed = (size_t)stride * (size_t)height;
 
-    free(renderer->buffer);
-    renderer->buffer = (uint8_t *)calloc((size_t)renderer->stride * (size_t)renderer->height, 1);
-    return renderer->buffer != NULL;
+    // Window drags resize once per configure event; growing by half again
+    // keeps that to a few allocations, and shrinking reuses the buffer
+    if (needed > renderer->buffer_capacity || !renderer->buffer) {
+        size_t capacity = renderer->buffer_capacity + renderer->buffer_capacity / 2;
+        if (capacity < needed) capacity = needed;
+        uint8_t *buffer = (uint8_t *)calloc(capacity, 1);
+        if (!buffer) return false;
+        free(renderer->buffer);
+        renderer->buffer = buffer;
+        renderer->buffer_capacity = capacity;
+    }
+
+    renderer->width = width;
+    renderer->height = height;
+    renderer->stride = stride;
+    return true;
 }
 
 static void Clay_XCB_Clear(Clay_XCB_Renderer *renderer, Clay_Color color) {
@@ -1,5 +1,6 @@
 #include "clay_react/app.h"
 #include "clay_react/clay_react.h"
+#include "clay_react/trace.h"
 
 #include <math.h>
 #include <stdint.h>
@@ -59,14 +60,96 @@ static Clay_Color cr_app_background_color(void) {
     return color;
 }
 
+// ============================================================================
+// LIVE RESIZE
+// ============================================================================
+
+// Window drags deliver a size change per pointer step. Sizes are coalesced
+// and laid out at most once per CR_APP_RESIZE_INTERVAL_NS; frames in between
+// reuse the last layout. The newest size is always laid out once the
+// interval passes, so a resize that settles ends on a crisp frame.
+#define CR_APP_RESIZE_INTERVAL_NS 50000000ull
+
+typedef struct {
+    Clay_Dimensions laid_out;       // Size the current layout was built for
+    Clay_Dimensions pending;        // Newest size not laid out yet
+    bool has_pending;
+    uint64_t last_layout_ns;
+} CR_AppResize;
+
+static CR_AppResize g_app_resize = {0};
+
 static void cr_app_set_layout_dimensions(Clay_Dimensions dimensions) {
     Clay_SetLayoutDimensions(dimensions);
+    g_app_resize.laid_out = dimensions;
+    g_app_resize.has_pending = false;
+    // New dimensions need a layout; a cached frame cannot be repainted
+    cr_request_render();
     if (g_app_config && g_app_config->on_viewport) {
         g_app_config->on_viewport(dimensions, g_app_config->user_data);
     }
 }
 
-static Clay_RenderCommandArray cr_app_build_layout(void) {
+static void cr_app_resize_to(Clay_Dimensions dimensions) {
+    g_app_resize.pending = dimensions;
+    g_app_resize.has_pending = true;
+}
+
+// Lays out the pending size once the interval allows. Returns true while a
+// size is still waiting, i.e. the next frame should reuse the last layout.
+static bool cr_app_resize_flush(uint64_t now_ns) {
+    if (!g_app_resize.has_pending) return false;
+    if (g_app_resize.last_layout_ns != 0 && now_ns - g_app_resize.last_layout_ns < CR_APP_RESIZE_INTERVAL_NS) {
+        return true;
+    }
+    g_app_resize.last_layout_ns = now_ns;
+    if (g_app_resize.pending.width != g_app_resize.laid_out.width ||
+        g_app_resize.pending.height != g_app_resize.laid_out.height) {
+        cr_app_set_layout_dimensions(g_app_resize.pending);
+    }
+    g_app_resize.has_pending = false;
+    return false;
+}
+
+// Shortens a wait so a throttled size gets laid out on time
+static int cr_app_resize_timeout_ms(int timeout_ms, uint64_t now_ns) {
+    if (!g_app_resize.has_pending) return timeout_ms;
+    uint64_t due_ns = g_app_resize.last_layout_ns + CR_APP_RESIZE_INTERVAL_NS;
+    int resize_ms = now_ns >= due_ns ? 0 : (int)((due_ns - now_ns + 999999ull) / 1000000ull);
+    return (timeout_ms < 0 || resize_ms < timeout_ms) ? resize_ms : timeout_ms;
+}
+
+// ============================================================================
+// INPUT COALESCING
+// ============================================================================
+
+// Backends feed raw pointer events in; Clay sees one consolidated state per
+// flush. Motion collapses to the latest position, button transitions keep
+// their order (each press still dispatches a click at its own position),
+// and wheel steps are summed with their event timestamps.
+enum { CR_APP_MAX_BUTTON_TRANSITIONS = 16 };
+
+typedef struct {
+    Clay_Vector2 position;
+    bool down;
+} CR_AppButtonTransition;
+
+typedef struct {
+    Clay_Vector2 position;          // Latest pointer position
+    bool down;                      // Latest primary button state
+    bool has_motion;
+    CR_AppButtonTransition transitions[CR_APP_MAX_BUTTON_TRANSITIONS];
+    size_t transition_count;
+    Clay_Vector2 wheel;             // Summed since the last flush
+    bool has_wheel;
+    uint64_t wheel_last_ns;         // Timestamp of the newest wheel step
+    uint64_t wheel_prev_ns;         // Newest step of the previous flush
+    bool flushed_changes;           // An early flush wanted a frame
+} CR_AppInput;
+
+static CR_AppInput g_app_input = {0};
+
+static Clay_RenderCommandArray cr_app_render_tree(void) {
     cr_begin_frame();
     if (g_app_config && g_app_config->render) {
         g_app_config->render(g_app_config->user_data);
@@ -74,6 +157,144 @@ static Clay_RenderCommandArray cr_app_build_layout(void) {
     return cr_end_frame();
 }
 
+static void cr_app_input_motion(Clay_Vector2 position, bool down) {
+    g_app_input.position = position;
+    g_app_input.down = down;
+    g_app_input.has_motion = true;
+}
+
+static bool cr_app_input_flush(void);
+
+static void cr_app_input_button(Clay_Vector2 position, bool down) {
+    if (g_app_input.transition_count == CR_APP_MAX_BUTTON_TRANSITIONS) {
+        // Flush early rather than drop or reorder clicks
+        cr_app_input_flush();
+    }
+    g_app_input.transitions[g_app_input.transition_count++] = (CR_AppButtonTransition){
+        .position = position,
+        .down = down,
+    };
+    g_app_input.position = position;
+    g_app_input.down = down;
+}
+
+static void cr_app_input_wheel(Clay_Vector2 delta, uint64_t timestamp_ns) {
+    g_app_input.wheel.x += delta.x;
+    g_app_input.wheel.y += delta.y;
+    g_app_input.has_wheel = true;
+    g_app_input.wheel_last_ns = timestamp_ns;
+}
+
+// Keys and text act on whatever focus the clicks queued ahead of them set,
+// so those clicks go first
+static void cr_app_input_before_key(void) {
+    if (g_app_input.transition_count > 0 && cr_app_input_flush()) {
+        g_app_input.flushed_changes = true;
+    }
+}
+
+// Returns true when the flushed input needs a frame. Plain motion only asks
+// for one through cr_should_render, i.e. when it changes the hovered set.
+static bool cr_app_input_flush(void) {
+    bool changed = g_app_input.transition_count > 0;
+    // A translated scroll frame left Clay hit-testing the old layout
+    if (changed && cr_layout_translated()) {
+        (void)cr_app_render_tree();
+    }
+    for (size_t i = 0; i < g_app_input.transition_count; i++) {
+        CR_AppButtonTransition transition = g_app_input.transitions[i];
+        cr_set_pointer_state(transition.position, transition.down);
+        if (transition.down) {
+            _cr_dispatch_clicks();
+        }
+    }
+    g_app_input.transition_count = 0;
+
+    if (g_app_input.has_motion) {
+        cr_set_pointer_state(g_app_input.position, g_app_input.down);
+        g_app_input.has_motion = false;
+        // Dragging moves scroll containers and selections
+        changed = changed || g_app_input.down;
+    }
+
+    if (g_app_input.has_wheel) {
+        float delta_time = 1.0f / 60.0f;
+        if (g_app_input.wheel_prev_ns != 0 && g_app_input.wheel_last_ns > g_app_input.wheel_prev_ns) {
+            delta_time = (float)(g_app_input.wheel_last_ns - g_app_input.wheel_prev_ns) / 1e9f;
+            if (delta_time > 0.1f) {
+                delta_time = 0.1f;
+            }
+        }
+        cr_update_scroll(g_app_input.wheel, delta_time);
+        g_app_input.wheel_prev_ns = g_app_input.wheel_last_ns;
+        g_app_input.wheel = (Clay_Vector2){0};
+        g_app_input.has_wheel = false;
+        changed = true;
+    }
+
+    changed = changed || g_app_input.flushed_changes;
+    g_app_input.flushed_changes = false;
+    return changed;
+}
+
+// ============================================================================
+// FRAME TRACE
+// ============================================================================
+
+static CR_TraceWriter *g_app_trace = NULL;
+
+static void cr_app_trace_open(void) {
+    const char *path = g_app_config->trace_path ? g_app_config->trace_path : getenv("CR_APP_TRACE");
+    if (!path || path[0] == '\0') return;
+    g_app_trace = cr_trace_writer_open(path);
+    if (!g_app_trace) {
+        fprintf(stderr, "Failed to create frame trace %s\n", path);
+    }
+}
+
+static void cr_app_trace_frame(Clay_RenderCommandArray commands) {
+    if (!g_app_trace) return;
+    if (!cr_trace_write_frame(g_app_trace, g_app_resize.laid_out, cr_app_background_color(),
+                              cr_now_ns(), commands)) {
+        fprintf(stderr, "Frame trace write failed; recording stopped\n");
+        cr_trace_writer_close(g_app_trace);
+        g_app_trace = NULL;
+    }
+}
+
+static void cr_app_trace_close(void) {
+    cr_trace_writer_close(g_app_trace);
+    g_app_trace = NULL;
+}
+
+static Clay_RenderCommandArray cr_app_build_layout(void) {
+    cr_app_input_flush();
+    // Hover-only changes recolor the previous frame's commands and wheel
+    // glides move them
+    Clay_RenderCommandArray commands;
+    if (!cr_paint_frame(&commands) && !cr_scroll_frame(&commands)) {
+        commands = cr_app_render_tree();
+    }
+    cr_app_trace_frame(commands);
+    return commands;
+}
+
+// Passive effects run once the frame is on screen so they never delay it;
+// idle effects then get whatever is left of the frame budget.
+static void cr_app_after_present(void) {
+    cr_flush_effects();
+    if (cr_has_idle_work()) {
+        cr_run_idle_effects(cr_frame_headroom_ns());
+    }
+}
+
+// Nothing to draw: give deferred idle effects a full budget slot
+static void cr_app_run_idle(void) {
+    if (cr_has_idle_work()) {
+        cr_run_idle_effects(cr_frame_budget_ns());
+    }
+}
+
 #if defined(CLAY_RENDERER_SDL3)
 
 #define SDL_MAIN_HANDLED
@@ -104,6 +325,80 @@ static void handle_errors(Clay_ErrorData error) {
     SDL_LogError(SDL_LOG_CATEGORY_ERROR, "[Clay Error] %s", error.errorText.chars);
 }
 
+static Uint32 g_sdl3_wake_event = 0;
+
+static void sdl3_wake(void *user_data) {
+    (void)user_data;
+    SDL_Event event = {0};
+    event.type = g_sdl3_wake_event;
+    SDL_PushEvent(&event);
+}
+
+static bool sdl3_handle_event(const SDL_Event *event) {
+    switch (event->type) {
+        case SDL_EVENT_QUIT:
+            return false;
+
+        case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+            cr_app_resize_to((Clay_Dimensions){
+                event->window.data1, event->window.data2
+            });
+            break;
+
+        case SDL_EVENT_MOUSE_MOTION:
+            cr_app_input_motion(
+                (Clay_Vector2){ event->motion.x, event->motion.y },
+                (event->motion.state & SDL_BUTTON_LMASK) != 0
+            );
+            break;
+
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+            if (event->button.button == SDL_BUTTON_LEFT) {
+                cr_app_input_button((Clay_Vector2){ event->button.x, event->button.y }, true);
+            }
+            break;
+
+        case SDL_EVENT_MOUSE_BUTTON_UP:
+            if (event->button.button == SDL_BUTTON_LEFT) {
+                cr_app_input_button((Clay_Vector2){ event->button.x, event->button.y }, false);
+            }
+            break;
+
+        case SDL_EVENT_MOUSE_WHEEL:
+            cr_app_input_wheel(
+                (Clay_Vector2){ event->wheel.x * 30, event->wheel.y * 30 },
+                event->wheel.timestamp);
+            break;
+
+        case SDL_EVENT_TEXT_INPUT:
+            cr_app_input_before_key();
+            _cr_handle_text_event(event->text.text);
+            break;
+
+        case SDL_EVENT_KEY_DOWN: {
+            SDL_Keymod mod = event->key.mod;
+            cr_app_input_before_key();
+            _cr_handle_key((KeyEvent){
+                .keycode = (int)event->key.key,
+                .scancode = (int)event->key.scancode,
+                .modifiers = ((mod & SDL_KMOD_SHIFT) ? CR_MOD_SHIFT : 0) |
+                             ((mod & SDL_KMOD_CTRL) ? CR_MOD_CTRL : 0) |
+                             ((mod & SDL_KMOD_ALT) ? CR_MOD_ALT : 0) |
+                             ((mod & SDL_KMOD_GUI) ? CR_MOD_SUPER : 0),
+                .is_press = true,
+                .is_repeat = event->key.repeat,
+            });
+            break;
+        }
+
+        default:
+            // g_sdl3_wake_event only interrupts the wait; posted updates
+            // are drained by cr_begin_frame
+            break;
+    }
+    return true;
+}
+
 static void sdl3_shutdown(AppState *state) {
     if (!state) return;
 
@@ -148,6 +443,8 @@ static int run_sdl3(void) {
         return 1;
     }
 
+    SDL_SetRenderVSync(state.rendererData.renderer, 1);
+
     state.rendererData.textEngine = TTF_CreateRendererTextEngine(state.rendererData.renderer);
     if (!state.rendererData.textEngine) {
         SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to create text engine: %s", SDL_GetError());
@@ -181,78 +478,71 @@ static int run_sdl3(void) {
     Clay_Initialize(arena, (Clay_Dimensions){ (float)width, (float)height },
         (Clay_ErrorHandler){ .errorHandlerFunction = handle_errors });
     cr_app_set_layout_dimensions((Clay_Dimensions){ (float)width, (float)height });
-    Clay_SetMeasureTextFunction(measure_text, state.rendererData.fonts);
+    cr_set_measure_text(measure_text, state.rendererData.fonts);
 
     cr_init();
+    cr_set_effect_deferral(true);
+    g_sdl3_wake_event = SDL_RegisterEvents(1);
+    if (g_sdl3_wake_event != 0) {
+        cr_set_wake_handler(sdl3_wake, NULL);
+    }
     SDL_StartTextInput(state.window);
 
     bool running = true;
+    bool needs_redraw = true;
     while (running) {
+        // Block until input arrives, another thread posts an update or a
+        // hook's scheduled frame is due; vsync paces animation frames
         SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            switch (event.type) {
-                case SDL_EVENT_QUIT:
-                    running = false;
-                    break;
-
-                case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
-                    cr_app_set_layout_dimensions((Clay_Dimensions){
-                        event.window.data1, event.window.data2
-                    });
-                    break;
-
-                case SDL_EVENT_MOUSE_MOTION:
-                    Clay_SetPointerState(
-                        (Clay_Vector2){ event.motion.x, event.motion.y },
-                        (event.motion.state & SDL_BUTTON_LMASK) != 0
-                    );
-                    break;
-
-                case SDL_EVENT_MOUSE_BUTTON_DOWN:
-                    if (event.button.button == SDL_BUTTON_LEFT) {
-                        Clay_SetPointerState(
-                            (Clay_Vector2){ event.button.x, event.button.y },
-                            true
-                        );
-                        _cr_dispatch_clicks();
-                    }
-                    break;
-
-                case SDL_EVENT_MOUSE_BUTTON_UP:
-                    if (event.button.button == SDL_BUTTON_LEFT) {
-                        Clay_SetPointerState(
-                            (Clay_Vector2){ event.button.x, event.button.y },
-                            false
-                        );
-                    }
-                    break;
-
-                case SDL_EVENT_MOUSE_WHEEL:
-                    Clay_UpdateScrollContainers(true,
-                        (Clay_Vector2){ event.wheel.x * 30, event.wheel.y * 30 },
-                        0.016f);
-                    break;
-
-                case SDL_EVENT_TEXT_INPUT:
-                    _cr_handle_text_event(event.text.text);
-                    break;
-
-                case SDL_EVENT_KEY_DOWN:
-                    _cr_handle_key_event(event.key.key, true);
-                    break;
+        int timeout_ms = needs_redraw ? 0 : cr_app_resize_timeout_ms(cr_wait_timeout_ms(), SDL_GetTicksNS());
+        bool has_event = timeout_ms == 0 ?
+            SDL_PollEvent(&event) :
+            SDL_WaitEventTimeout(&event, timeout_ms);
+        while (has_event) {
+            if (!sdl3_handle_event(&event)) {
+                running = false;
+            }
+            // Motion is coalesced below and only redraws if it matters
+            if (event.type != SDL_EVENT_MOUSE_MOTION) {
+                needs_redraw = true;
             }
+            has_event = SDL_PollEvent(&event);
+        }
+        if (!running) break;
+        bool resizing = cr_app_resize_flush(SDL_GetTicksNS());
+        if (cr_app_input_flush()) {
+            needs_redraw = true;
+        }
+        if (!needs_redraw && !cr_should_render()) {
+            cr_app_run_idle();
+            continue;
         }
 
-        Clay_RenderCommandArray commands = cr_app_build_layout();
+        // Until the throttled relayout, stretch frames laid out at the old
+        // size over the window; only a frame nothing has changed is reused
+        Clay_RenderCommandArray commands;
+        float scale_x = 1.0f;
+        float scale_y = 1.0f;
+        if (resizing && g_app_resize.laid_out.width > 0.0f && g_app_resize.laid_out.height > 0.0f) {
+            scale_x = g_app_resize.pending.width / g_app_resize.laid_out.width;
+            scale_y = g_app_resize.pending.height / g_app_resize.laid_out.height;
+        }
+        if (!resizing || !cr_last_frame(&commands)) {
+            commands = cr_app_build_layout();
+        }
         Clay_Color background = cr_app_background_color();
 
         SDL_SetRenderDrawColor(state.rendererData.renderer,
             background.r, background.g, background.b, background.a);
         SDL_RenderClear(state.rendererData.renderer);
 
+        SDL_SetRenderScale(state.rendererData.renderer, scale_x, scale_y);
         SDL_Clay_RenderClayCommands(&state.rendererData, &commands);
+        SDL_SetRenderScale(state.rendererData.renderer, 1.0f, 1.0f);
 
         SDL_RenderPresent(state.rendererData.renderer);
+        cr_app_after_present();
+        needs_redraw = false;
     }
 
     sdl3_shutdown(&state);
@@ -350,15 +640,21 @@ static int run_sdl2(void) {
     Clay_Initialize(arena, (Clay_Dimensions){ (float)width, (float)height },
         (Clay_ErrorHandler){ .errorHandlerFunction = handle_errors });
     cr_app_set_layout_dimensions((Clay_Dimensions){ (float)width, (float)height });
-    Clay_SetMeasureTextFunction(SDL2_MeasureText, state.fonts);
+    cr_set_measure_text(SDL2_MeasureText, state.fonts);
 
     cr_init();
+    cr_set_effect_deferral(true);
     SDL_StartTextInput();
 
     bool running = true;
+    bool needs_redraw = true;
     while (running) {
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
+            // Motion is coalesced below and only redraws if it matters
+            if (event.type != SDL_MOUSEMOTION) {
+                needs_redraw = true;
+            }
             switch (event.type) {
                 case SDL_QUIT:
                     running = false;
@@ -371,41 +667,62 @@ static int run_sdl2(void) {
                     }
                     break;
                 case SDL_MOUSEMOTION:
-                    Clay_SetPointerState(
+                    cr_app_input_motion(
                         (Clay_Vector2){ event.motion.x, event.motion.y },
                         (event.motion.state & SDL_BUTTON_LMASK) != 0
                     );
                     break;
                 case SDL_MOUSEBUTTONDOWN:
                     if (event.button.button == SDL_BUTTON_LEFT) {
-                        Clay_SetPointerState(
-                            (Clay_Vector2){ event.button.x, event.button.y },
-                            true
-                        );
-                        _cr_dispatch_clicks();
+                        cr_app_input_button((Clay_Vector2){ event.button.x, event.button.y }, true);
                     }
                     break;
                 case SDL_MOUSEBUTTONUP:
                     if (event.button.button == SDL_BUTTON_LEFT) {
-                        Clay_SetPointerState(
-                            (Clay_Vector2){ event.button.x, event.button.y },
-                            false
-                        );
+                        cr_app_input_button((Clay_Vector2){ event.button.x, event.button.y }, false);
                     }
                     break;
                 case SDL_MOUSEWHEEL:
-                    Clay_UpdateScrollContainers(true,
+                    cr_app_input_wheel(
                         (Clay_Vector2){ event.wheel.x * 30, event.wheel.y * 30 },
-                        0.016f);
+                        (uint64_t)event.wheel.timestamp * 1000000ull);
                     break;
                 case SDL_TEXTINPUT:
+                    cr_app_input_before_key();
                     _cr_handle_text_event(event.text.text);
                     break;
-                case SDL_KEYDOWN:
-                    _cr_handle_key_event(event.key.keysym.sym, true);
+                case SDL_KEYDOWN: {
+                    Uint16 mod = event.key.keysym.mod;
+                    cr_app_input_before_key();
+                    _cr_handle_key((KeyEvent){
+                        .keycode = (int)event.key.keysym.sym,
+                        .scancode = (int)event.key.keysym.scancode,
+                        .modifiers = ((mod & KMOD_SHIFT) ? CR_MOD_SHIFT : 0) |
+                                     ((mod & KMOD_CTRL) ? CR_MOD_CTRL : 0) |
+                                     ((mod & KMOD_ALT) ? CR_MOD_ALT : 0) |
+                                     ((mod & KMOD_GUI) ? CR_MOD_SUPER : 0),
+                        .is_press = true,
+                        .is_repeat = event.key.repeat != 0,
+                    });
                     break;
+                }
             }
         }
+        if (!running) break;
+        if (cr_app_input_flush()) {
+            needs_redraw = true;
+        }
+        if (!needs_redraw && !cr_should_render()) {
+            cr_app_run_idle();
+            // No wake handler on SDL2: cap the wait so posted updates are
+            // picked up within a frame
+            int timeout_ms = cr_wait_timeout_ms();
+            if (timeout_ms < 0 || timeout_ms > 16) {
+                timeout_ms = 16;
+            }
+            SDL_WaitEventTimeout(NULL, timeout_ms);
+            continue;
+        }
 
         Clay_RenderCommandArray commands = cr_app_build_layout();
         Clay_Color background = cr_app_background_color();
@@ -417,6 +734,8 @@ static int run_sdl2(void) {
         Clay_SDL2_Render(state.renderer, commands, state.fonts);
 
         SDL_RenderPresent(state.renderer);
+        cr_app_after_present();
+        needs_redraw = false;
     }
 
     SDL_StopTextInput();
@@ -465,6 +784,7 @@ static void raylib_emit_text(int codepoint) {
 }
 
 static void raylib_handle_text_input(void) {
+    cr_app_input_before_key();
     int codepoint = GetCharPressed();
     while (codepoint > 0) {
         raylib_emit_text(codepoint);
@@ -507,38 +827,59 @@ static int run_raylib(void) {
     Clay_Initialize(arena, (Clay_Dimensions){ (float)GetScreenWidth(), (float)GetScreenHeight() },
         (Clay_ErrorHandler){ .errorHandlerFunction = handle_errors });
     cr_app_set_layout_dimensions((Clay_Dimensions){ (float)GetScreenWidth(), (float)GetScreenHeight() });
-    Clay_SetMeasureTextFunction(Raylib_MeasureText, fonts);
+    cr_set_measure_text(Raylib_MeasureText, fonts);
 
     cr_init();
+    cr_set_effect_deferral(true);
 
+    // raylib polls input and paces frames in EndDrawing, so every iteration
+    // draws; frames nothing asked for redraw the last commands unchanged
+    Clay_RenderCommandArray commands = {0};
+    bool needs_redraw = true;
     while (!WindowShouldClose()) {
         if (IsWindowResized()) {
             cr_app_set_layout_dimensions((Clay_Dimensions){
                 (float)GetScreenWidth(), (float)GetScreenHeight()
             });
+            needs_redraw = true;
         }
 
         Vector2 mouse = GetMousePosition();
-        bool down = IsMouseButtonDown(MOUSE_LEFT_BUTTON);
-        Clay_SetPointerState((Clay_Vector2){ mouse.x, mouse.y }, down);
+        Clay_Vector2 pointer = { mouse.x, mouse.y };
         if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-            _cr_dispatch_clicks();
+            cr_app_input_button(pointer, true);
+        }
+        if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
+            cr_app_input_button(pointer, false);
         }
+        cr_app_input_motion(pointer, IsMouseButtonDown(MOUSE_LEFT_BUTTON));
 
         float wheel = GetMouseWheelMove();
         if (wheel != 0.0f) {
-            Clay_UpdateScrollContainers(true, (Clay_Vector2){ 0.0f, wheel * 30.0f }, GetFrameTime());
+            cr_app_input_wheel((Clay_Vector2){ 0.0f, wheel * 30.0f }, (uint64_t)(GetTime() * 1e9));
         }
 
         raylib_handle_text_input();
 
-        Clay_RenderCommandArray commands = cr_app_build_layout();
+        if (cr_app_input_flush()) {
+            needs_redraw = true;
+        }
+        bool built = needs_redraw || cr_should_render();
+        if (built) {
+            commands = cr_app_build_layout();
+            needs_redraw = false;
+        }
         Clay_Color background = cr_app_background_color();
 
         BeginDrawing();
         ClearBackground((Color){ background.r, background.g, background.b, background.a });
         Clay_Raylib_Render(commands, fonts);
         EndDrawing();
+        if (built) {
+            cr_app_after_present();
+        } else {
+            cr_app_run_idle();
+        }
     }
 
     cr_shutdown();
@@ -553,6 +894,9 @@ static int run_raylib(void) {
 #include <cairo/cairo.h>
 #include <cairo/cairo-xcb.h>
 #include <X11/keysym.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 #include <xcb/xcb.h>
 #include <xcb/xcb_keysyms.h>
 
@@ -575,9 +919,38 @@ static xcb_visualtype_t *xcb_find_visual(xcb_screen_t *screen, xcb_visualid_t vi
     return NULL;
 }
 
+static int g_cairo_wake_fd = -1;
+
+static void cairo_wake(void *user_data) {
+    (void)user_data;
+    uint64_t one = 1;
+    ssize_t written = write(g_cairo_wake_fd, &one, sizeof(one));
+    (void)written;
+}
+
+// Sleep until X input, a posted update or the runtime's next deadline.
+// Frames that are due immediately are still paced at ~60 Hz.
+static void cairo_wait_for_events(xcb_connection_t *connection) {
+    int timeout_ms = cr_wait_timeout_ms();
+    if (timeout_ms == 0) {
+        timeout_ms = 16;
+    }
+    struct pollfd fds[2] = {
+        { .fd = xcb_get_file_descriptor(connection), .events = POLLIN },
+        { .fd = g_cairo_wake_fd, .events = POLLIN },
+    };
+    nfds_t count = g_cairo_wake_fd >= 0 ? 2 : 1;
+    if (poll(fds, count, timeout_ms) > 0 && count > 1 && (fds[1].revents & POLLIN)) {
+        uint64_t value = 0;
+        ssize_t got = read(g_cairo_wake_fd, &value, sizeof(value));
+        (void)got;
+    }
+}
+
 static void xcb_handle_key_press(xcb_key_press_event_t *event, xcb_key_symbols_t *keysyms) {
     int shift = (event->state & XCB_MOD_MASK_SHIFT) ? 1 : 0;
     xcb_keysym_t keysym = xcb_key_symbols_get_keysym(keysyms, event->detail, shift);
+    cr_app_input_before_key();
 
     if (keysym >= XK_space && keysym <= XK_asciitilde) {
         char text[2] = { (char)keysym, '\0' };
@@ -702,9 +1075,14 @@ static int run_xcb_cairo(void) {
     Clay_Initialize(arena, (Clay_Dimensions){ (float)width, (float)height },
         (Clay_ErrorHandler){ .errorHandlerFunction = handle_errors });
     cr_app_set_layout_dimensions((Clay_Dimensions){ (float)width, (float)height });
-    Clay_SetMeasureTextFunction(Clay_Cairo_MeasureText, fonts);
+    cr_set_measure_text(Clay_Cairo_MeasureText, fonts);
 
     cr_init();
+    cr_set_effect_deferral(true);
+    g_cairo_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (g_cairo_wake_fd >= 0) {
+        cr_set_wake_handler(cairo_wake, NULL);
+    }
 
     bool running = true;
     bool needs_redraw = true;
@@ -731,43 +1109,32 @@ static int run_xcb_cairo(void) {
                 case XCB_MOTION_NOTIFY: {
                     xcb_motion_notify_event_t *motion = (xcb_motion_notify_event_t *)event;
                     bool down = (motion->state & XCB_BUTTON_MASK_1) != 0;
-                    Clay_SetPointerState(
+                    cr_app_input_motion(
                         (Clay_Vector2){ (float)motion->event_x, (float)motion->event_y },
                         down
                     );
-                    needs_redraw = true;
                     break;
                 }
                 case XCB_BUTTON_PRESS: {
                     xcb_button_press_event_t *button = (xcb_button_press_event_t *)event;
+                    uint64_t timestamp_ns = (uint64_t)button->time * 1000000ull;
                     if (button->detail == 1) {
-                        Clay_SetPointerState(
-                            (Clay_Vector2){ (float)button->event_x, (float)button->event_y },
-                            true
-                        );
-                        _cr_dispatch_clicks();
-                        needs_redraw = true;
+                        cr_app_input_button(
+                            (Clay_Vector2){ (float)button->event_x, (float)button->event_y }, true);
                     } else if (button->detail == 4 || button->detail == 5) {
                         float delta = (button->detail == 4) ? 30.0f : -30.0f;
-                        Clay_UpdateScrollContainers(true,
-                            (Clay_Vector2){ 0.0f, delta }, 0.016f);
-                        needs_redraw = true;
+                        cr_app_input_wheel((Clay_Vector2){ 0.0f, delta }, timestamp_ns);
                     } else if (button->detail == 6 || button->detail == 7) {
                         float delta = (button->detail == 6) ? 30.0f : -30.0f;
-                        Clay_UpdateScrollContainers(true,
-                            (Clay_Vector2){ delta, 0.0f }, 0.016f);
-                        needs_redraw = true;
+                        cr_app_input_wheel((Clay_Vector2){ delta, 0.0f }, timestamp_ns);
                     }
                     break;
                 }
                 case XCB_BUTTON_RELEASE: {
                     xcb_button_release_event_t *button = (xcb_button_release_event_t *)event;
                     if (button->detail == 1) {
-                        Clay_SetPointerState(
-                            (Clay_Vector2){ (float)button->event_x, (float)button->event_y },
-                            false
-                        );
-                        needs_redraw = true;
+                        cr_app_input_button(
+                            (Clay_Vector2){ (float)button->event_x, (float)button->event_y }, false);
                     }
                     break;
                 }
@@ -793,6 +1160,9 @@ static int run_xcb_cairo(void) {
             free(event);
         }
 
+        if (cr_app_input_flush() || cr_should_render()) {
+            needs_redraw = true;
+        }
         if (needs_redraw) {
             Clay_RenderCommandArray commands = cr_app_build_layout();
             Clay_Color background = cr_app_background_color();
@@ -810,14 +1180,22 @@ static int run_xcb_cairo(void) {
             Clay_Cairo_Render(commands, fonts);
             cairo_surface_flush(surface);
             xcb_flush(connection);
+            cr_app_after_present();
             needs_redraw = false;
+        } else {
+            cr_app_run_idle();
         }
 
-        struct timespec sleep_time = { 0, 16 * 1000 * 1000 };
-        nanosleep(&sleep_time, NULL);
+        if (!running) break;
+        xcb_flush(connection);
+        cairo_wait_for_events(connection);
     }
 
     cr_shutdown();
+    if (g_cairo_wake_fd >= 0) {
+        close(g_cairo_wake_fd);
+        g_cairo_wake_fd = -1;
+    }
 
     if (keysyms) {
         xcb_key_symbols_free(keysyms);
@@ -834,6 +1212,9 @@ static int run_xcb_cairo(void) {
 #elif defined(CLAY_RENDERER_XCB)
 
 #include <X11/keysym.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 #include <xcb/xcb.h>
 #include <xcb/xcb_keysyms.h>
 
@@ -887,6 +1268,7 @@ static xcb_visualtype_t *xcb_find_visual(xcb_screen_t *screen, xcb_visualid_t vi
 static void xcb_handle_key_press(xcb_key_press_event_t *event, xcb_key_symbols_t *keysyms) {
     int shift = (event->state & XCB_MOD_MASK_SHIFT) ? 1 : 0;
     xcb_keysym_t keysym = xcb_key_symbols_get_keysym(keysyms, event->detail, shift);
+    cr_app_input_before_key();
 
     if (keysym >= XK_space && keysym <= XK_asciitilde) {
         char text[2] = { (char)keysym, '\0' };
@@ -925,6 +1307,31 @@ static uint64_t xcb_now_ns(void) {
     return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
 }
 
+static int g_xcb_wake_fd = -1;
+
+static void xcb_wake(void *user_data) {
+    (void)user_data;
+    uint64_t one = 1;
+    ssize_t written = write(g_xcb_wake_fd, &one, sizeof(one));
+    (void)written;
+}
+
+// Sleep until the X connection or the wake eventfd is readable, or until
+// timeout_ms elapses (-1 waits indefinitely).
+static void xcb_wait_for_events(xcb_connection_t *connection, int timeout_ms) {
+    xcb_flush(connection);
+    struct pollfd fds[2] = {
+        { .fd = xcb_get_file_descriptor(connection), .events = POLLIN },
+        { .fd = g_xcb_wake_fd, .events = POLLIN },
+    };
+    nfds_t count = g_xcb_wake_fd >= 0 ? 2 : 1;
+    if (poll(fds, count, timeout_ms) > 0 && count > 1 && (fds[1].revents & POLLIN)) {
+        uint64_t value = 0;
+        ssize_t got = read(g_xcb_wake_fd, &value, sizeof(value));
+        (void)got;
+    }
+}
+
 static int run_xcb(void) {
     int base_width = cr_app_width();
     int base_height = cr_app_height();
@@ -1041,9 +1448,14 @@ static int run_xcb(void) {
     Clay_Initialize(arena, (Clay_Dimensions){ (float)pixel_width * logical_scale, (float)pixel_height * logical_scale },
         (Clay_ErrorHandler){ .errorHandlerFunction = handle_errors });
     cr_app_set_layout_dimensions((Clay_Dimensions){ (float)pixel_width * logical_scale, (float)pixel_height * logical_scale });
-    Clay_SetMeasureTextFunction(Clay_XCB_MeasureText, fonts);
+    cr_set_measure_text(Clay_XCB_MeasureText, fonts);
 
     cr_init();
+    cr_set_effect_deferral(true);
+    g_xcb_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (g_xcb_wake_fd >= 0) {
+        cr_set_wake_handler(xcb_wake, NULL);
+    }
 
     bool running = true;
     bool needs_redraw = true;
@@ -1087,10 +1499,16 @@ static int run_xcb(void) {
                         if (pixel_w != renderer.width || pixel_h != renderer.height) {
                             Clay_XCB_Resize(&renderer, pixel_w, pixel_h);
                         }
-                        cr_app_set_layout_dimensions((Clay_Dimensions){
+                        Clay_Dimensions dimensions = {
                             (float)window_width * logical_scale,
                             (float)window_height * logical_scale
-                        });
+                        };
+                        // A scale change alters what the current layout means
+                        if (scale_changed) {
+                            cr_app_set_layout_dimensions(dimensions);
+                        } else {
+                            cr_app_resize_to(dimensions);
+                        }
                         needs_redraw = true;
                     }
                     break;
@@ -1098,39 +1516,33 @@ static int run_xcb(void) {
                 case XCB_MOTION_NOTIFY: {
                     xcb_motion_notify_event_t *motion = (xcb_motion_notify_event_t *)event;
                     bool down = (motion->state & XCB_BUTTON_MASK_1) != 0;
-                    Clay_SetPointerState(
+                    cr_app_input_motion(
                         (Clay_Vector2){
                             (float)motion->event_x * logical_scale,
                             (float)motion->event_y * logical_scale
                         },
                         down
                     );
-                    needs_redraw = true;
                     break;
                 }
                 case XCB_BUTTON_PRESS: {
                     xcb_button_press_event_t *button = (xcb_button_press_event_t *)event;
+                    uint64_t timestamp_ns = (uint64_t)button->time * 1000000ull;
                     if (button->detail == 1) {
                         pointer_down = true;
-                        Clay_SetPointerState(
+                        cr_app_input_button(
                             (Clay_Vector2){
                                 (float)button->event_x * logical_scale,
                                 (float)button->event_y * logical_scale
                             },
                             true
                         );
-                        _cr_dispatch_clicks();
-                        needs_redraw = true;
                     } else if (button->detail == 4 || button->detail == 5) {
                         float delta = (button->detail == 4) ? 30.0f : -30.0f;
-                        Clay_UpdateScrollContainers(true,
-                            (Clay_Vector2){ 0.0f, delta }, 0.016f);
-                        needs_redraw = true;
+                        cr_app_input_wheel((Clay_Vector2){ 0.0f, delta }, timestamp_ns);
                     } else if (button->detail == 6 || button->detail == 7) {
                         float delta = (button->detail == 6) ? 30.0f : -30.0f;
-                        Clay_UpdateScrollContainers(true,
-                            (Clay_Vector2){ delta, 0.0f }, 0.016f);
-                        needs_redraw = true;
+                        cr_app_input_wheel((Clay_Vector2){ delta, 0.0f }, timestamp_ns);
                     }
                     break;
                 }
@@ -1138,14 +1550,13 @@ static int run_xcb(void) {
                     xcb_button_release_event_t *button = (xcb_button_release_event_t *)event;
                     if (button->detail == 1) {
                         pointer_down = false;
-                        Clay_SetPointerState(
+                        cr_app_input_button(
                             (Clay_Vector2){
                                 (float)button->event_x * logical_scale,
                                 (float)button->event_y * logical_scale
                             },
                             false
                         );
-                        needs_redraw = true;
                     }
                     break;
                 }
@@ -1171,35 +1582,49 @@ static int run_xcb(void) {
             free(event);
         }
 
+        if (!running) break;
+        bool resizing = cr_app_resize_flush(xcb_now_ns());
+        if (cr_app_input_flush() || cr_should_render()) {
+            needs_redraw = true;
+        }
+
+        int timeout_ms = -1;
         if (needs_redraw) {
-            uint64_t frame_ns = pointer_down ? 16666666ull : 33333333ull;
+            uint64_t frame_ns = (pointer_down || cr_is_animating()) ? 16666666ull : 33333333ull;
             uint64_t now_ns = xcb_now_ns();
             if (last_frame_ns != 0 && now_ns - last_frame_ns < frame_ns) {
-                uint64_t sleep_ns = frame_ns - (now_ns - last_frame_ns);
-                struct timespec sleep_time = {
-                    .tv_sec = (time_t)(sleep_ns / 1000000000ull),
-                    .tv_nsec = (long)(sleep_ns % 1000000000ull),
-                };
-                nanosleep(&sleep_time, NULL);
+                uint64_t wait_ns = frame_ns - (now_ns - last_frame_ns);
+                timeout_ms = (int)((wait_ns + 999999ull) / 1000000ull);
+            } else {
+                // Until the throttled relayout, frames keep the old size in
+                // the resized buffer; uncovered pixels show the background.
+                // Only a frame nothing has changed is reused.
+                Clay_RenderCommandArray commands;
+                if (!resizing || !cr_last_frame(&commands)) {
+                    commands = cr_app_build_layout();
+                }
+                Clay_Color background = cr_app_background_color();
+
+                Clay_XCB_Clear(&renderer, background);
+                Clay_XCB_Render(&renderer, commands);
+                Clay_XCB_Present(&renderer);
+                cr_app_after_present();
+                needs_redraw = false;
+                last_frame_ns = xcb_now_ns();
                 continue;
             }
-
-            Clay_RenderCommandArray commands = cr_app_build_layout();
-            Clay_Color background = cr_app_background_color();
-
-            Clay_XCB_Clear(&renderer, background);
-            Clay_XCB_Render(&renderer, commands);
-            Clay_XCB_Present(&renderer);
-            needs_redraw = false;
-            last_frame_ns = xcb_now_ns();
-        }
-        if (!needs_redraw) {
-            struct timespec sleep_time = { 0, 4 * 1000 * 1000 };
-            nanosleep(&sleep_time, NULL);
+        } else {
+            cr_app_run_idle();
+            timeout_ms = cr_app_resize_timeout_ms(cr_wait_timeout_ms(), xcb_now_ns());
         }
+        xcb_wait_for_events(connection, timeout_ms);
     }
 
     cr_shutdown();
+    if (g_xcb_wake_fd >= 0) {
+        close(g_xcb_wake_fd);
+        g_xcb_wake_fd = -1;
+    }
 
     if (keysyms) {
         xcb_key_symbols_free(keysyms);
@@ -1235,7 +1660,7 @@ static int run_terminal(void) {
     Clay_Initialize(arena, (Clay_Dimensions){ (float)width, (float)height },
         (Clay_ErrorHandler){ .errorHandlerFunction = handle_errors });
     cr_app_set_layout_dimensions((Clay_Dimensions){ (float)width, (float)height });
-    Clay_SetMeasureTextFunction(Console_MeasureText, &column_width);
+    cr_set_measure_text(Console_MeasureText, &column_width);
 
     cr_init();
 
@@ -1247,6 +1672,169 @@ static int run_terminal(void) {
     return 0;
 }
 
+#elif defined(CLAY_RENDERER_HEADLESS)
+
+// The real frame loop with no display: a virtual 60 Hz clock, fixed-advance
+// text metrics and input from config->script, so runs are reproducible on
+// machines without X or a GPU. Wall-clock timings go to on_frame_stats.
+enum { CR_HEADLESS_FRAME_NS = 16666667 };
+
+static uint64_t g_headless_now_ns = 1000000000ull;
+
+static uint64_t headless_clock(void *user_data) {
+    (void)user_data;
+    return g_headless_now_ns;
+}
+
+static uint64_t headless_wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Every codepoint advances half the font size, independent of any font file
+static Clay_Dimensions headless_measure_text(Clay_StringSlice text, Clay_TextElementConfig *config, void *userData) {
+    (void)userData;
+    size_t codepoints = 0;
+    for (int32_t i = 0; i < text.length; i++) {
+        if (((unsigned char)text.chars[i] & 0xC0) != 0x80) {
+            codepoints++;
+        }
+    }
+    float advance = (float)config->fontSize * 0.5f + (float)config->letterSpacing;
+    float height = config->lineHeight ? (float)config->lineHeight : (float)config->fontSize;
+    return (Clay_Dimensions){ (float)codepoints * advance, height };
+}
+
+static void handle_errors(Clay_ErrorData error) {
+    fprintf(stderr, "[Clay Error] %.*s\n", (int)error.errorText.length, error.errorText.chars);
+}
+
+static void headless_apply(const CR_AppScriptEvent *event) {
+    Clay_Vector2 position = { event->x, event->y };
+    switch (event->kind) {
+        case CR_APP_SCRIPT_MOVE:
+            cr_app_input_motion(position, g_app_input.down);
+            break;
+        case CR_APP_SCRIPT_PRESS:
+            cr_app_input_button(position, true);
+            break;
+        case CR_APP_SCRIPT_RELEASE:
+            cr_app_input_button(position, false);
+            break;
+        case CR_APP_SCRIPT_CLICK:
+            cr_app_input_button(position, true);
+            cr_app_input_button(position, false);
+            break;
+        case CR_APP_SCRIPT_WHEEL:
+            cr_app_input_wheel(position, g_headless_now_ns);
+            break;
+        case CR_APP_SCRIPT_TEXT:
+            if (event->text) {
+                cr_app_input_before_key();
+                _cr_handle_text_event(event->text);
+            }
+            break;
+        case CR_APP_SCRIPT_KEY:
+            cr_app_input_before_key();
+            _cr_handle_key((KeyEvent){
+                .keycode = event->key,
+                .modifiers = event->modifiers,
+                .is_press = true,
+            });
+            break;
+        case CR_APP_SCRIPT_RESIZE:
+            cr_app_set_layout_dimensions((Clay_Dimensions){ event->x, event->y });
+            break;
+    }
+}
+
+static int run_headless(void) {
+    const int width = cr_app_width();
+    const int height = cr_app_height();
+
+    uint64_t memory_size = Clay_MinMemorySize();
+    Clay_Arena arena = {
+        .memory = calloc(1, memory_size),
+        .capacity = memory_size,
+    };
+    if (!arena.memory) {
+        fprintf(stderr, "headless: failed to allocate Clay arena\n");
+        return 1;
+    }
+
+    Clay_Initialize(arena, (Clay_Dimensions){ (float)width, (float)height },
+        (Clay_ErrorHandler){ .errorHandlerFunction = handle_errors });
+    cr_app_set_layout_dimensions((Clay_Dimensions){ (float)width, (float)height });
+    cr_set_measure_text(headless_measure_text, NULL);
+
+    cr_init();
+    cr_set_effect_deferral(true);
+    cr_set_clock(headless_clock, NULL);
+
+    const CR_AppScriptEvent *script = g_app_config->script;
+    size_t script_count = script ? g_app_config->script_count : 0;
+    uint32_t frame_count = g_app_config->frame_count;
+    if (frame_count == 0) {
+        frame_count = (script_count > 0 ? script[script_count - 1].frame : 0) + 1;
+    }
+
+    size_t next_event = 0;
+    bool needs_redraw = true;
+    uint32_t built = 0;
+    uint64_t total_ns = 0;
+    uint64_t worst_ns = 0;
+    for (uint32_t frame = 0; frame < frame_count; frame++) {
+        while (next_event < script_count && script[next_event].frame <= frame) {
+            const CR_AppScriptEvent *event = &script[next_event++];
+            headless_apply(event);
+            // Motion is coalesced and only redraws if it matters
+            if (event->kind != CR_APP_SCRIPT_MOVE) {
+                needs_redraw = true;
+            }
+        }
+        if (cr_app_input_flush()) {
+            needs_redraw = true;
+        }
+
+        CR_AppFrameStats stats = { .frame = frame };
+        if (needs_redraw || cr_should_render()) {
+            uint64_t start = headless_wall_ns();
+            Clay_RenderCommandArray commands = cr_app_build_layout();
+            uint64_t laid_out = headless_wall_ns();
+            cr_app_after_present();
+            uint64_t end = headless_wall_ns();
+
+            stats.built = true;
+            stats.layout_ns = laid_out - start;
+            stats.effects_ns = end - laid_out;
+            stats.command_count = commands.length;
+            built++;
+            total_ns += end - start;
+            if (end - start > worst_ns) {
+                worst_ns = end - start;
+            }
+            needs_redraw = false;
+        } else {
+            cr_app_run_idle();
+        }
+
+        if (g_app_config->on_frame_stats) {
+            g_app_config->on_frame_stats(&stats, g_app_config->user_data);
+        }
+        g_headless_now_ns += CR_HEADLESS_FRAME_NS;
+    }
+
+    fprintf(stderr, "headless: %u frames, %u built, avg %.3f ms, worst %.3f ms\n",
+        frame_count, built,
+        built ? (double)total_ns / built / 1e6 : 0.0,
+        (double)worst_ns / 1e6);
+
+    cr_shutdown();
+    free(arena.memory);
+    return 0;
+}
+
 #elif defined(CLAY_RENDERER_SOKOL)
 
 static int run_sokol(void) {
@@ -1288,28 +1876,33 @@ int cr_run_app(const CR_AppConfig *config) {
     }
 
     g_app_config = config;
+    cr_app_trace_open();
 
+    int result = 1;
 #if defined(CLAY_RENDERER_SDL3)
-    return run_sdl3();
+    result = run_sdl3();
 #elif defined(CLAY_RENDERER_SDL2)
-    return run_sdl2();
+    result = run_sdl2();
 #elif defined(CLAY_RENDERER_RAYLIB)
-    return run_raylib();
+    result = run_raylib();
 #elif defined(CLAY_RENDERER_CAIRO)
-    return run_xcb_cairo();
+    result = run_xcb_cairo();
 #elif defined(CLAY_RENDERER_XCB)
-    return run_xcb();
+    result = run_xcb();
 #elif defined(CLAY_RENDERER_TERMINAL)
-    return run_terminal();
+    result = run_terminal();
+#elif defined(CLAY_RENDERER_HEADLESS)
+    result = run_headless();
 #elif defined(CLAY_RENDERER_SOKOL)
-    return run_sokol();
+    result = run_sokol();
 #elif defined(CLAY_RENDERER_WEB)
-    return run_web();
+    result = run_web();
 #elif defined(CLAY_RENDERER_WIN32_GDI)
-    return run_win32_gdi();
+    result = run_win32_gdi();
 #elif defined(CLAY_RENDERER_PLAYDATE)
-    return run_playdate();
-#else
-    return 1;
+    result = run_playdate();
 #endif
+
+    cr_app_trace_close();
+    return result;
 }
@@ -2,6 +2,10 @@
 
 #include <clay.h>
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -10,6 +14,44 @@ typedef void (*CR_AppRenderFn)(void *user_data);
 typedef void (*CR_AppViewportFn)(Clay_Dimensions dimensions, void *user_data);
 typedef Clay_Color (*CR_AppBackgroundFn)(void *user_data);
 
+/**
+ * Scripted input for the headless backend (clay-backend=headless)
+ *
+ * Events are delivered, in array order, before the frame they name; the
+ * array must be sorted by frame. x/y carry the pointer position, the wheel
+ * delta in pixels or the new viewport size depending on kind.
+ */
+typedef enum CR_AppScriptKind {
+    CR_APP_SCRIPT_MOVE,         // Pointer to (x, y), button state unchanged
+    CR_APP_SCRIPT_PRESS,        // Primary button down at (x, y)
+    CR_APP_SCRIPT_RELEASE,      // Primary button up at (x, y)
+    CR_APP_SCRIPT_CLICK,        // Press and release at (x, y)
+    CR_APP_SCRIPT_WHEEL,        // Scroll by (x, y)
+    CR_APP_SCRIPT_TEXT,         // Type text (UTF-8)
+    CR_APP_SCRIPT_KEY,          // Press key with modifiers
+    CR_APP_SCRIPT_RESIZE,       // Viewport becomes x by y
+} CR_AppScriptKind;
+
+typedef struct CR_AppScriptEvent {
+    uint32_t frame;
+    CR_AppScriptKind kind;
+    float x;
+    float y;
+    const char *text;
+    int key;                    // CR_KEY_* or a character code
+    int modifiers;              // CR_KeyModifier bits
+} CR_AppScriptEvent;
+
+typedef struct CR_AppFrameStats {
+    uint32_t frame;
+    bool built;                 // false: nothing needed a new layout
+    uint64_t layout_ns;         // Input flush, render callback and Clay layout
+    uint64_t effects_ns;        // Passive and idle effects after the frame
+    int32_t command_count;
+} CR_AppFrameStats;
+
+typedef void (*CR_AppFrameStatsFn)(const CR_AppFrameStats *stats, void *user_data);
+
 typedef struct CR_AppConfig {
     const char *title;
     int width;
@@ -20,6 +62,16 @@ typedef struct CR_AppConfig {
     CR_AppViewportFn on_viewport;
     CR_AppBackgroundFn background;
     void *user_data;
+
+    // Record every built frame's render commands to this file for
+    // clay_react_replay (NULL: the CR_APP_TRACE environment variable, if set)
+    const char *trace_path;
+
+    // Headless backend only
+    const CR_AppScriptEvent *script;
+    size_t script_count;
+    uint32_t frame_count;               // 0 = one past the last scripted frame
+    CR_AppFrameStatsFn on_frame_stats;
 } CR_AppConfig;
 
 int cr_run_app(const CR_AppConfig *config);
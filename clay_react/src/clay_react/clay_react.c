@@ -11,6 +11,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <limits.h>
+#include <float.h>
+#include <math.h>
+#include <time.h>
 
 #undef NULL
 #define NULL ((void *_Nullable)0)
@@ -20,11 +24,11 @@
 // GLOBAL STATE
 // ============================================================================
 
-CR_Runtime *$nullable cr_runtime = NULL;
-CR_TextInputState *$nullable _cr_focused_input = NULL;
+_Thread_local CR_Runtime *$nullable cr_runtime = NULL;
 
-static uint64_t _cr_next_context_id = 1;
-static uint64_t _cr_next_component_id = 1;
+// Contexts are created once and shared by every runtime, so their ids are
+// process-wide
+static _Atomic uint64_t _cr_next_context_id = 1;
 
 // ============================================================================
 // COMPONENTS & HOOKS
@@ -47,6 +51,12 @@ struct CR_Component {
     uint64_t last_render_frame;
     void *$nullable props_copy;
     size_t props_size;
+    bool keep_alive;            // Boundary created by $keep_alive
+    bool hidden;                // Boundary is retaining a hidden subtree
+    uint64_t last_visible_frame;
+    size_t registry_index;      // Slot in cr_runtime->components
+    bool dead;                  // Released; memory lives in the graveyard
+    uint64_t path_hash;         // Names, keys and child slots from the root
 };
 
 // ============================================================================
@@ -73,15 +83,53 @@ void _cr_free(void * $nullable ptr, size_t size) {
     }
 }
 
-static void _cr_clear_temp_strings(void) {
-    if (!cr_runtime || !cr_runtime->temp_strings) {
-        return;
+// Frame text lives in a chunked bump arena. Chunks are kept across frames
+// and only reset, so steady-state frames allocate nothing.
+#define CR_TEXT_ARENA_CHUNK 16384
+
+static void _cr_reset_text_arena(void) {
+    if (!cr_runtime) return;
+    for (CR_ArenaChunk *chunk = cr_runtime->text_arena; chunk; chunk = chunk->next) {
+        chunk->used = 0;
+    }
+    cr_runtime->text_arena_top = cr_runtime->text_arena;
+}
+
+static void _cr_free_text_arena(void) {
+    CR_ArenaChunk *chunk = cr_runtime->text_arena;
+    while (chunk) {
+        CR_ArenaChunk *next = chunk->next;
+        _cr_free(chunk, sizeof(CR_ArenaChunk) + chunk->size);
+        chunk = next;
+    }
+    cr_runtime->text_arena = NULL;
+    cr_runtime->text_arena_top = NULL;
+}
+
+// Chunk with at least size free bytes, appending one if needed
+static CR_ArenaChunk * $nullable _cr_text_arena_reserve(size_t size) {
+    CR_ArenaChunk *chunk = cr_runtime->text_arena_top;
+    while (chunk && chunk->size - chunk->used < size) {
+        if (!chunk->next) break;
+        chunk = chunk->next;
+    }
+    if (chunk && chunk->size - chunk->used >= size) {
+        cr_runtime->text_arena_top = chunk;
+        return chunk;
     }
 
-    for (size_t i = 0; i < cr_runtime->temp_string_count; i++) {
-        _cr_free(cr_runtime->temp_strings[i].ptr, cr_runtime->temp_strings[i].size);
+    size_t chunk_size = size > CR_TEXT_ARENA_CHUNK ? size : CR_TEXT_ARENA_CHUNK;
+    CR_ArenaChunk *fresh = _cr_alloc(sizeof(CR_ArenaChunk) + chunk_size);
+    if (!fresh) return NULL;
+    fresh->size = chunk_size;
+    if (chunk) {
+        fresh->next = chunk->next;
+        chunk->next = fresh;
+    } else {
+        cr_runtime->text_arena = fresh;
     }
-    cr_runtime->temp_string_count = 0;
+    cr_runtime->text_arena_top = fresh;
+    return fresh;
 }
 
 char * $nullable _cr_temp_string_alloc(size_t size) {
@@ -92,427 +140,2560 @@ char * $nullable _cr_temp_string_alloc(size_t size) {
         return NULL;
     }
 
-    if (cr_runtime->temp_string_count >= cr_runtime->temp_string_capacity) {
-        size_t new_cap = cr_runtime->temp_string_capacity == 0 ? 64 : cr_runtime->temp_string_capacity * 2;
-        CR_TempString *new_list = realloc(cr_runtime->temp_strings, new_cap * sizeof(CR_TempString));
-        if (!new_list) {
-            return NULL;
-        }
-        cr_runtime->temp_strings = new_list;
-        cr_runtime->temp_string_capacity = new_cap;
-    }
-
-    char *buffer = _cr_alloc(size);
-    if (!buffer) {
+    CR_ArenaChunk *chunk = _cr_text_arena_reserve(size);
+    if (!chunk) {
         return NULL;
     }
-
-    cr_runtime->temp_strings[cr_runtime->temp_string_count++] = (CR_TempString){
-        .ptr = buffer,
-        .size = size,
-    };
+    char *buffer = chunk->data + chunk->used;
+    chunk->used += size;
     return buffer;
 }
 
 // ============================================================================
-// HOOK & COMPONENT HELPERS
+// STRING INTERNING
 // ============================================================================
 
-typedef struct {
-    void *get;
-    void *set;
-} CR_StateHandleBlocks;
+// Open addressing with linear probing; capacity stays a power of two and at
+// most half full so probes stay short
+static bool _cr_intern_grow(void) {
+    size_t new_cap = cr_runtime->interned_capacity == 0 ? 64 : cr_runtime->interned_capacity * 2;
+    CR_Str *slots = _cr_alloc(new_cap * sizeof(CR_Str));
+    if (!slots) {
+        return false;
+    }
 
-static bool _cr_id_equal(CR_Id a, CR_Id b) {
-    if (!a.name || !b.name) return false;
-    if (strcmp(a.name, b.name) != 0) return false;
-    if (a.indexed != b.indexed) return false;
-    if (a.indexed && a.index != b.index) return false;
+    for (size_t i = 0; i < cr_runtime->interned_capacity; i++) {
+        CR_Str str = cr_runtime->interned[i];
+        if (!str.chars) continue;
+        size_t slot = str.hash & (new_cap - 1);
+        while (slots[slot].chars) {
+            slot = (slot + 1) & (new_cap - 1);
+        }
+        slots[slot] = str;
+    }
+
+    _cr_free(cr_runtime->interned, cr_runtime->interned_capacity * sizeof(CR_Str));
+    cr_runtime->interned = slots;
+    cr_runtime->interned_capacity = new_cap;
     return true;
 }
 
-static bool _cr_ensure_capacity(void **buffer, size_t *capacity, size_t needed, size_t item_size) {
-    if (*capacity >= needed) {
-        return true;
+CR_Str cr_intern_n(const char * $nullable chars, size_t length) {
+    if (!chars || length == 0) {
+        return $lit("");
     }
-    size_t new_cap = *capacity == 0 ? 8 : *capacity;
-    while (new_cap < needed) {
-        new_cap *= 2;
+    if (!cr_runtime) {
+        cr_init();
     }
-    void *new_buffer = realloc(*buffer, new_cap * item_size);
-    if (!new_buffer) {
-        return false;
+    if (!cr_runtime) {
+        return cr_str_n($cast_nonnull(chars), length);
     }
-    *buffer = new_buffer;
-    *capacity = new_cap;
-    return true;
+
+    if ((cr_runtime->interned_count + 1) * 2 > cr_runtime->interned_capacity && !_cr_intern_grow()) {
+        return cr_str_n($cast_nonnull(chars), length);
+    }
+
+    CR_Str key = cr_str_n($cast_nonnull(chars), length);
+    key.hash = cr_hash_bytes($cast_nonnull(chars), length);
+
+    size_t mask = cr_runtime->interned_capacity - 1;
+    size_t slot = key.hash & mask;
+    while (cr_runtime->interned[slot].chars) {
+        if (cr_str_equal(cr_runtime->interned[slot], key)) {
+            return cr_runtime->interned[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    char *copy = _cr_alloc(length + 1);
+    if (!copy) {
+        return key;
+    }
+    memcpy(copy, $cast_nonnull(chars), length);
+
+    key.chars = copy;
+    key.is_static = true;
+    cr_runtime->interned[slot] = key;
+    cr_runtime->interned_count++;
+    return key;
 }
 
-static void _cr_register_component(CR_Component *component) {
-    if (!cr_runtime || !component) return;
-    if (!_cr_ensure_capacity((void **)&cr_runtime->components,
-            &cr_runtime->component_capacity,
-            cr_runtime->component_count + 1,
-            sizeof(*cr_runtime->components))) {
+CR_Str cr_intern(const char * $nullable chars) {
+    return cr_intern_n(chars, chars ? strlen($cast_nonnull(chars)) : 0);
+}
+
+static void _cr_free_interned(void) {
+    if (!cr_runtime->interned) {
         return;
     }
-    cr_runtime->components[cr_runtime->component_count++] = component;
+    for (size_t i = 0; i < cr_runtime->interned_capacity; i++) {
+        CR_Str str = cr_runtime->interned[i];
+        if (str.chars) {
+            _cr_free((void *)str.chars, (size_t)str.length + 1);
+        }
+    }
+    _cr_free(cr_runtime->interned, cr_runtime->interned_capacity * sizeof(CR_Str));
+    cr_runtime->interned = NULL;
+    cr_runtime->interned_count = 0;
+    cr_runtime->interned_capacity = 0;
 }
 
-static void _cr_unregister_component(CR_Component *component) {
-    if (!cr_runtime || !component) return;
-    for (size_t i = 0; i < cr_runtime->component_count; i++) {
-        if (cr_runtime->components[i] == component) {
-            cr_runtime->components[i] = cr_runtime->components[cr_runtime->component_count - 1];
-            cr_runtime->component_count--;
-            return;
+// ============================================================================
+// ELEMENT ID MAP
+// ============================================================================
+
+// Clay ids are already hashes; one multiply spreads them over the low bits
+static inline size_t _cr_id_map_slot(uint32_t key, size_t capacity) {
+    return (size_t)(key * 2654435761u) & (capacity - 1);
+}
+
+static bool _cr_id_map_grow(CR_IdMap *map) {
+    size_t new_cap = map->capacity == 0 ? 64 : map->capacity * 2;
+    uint32_t *keys = _cr_alloc(new_cap * sizeof(uint32_t));
+    uint32_t *values = _cr_alloc(new_cap * sizeof(uint32_t));
+    if (!keys || !values) {
+        _cr_free(keys, new_cap * sizeof(uint32_t));
+        _cr_free(values, new_cap * sizeof(uint32_t));
+        return false;
+    }
+
+    for (size_t i = 0; i < map->capacity; i++) {
+        uint32_t key = map->keys[i];
+        if (!key) continue;
+        size_t slot = _cr_id_map_slot(key, new_cap);
+        while (keys[slot]) {
+            slot = (slot + 1) & (new_cap - 1);
         }
+        keys[slot] = key;
+        values[slot] = map->values[i];
     }
+
+    _cr_free(map->keys, map->capacity * sizeof(uint32_t));
+    _cr_free(map->values, map->capacity * sizeof(uint32_t));
+    map->keys = keys;
+    map->values = values;
+    map->capacity = new_cap;
+    return true;
 }
 
-static void _cr_component_add_child(CR_Component *parent, CR_Component *child, size_t index) {
-    if (!parent || !child) return;
-    if (!_cr_ensure_capacity((void **)&parent->children,
-            &parent->child_capacity,
-            parent->child_count + 1,
-            sizeof(*parent->children))) {
-        return;
+static bool _cr_id_map_put(CR_IdMap *map, uint32_t key, uint32_t value) {
+    if (!key) return false;
+    if ((map->count + 1) * 2 > map->capacity && !_cr_id_map_grow(map)) {
+        return false;
     }
-    if (index > parent->child_count) {
-        index = parent->child_count;
+
+    size_t slot = _cr_id_map_slot(key, map->capacity);
+    while (map->keys[slot] && map->keys[slot] != key) {
+        slot = (slot + 1) & (map->capacity - 1);
     }
-    if (index < parent->child_count) {
-        memmove(&parent->children[index + 1],
-                &parent->children[index],
-                (parent->child_count - index) * sizeof(*parent->children));
+    if (!map->keys[slot]) {
+        map->keys[slot] = key;
+        map->count++;
     }
-    parent->children[index] = child;
-    parent->child_count++;
+    map->values[slot] = value;
+    return true;
 }
 
-static void _cr_component_remove_child(CR_Component *parent, CR_Component *child) {
-    if (!parent || !child || parent->child_count == 0) return;
-    for (size_t i = 0; i < parent->child_count; i++) {
-        if (parent->children[i] == child) {
-            if (i + 1 < parent->child_count) {
-                memmove(&parent->children[i],
-                        &parent->children[i + 1],
-                        (parent->child_count - i - 1) * sizeof(*parent->children));
-            }
-            parent->child_count--;
-            return;
+static bool _cr_id_map_get(const CR_IdMap *map, uint32_t key, uint32_t * $nullable value) {
+    if (!key || map->count == 0) return false;
+
+    size_t slot = _cr_id_map_slot(key, map->capacity);
+    while (map->keys[slot]) {
+        if (map->keys[slot] == key) {
+            if (value) *value = map->values[slot];
+            return true;
         }
+        slot = (slot + 1) & (map->capacity - 1);
     }
+    return false;
 }
 
-static void _cr_clear_deps(CR_Hook *hook) {
-    if (!hook) return;
-    if (hook->deps) {
-        for (size_t i = 0; i < hook->dep_count; i++) {
-            if (hook->deps[i].data) {
-                _cr_free(hook->deps[i].data, hook->deps[i].size);
-            }
+static void _cr_id_map_clear(CR_IdMap *map) {
+    if (map->count == 0) return;
+    memset($cast_nonnull(map->keys), 0, map->capacity * sizeof(uint32_t));
+    map->count = 0;
+}
+
+static void _cr_id_map_free(CR_IdMap *map) {
+    _cr_free(map->keys, map->capacity * sizeof(uint32_t));
+    _cr_free(map->values, map->capacity * sizeof(uint32_t));
+    *map = (CR_IdMap){0};
+}
+
+// ============================================================================
+// FORMATTED TEXT
+// ============================================================================
+
+// Output buffer for the formatter: either the free tail of the frame arena
+// (committed once done) or a heap buffer owned by a memo entry
+typedef struct {
+    char * $nullable data;
+    size_t length;
+    size_t capacity;
+    bool in_arena;
+    bool failed;
+} CR_FmtOut;
+
+static bool _cr_fmt_reserve(CR_FmtOut *out, size_t extra) {
+    if (out->failed) return false;
+    size_t needed = out->length + extra;
+    if (needed <= out->capacity) return true;
+
+    size_t capacity = out->capacity * 2 > needed ? out->capacity * 2 : needed;
+    if (capacity < 64) capacity = 64;
+    char *data;
+    if (out->in_arena) {
+        // The text being built is uncommitted, so moving to another chunk
+        // just copies it
+        CR_ArenaChunk *chunk = _cr_text_arena_reserve(capacity);
+        if (!chunk) {
+            out->failed = true;
+            return false;
+        }
+        data = chunk->data + chunk->used;
+        if (out->length) {
+            memcpy(data, $cast_nonnull(out->data), out->length);
+        }
+        capacity = chunk->size - chunk->used;
+    } else {
+        data = realloc(out->data, capacity);
+        if (!data) {
+            out->failed = true;
+            return false;
         }
-        free(hook->deps);
     }
-    hook->deps = NULL;
-    hook->dep_count = 0;
-    hook->deps_initialized = false;
+    out->data = data;
+    out->capacity = capacity;
+    return true;
 }
 
-static void _cr_cleanup_hook(CR_Hook *hook) {
-    if (!hook) return;
+static $always_inline void _cr_fmt_put(CR_FmtOut *out, const char *chars, size_t length) {
+    if (length == 0 || !_cr_fmt_reserve(out, length)) return;
+    memcpy($cast_nonnull(out->data) + out->length, chars, length);
+    out->length += length;
+}
 
-    _cr_clear_deps(hook);
+static const char _cr_digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Writes value right-aligned ending at end; returns the first digit
+static char *_cr_fmt_u64(char *end, uint64_t value) {
+    char *p = end;
+    while (value >= 100) {
+        const char *pair = _cr_digit_pairs + (value % 100) * 2;
+        value /= 100;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+    if (value >= 10) {
+        const char *pair = _cr_digit_pairs + value * 2;
+        *--p = pair[1];
+        *--p = pair[0];
+    } else {
+        *--p = (char)('0' + value);
+    }
+    return p;
+}
 
-    switch (hook->type) {
-        case CR_HOOK_STATE: {
-            if (hook->state.handle) {
-                CR_StateHandleBlocks *blocks = (CR_StateHandleBlocks *)hook->state.handle;
-                if (blocks->get) Block_release(blocks->get);
-                if (blocks->set) Block_release(blocks->set);
-                _cr_free(hook->state.handle, hook->state.handle_size);
-            }
-            if (hook->state.state) {
-                _cr_free(hook->state.state->value, hook->state.state->size);
-                _cr_free(hook->state.state, sizeof(*hook->state.state));
-            }
-            break;
+static void _cr_fmt_uint(CR_FmtOut *out, uintmax_t value, bool negative) {
+    char digits[24];
+    char *end = digits + sizeof(digits);
+    char *start = _cr_fmt_u64(end, (uint64_t)value);
+    if (negative) *--start = '-';
+    _cr_fmt_put(out, start, (size_t)(end - start));
+}
+
+static void _cr_fmt_int(CR_FmtOut *out, intmax_t value) {
+    uintmax_t magnitude = value < 0 ? (uintmax_t)0 - (uintmax_t)value : (uintmax_t)value;
+    _cr_fmt_uint(out, magnitude, value < 0);
+}
+
+static void _cr_fmt_hex(CR_FmtOut *out, uintmax_t value, bool upper) {
+    const char *set = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char digits[16];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+    do {
+        *--p = set[value & 0xF];
+        value >>= 4;
+    } while (value);
+    _cr_fmt_put(out, p, (size_t)(end - p));
+}
+
+static const uint64_t _cr_pow10[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+    10000000ull, 100000000ull, 1000000000ull,
+};
+
+// %.Nf for N <= 9 and moderate magnitudes via one scaled integer. Scaling
+// rounds once, so the scaled value is within half an ulp of the exact
+// product; when that leaves it within an ulp of a .5 tie the rounding
+// direction is unknowable here (0.015 scales to 1.5 but printf prints 0.01),
+// and it returns false to defer to snprintf, as for anything else.
+static bool _cr_fmt_fixed(CR_FmtOut *out, double value, int precision) {
+    if (precision > 9 || !isfinite(value)) return false;
+    uint64_t scale = _cr_pow10[precision];
+    double scaled = fabs(value) * (double)scale;
+    if (scaled >= 9.0e18) return false;
+
+    double whole = floor(scaled);
+    double rest = scaled - whole;
+    if (fabs(rest - 0.5) <= nextafter(scaled, INFINITY) - scaled) return false;
+    uint64_t total = (uint64_t)whole + (rest > 0.5 ? 1 : 0);
+    char digits[32];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+    if (precision > 0) {
+        uint64_t fraction = total % scale;
+        for (int i = 0; i < precision; i++) {
+            *--p = (char)('0' + fraction % 10);
+            fraction /= 10;
         }
-        case CR_HOOK_REF:
-            if (hook->ref.ptr) {
-                _cr_free(hook->ref.ptr, hook->ref.size);
+        *--p = '.';
+    }
+    p = _cr_fmt_u64(p, total / scale);
+    if (signbit(value)) *--p = '-';
+    _cr_fmt_put(out, p, (size_t)(end - p));
+    return true;
+}
+
+typedef enum {
+    CR_FMT_ARG_NONE,
+    CR_FMT_ARG_INT,
+    CR_FMT_ARG_UINT,
+    CR_FMT_ARG_DOUBLE,
+    CR_FMT_ARG_LONG_DOUBLE,
+    CR_FMT_ARG_STRING,
+    CR_FMT_ARG_POINTER,
+} CR_FmtArgKind;
+
+typedef struct {
+    const char *start;      // The whole "%...c" spec, for the snprintf path
+    size_t length;
+    bool simple;            // No flags or width, so the fast formatters apply
+    bool star_width;
+    bool star_precision;
+    int precision;          // -1 = default
+    char size;              // 0, 'H' (hh), 'h', 'l', 'q' (ll), 'j', 'z', 't', 'L'
+    char conversion;
+    CR_FmtArgKind kind;
+} CR_FmtSpec;
+
+typedef struct {
+    CR_FmtArgKind kind;
+    int width;
+    int precision;
+    union {
+        intmax_t i;
+        uintmax_t u;
+        double d;
+        long double ld;
+        const char * $nullable s;
+        void * $nullable p;
+    };
+} CR_FmtArg;
+
+// Parse the spec at *cursor (just past the '%'); advances past it
+static bool _cr_fmt_parse(const char **cursor, CR_FmtSpec *spec) {
+    const char *p = *cursor;
+    *spec = (CR_FmtSpec){ .start = p - 1, .simple = true, .precision = -1 };
+
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') {
+        spec->simple = false;
+        p++;
+    }
+    if (*p == '*') {
+        spec->star_width = true;
+        spec->simple = false;
+        p++;
+    } else {
+        while (*p >= '0' && *p <= '9') {
+            spec->simple = false;
+            p++;
+        }
+    }
+    if (*p == '.') {
+        p++;
+        spec->precision = 0;
+        if (*p == '*') {
+            spec->star_precision = true;
+            spec->simple = false;
+            p++;
+        } else {
+            while (*p >= '0' && *p <= '9') {
+                spec->precision = spec->precision * 10 + (*p - '0');
+                p++;
             }
+        }
+    }
+
+    switch (*p) {
+        case 'h': spec->size = p[1] == 'h' ? 'H' : 'h'; p += p[1] == 'h' ? 2 : 1; break;
+        case 'l': spec->size = p[1] == 'l' ? 'q' : 'l'; p += p[1] == 'l' ? 2 : 1; break;
+        case 'j': case 'z': case 't': case 'L': spec->size = *p++; break;
+        default: break;
+    }
+
+    spec->conversion = *p;
+    switch (*p) {
+        case 'd': case 'i': case 'c':
+            spec->kind = CR_FMT_ARG_INT;
             break;
-        case CR_HOOK_TEXT_INPUT:
-            if (hook->text_input.state) {
-                free(hook->text_input.state->buffer);
-                free(hook->text_input.state);
-            }
+        case 'u': case 'o': case 'x': case 'X':
+            spec->kind = CR_FMT_ARG_UINT;
             break;
-        case CR_HOOK_MEMO:
-            if (hook->memo.value) {
-                _cr_free(hook->memo.value, hook->memo.size);
-            }
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec->kind = spec->size == 'L' ? CR_FMT_ARG_LONG_DOUBLE : CR_FMT_ARG_DOUBLE;
             break;
-        case CR_HOOK_CALLBACK:
-            if (hook->callback.block) {
-                Block_release(hook->callback.block);
-            }
+        case 's':
+            spec->kind = CR_FMT_ARG_STRING;
             break;
-        case CR_HOOK_EFFECT:
-            if (hook->effect.effect.cleanup) {
-                hook->effect.effect.cleanup();
-                Block_release(hook->effect.effect.cleanup);
+        case 'p': case 'n':
+            spec->kind = CR_FMT_ARG_POINTER;
+            break;
+        default:
+            return false;   // Malformed: emitted verbatim
+    }
+    p++;
+    spec->length = (size_t)(p - spec->start);
+    *cursor = p;
+    return true;
+}
+
+static CR_FmtArg _cr_fmt_read(const CR_FmtSpec *spec, va_list *args) {
+    CR_FmtArg arg = { .kind = spec->kind, .precision = spec->precision };
+    if (spec->star_width) arg.width = va_arg(*args, int);
+    if (spec->star_precision) arg.precision = va_arg(*args, int);
+
+    switch (spec->kind) {
+        case CR_FMT_ARG_INT:
+            switch (spec->size) {
+                case 'l': arg.i = va_arg(*args, long); break;
+                case 'q': arg.i = va_arg(*args, long long); break;
+                case 'j': arg.i = va_arg(*args, intmax_t); break;
+                case 'z': arg.i = (intmax_t)va_arg(*args, size_t); break;
+                case 't': arg.i = va_arg(*args, ptrdiff_t); break;
+                case 'H': arg.i = (signed char)va_arg(*args, int); break;
+                case 'h': arg.i = (short)va_arg(*args, int); break;
+                default: arg.i = va_arg(*args, int); break;
             }
-            if (hook->effect.effect.effect) {
-                Block_release(hook->effect.effect.effect);
+            break;
+        case CR_FMT_ARG_UINT:
+            switch (spec->size) {
+                case 'l': arg.u = va_arg(*args, unsigned long); break;
+                case 'q': arg.u = va_arg(*args, unsigned long long); break;
+                case 'j': arg.u = va_arg(*args, uintmax_t); break;
+                case 'z': arg.u = va_arg(*args, size_t); break;
+                case 't': arg.u = (uintmax_t)va_arg(*args, ptrdiff_t); break;
+                case 'H': arg.u = (unsigned char)va_arg(*args, unsigned int); break;
+                case 'h': arg.u = (unsigned short)va_arg(*args, unsigned int); break;
+                default: arg.u = va_arg(*args, unsigned int); break;
             }
             break;
-        case CR_HOOK_ID:
-        case CR_HOOK_SIGNAL:
-        case CR_HOOK_NONE:
-        default:
+        case CR_FMT_ARG_DOUBLE:
+            arg.d = va_arg(*args, double);
+            break;
+        case CR_FMT_ARG_LONG_DOUBLE:
+            arg.ld = va_arg(*args, long double);
+            break;
+        case CR_FMT_ARG_STRING:
+            arg.s = va_arg(*args, const char *);
+            break;
+        case CR_FMT_ARG_POINTER:
+            arg.p = va_arg(*args, void *);
             break;
+        case CR_FMT_ARG_NONE:
+            break;
+    }
+    return arg;
+}
+
+// Star arguments were consumed while reading; pass them back in order
+#define CR_FMT_SNPRINTF(value) \
+    (spec->star_width && spec->star_precision ? snprintf(dest, room, one, arg->width, arg->precision, value) : \
+     spec->star_width ? snprintf(dest, room, one, arg->width, value) : \
+     spec->star_precision ? snprintf(dest, room, one, arg->precision, value) : \
+     snprintf(dest, room, one, value))
+
+// Anything the fast formatters skip goes through snprintf one spec at a time
+static void _cr_fmt_slow(CR_FmtOut *out, const CR_FmtSpec *spec, const CR_FmtArg *arg) {
+    if (spec->conversion == 'n' || spec->length >= 32) return;
+    char one[32];
+    memcpy(one, spec->start, spec->length);
+    one[spec->length] = '\0';
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        size_t room = out->capacity - out->length;
+        char *dest = out->data ? $cast_nonnull(out->data) + out->length : NULL;
+        int written = 0;
+        switch (spec->kind) {
+            case CR_FMT_ARG_INT:
+                switch (spec->size) {
+                    case 'l': written = CR_FMT_SNPRINTF((long)arg->i); break;
+                    case 'q': written = CR_FMT_SNPRINTF((long long)arg->i); break;
+                    case 'j': written = CR_FMT_SNPRINTF(arg->i); break;
+                    case 'z': written = CR_FMT_SNPRINTF((size_t)arg->i); break;
+                    case 't': written = CR_FMT_SNPRINTF((ptrdiff_t)arg->i); break;
+                    default: written = CR_FMT_SNPRINTF((int)arg->i); break;
+                }
+                break;
+            case CR_FMT_ARG_UINT:
+                switch (spec->size) {
+                    case 'l': written = CR_FMT_SNPRINTF((unsigned long)arg->u); break;
+                    case 'q': written = CR_FMT_SNPRINTF((unsigned long long)arg->u); break;
+                    case 'j': written = CR_FMT_SNPRINTF(arg->u); break;
+                    case 'z': written = CR_FMT_SNPRINTF((size_t)arg->u); break;
+                    case 't': written = CR_FMT_SNPRINTF((ptrdiff_t)arg->u); break;
+                    default: written = CR_FMT_SNPRINTF((unsigned int)arg->u); break;
+                }
+                break;
+            case CR_FMT_ARG_DOUBLE: written = CR_FMT_SNPRINTF(arg->d); break;
+            case CR_FMT_ARG_LONG_DOUBLE: written = CR_FMT_SNPRINTF(arg->ld); break;
+            case CR_FMT_ARG_STRING: written = CR_FMT_SNPRINTF(arg->s ? arg->s : "(null)"); break;
+            case CR_FMT_ARG_POINTER: written = CR_FMT_SNPRINTF(arg->p); break;
+            case CR_FMT_ARG_NONE: break;
+        }
+        if (written <= 0) return;
+        if ((size_t)written < room) {
+            out->length += (size_t)written;
+            return;
+        }
+        // snprintf needs room for its terminator; retry once with enough
+        if (!_cr_fmt_reserve(out, (size_t)written + 1)) return;
+    }
+}
+
+#undef CR_FMT_SNPRINTF
+
+static void _cr_fmt_arg(CR_FmtOut *out, const CR_FmtSpec *spec, const CR_FmtArg *arg) {
+    if (spec->simple) {
+        switch (spec->conversion) {
+            case 'd': case 'i':
+                if (spec->precision < 0) {
+                    _cr_fmt_int(out, arg->i);
+                    return;
+                }
+                break;
+            case 'u':
+                if (spec->precision < 0) {
+                    _cr_fmt_uint(out, arg->u, false);
+                    return;
+                }
+                break;
+            case 'x': case 'X':
+                if (spec->precision < 0) {
+                    _cr_fmt_hex(out, arg->u, spec->conversion == 'X');
+                    return;
+                }
+                break;
+            case 'c': {
+                char c = (char)arg->i;
+                _cr_fmt_put(out, &c, 1);
+                return;
+            }
+            case 's': {
+                const char *s = arg->s ? arg->s : "(null)";
+                size_t length = spec->precision < 0 ? strlen(s) : strnlen(s, (size_t)spec->precision);
+                _cr_fmt_put(out, s, length);
+                return;
+            }
+            case 'f': case 'F':
+                if (spec->kind == CR_FMT_ARG_DOUBLE &&
+                        _cr_fmt_fixed(out, arg->d, spec->precision < 0 ? 6 : spec->precision)) {
+                    return;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    _cr_fmt_slow(out, spec, arg);
+}
+
+static void _cr_fmt_run(CR_FmtOut *out, const char *fmt, va_list args) {
+    va_list list;
+    va_copy(list, args);
+    const char *p = fmt;
+    while (*p) {
+        const char *literal = p;
+        while (*p && *p != '%') p++;
+        _cr_fmt_put(out, literal, (size_t)(p - literal));
+        if (!*p) break;
+
+        p++;
+        if (*p == '%') {
+            _cr_fmt_put(out, "%", 1);
+            p++;
+            continue;
+        }
+        CR_FmtSpec spec;
+        const char *spec_start = p;
+        if (!_cr_fmt_parse(&p, &spec)) {
+            _cr_fmt_put(out, spec_start - 1, 1);
+            p = spec_start;
+            continue;
+        }
+        CR_FmtArg arg = _cr_fmt_read(&spec, &list);
+        _cr_fmt_arg(out, &spec, &arg);
+    }
+    va_end(list);
+}
+
+static uint64_t _cr_fnv1a(uint64_t hash, const void *data, size_t length) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Bytes of a long double that hold its value; x87 extended precision pads
+// its 10 out to 12 or 16 with unspecified bytes
+#if LDBL_MANT_DIG == 64
+#define CR_LDBL_VALUE_BYTES 10
+#else
+#define CR_LDBL_VALUE_BYTES sizeof(long double)
+#endif
+
+// Hash of the values a format would print; strings hash by content
+static uint64_t _cr_fmt_hash_args(const char *fmt, va_list args) {
+    va_list list;
+    va_copy(list, args);
+    uint64_t hash = 14695981039346656037ull;
+    const char *p = fmt;
+    while ((p = strchr(p, '%'))) {
+        p++;
+        if (*p == '%') {
+            p++;
+            continue;
+        }
+        CR_FmtSpec spec;
+        if (!_cr_fmt_parse(&p, &spec)) continue;
+        CR_FmtArg arg = _cr_fmt_read(&spec, &list);
+        hash = _cr_fnv1a(hash, &arg.width, sizeof(arg.width));
+        hash = _cr_fnv1a(hash, &arg.precision, sizeof(arg.precision));
+        switch (arg.kind) {
+            case CR_FMT_ARG_INT: hash = _cr_fnv1a(hash, &arg.i, sizeof(arg.i)); break;
+            case CR_FMT_ARG_UINT: hash = _cr_fnv1a(hash, &arg.u, sizeof(arg.u)); break;
+            case CR_FMT_ARG_DOUBLE: hash = _cr_fnv1a(hash, &arg.d, sizeof(arg.d)); break;
+            case CR_FMT_ARG_LONG_DOUBLE: hash = _cr_fnv1a(hash, &arg.ld, CR_LDBL_VALUE_BYTES); break;
+            case CR_FMT_ARG_POINTER: hash = _cr_fnv1a(hash, &arg.p, sizeof(arg.p)); break;
+            case CR_FMT_ARG_STRING: {
+                const char *s = arg.s ? arg.s : "";
+                size_t length = arg.precision < 0 ? strlen(s) : strnlen(s, (size_t)arg.precision);
+                hash = _cr_fnv1a(hash, s, length + 1);
+                break;
+            }
+            case CR_FMT_ARG_NONE:
+                break;
+        }
+    }
+    va_end(list);
+    return hash;
+}
+
+CR_Str _cr_format_v(const char *fmt, va_list args) {
+    if (!cr_runtime) {
+        cr_init();
+    }
+    if (!cr_runtime) return $lit("");
+
+    CR_FmtOut out = { .in_arena = true };
+    CR_ArenaChunk *chunk = _cr_text_arena_reserve(64);
+    if (chunk) {
+        out.data = chunk->data + chunk->used;
+        out.capacity = chunk->size - chunk->used;
+    }
+    _cr_fmt_run(&out, fmt, args);
+    _cr_fmt_put(&out, "", 1);   // Terminated for callers that want a C string
+    if (out.failed || !out.data || !cr_runtime->text_arena_top) return $lit("");
+
+    // Commit: the text sits at the top chunk's free tail
+    CR_ArenaChunk *top = $cast_nonnull(cr_runtime->text_arena_top);
+    top->used += out.length;
+    return cr_str_n($cast_nonnull(out.data), out.length - 1);
+}
+
+CR_Str cr_format(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    CR_Str str = _cr_format_v(fmt, args);
+    va_end(args);
+    return str;
+}
+
+#define CR_TEXT_MEMO_TTL 120
+
+CR_Str _cr_format_memo_v(uint32_t key, const char *fmt, va_list args) {
+    if (!cr_runtime) {
+        cr_init();
+    }
+    if (!cr_runtime || key == 0) return _cr_format_v(fmt, args);
+
+    uint64_t hash = _cr_fmt_hash_args(fmt, args);
+    uint32_t index = 0;
+    CR_TextMemo *memo = NULL;
+    if (_cr_id_map_get(&cr_runtime->text_memo_map, key, &index)) {
+        memo = &cr_runtime->text_memos[index];
+        if (memo->fmt == fmt && memo->arg_hash == hash && memo->chars) {
+            memo->last_frame = cr_runtime->frame;
+            return cr_str_n($cast_nonnull(memo->chars), memo->length);
+        }
+        // Rewriting an entry already shown this frame would change text
+        // another element still points at
+        if (memo->last_frame == cr_runtime->frame) {
+            return _cr_format_v(fmt, args);
+        }
+    } else {
+        if (cr_runtime->text_memo_count == cr_runtime->text_memo_capacity) {
+            size_t capacity = cr_runtime->text_memo_capacity ? cr_runtime->text_memo_capacity * 2 : 64;
+            CR_TextMemo *memos = realloc(cr_runtime->text_memos, capacity * sizeof(CR_TextMemo));
+            if (!memos) return _cr_format_v(fmt, args);
+            cr_runtime->text_memos = memos;
+            cr_runtime->text_memo_capacity = capacity;
+        }
+        index = (uint32_t)cr_runtime->text_memo_count++;
+        memo = &cr_runtime->text_memos[index];
+        *memo = (CR_TextMemo){ .key = key };
+        _cr_id_map_put(&cr_runtime->text_memo_map, key, index);
+    }
+
+    CR_FmtOut out = { .data = memo->chars, .capacity = memo->capacity };
+    _cr_fmt_run(&out, fmt, args);
+    _cr_fmt_put(&out, "", 1);
+    memo->chars = out.data;
+    memo->capacity = out.capacity;
+    if (out.failed) {
+        memo->fmt = NULL;
+        return _cr_format_v(fmt, args);
+    }
+    memo->fmt = fmt;
+    memo->arg_hash = hash;
+    memo->length = out.length - 1;
+    memo->last_frame = cr_runtime->frame;
+    return cr_str_n(memo->chars ? $cast_nonnull(memo->chars) : "", memo->length);
+}
+
+// Drop memos no element asked for in a while and reindex the survivors
+static void _cr_sweep_text_memos(void) {
+    if (cr_runtime->text_memo_count == 0) return;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < cr_runtime->text_memo_count; i++) {
+        CR_TextMemo memo = cr_runtime->text_memos[i];
+        if (cr_runtime->frame - memo.last_frame > CR_TEXT_MEMO_TTL) {
+            free(memo.chars);
+            continue;
+        }
+        cr_runtime->text_memos[kept++] = memo;
+    }
+    if (kept == cr_runtime->text_memo_count) return;
+
+    cr_runtime->text_memo_count = kept;
+    _cr_id_map_clear(&cr_runtime->text_memo_map);
+    for (size_t i = 0; i < kept; i++) {
+        _cr_id_map_put(&cr_runtime->text_memo_map, cr_runtime->text_memos[i].key, (uint32_t)i);
+    }
+}
+
+static void _cr_free_text_memos(void) {
+    for (size_t i = 0; i < cr_runtime->text_memo_count; i++) {
+        free(cr_runtime->text_memos[i].chars);
+    }
+    free(cr_runtime->text_memos);
+    cr_runtime->text_memos = NULL;
+    cr_runtime->text_memo_count = 0;
+    cr_runtime->text_memo_capacity = 0;
+    _cr_id_map_free(&cr_runtime->text_memo_map);
+}
+
+// ============================================================================
+// PARAGRAPH LINE BREAKING
+// ============================================================================
+
+void cr_set_measure_text(CR_MeasureTextFn measure, void * $nullable user_data) {
+    if (!cr_runtime) {
+        cr_init();
+    }
+    if (cr_runtime) {
+        cr_runtime->measure_text = measure;
+        cr_runtime->measure_text_user_data = user_data;
+    }
+    Clay_SetMeasureTextFunction(measure, user_data);
+}
+
+// Word-at-a-time hash, so checking a long log for changes stays cheap
+static uint64_t _cr_hash_text(const char *chars, size_t length) {
+    uint64_t hash = 0x9E3779B97F4A7C15ull;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        memcpy(&word, chars + i, 8);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, chars + i, length - i);
+    hash = (hash ^ tail ^ length) * 0xC4CEB9FE1A85EC53ull;
+    return hash ^ (hash >> 29);
+}
+
+static float _cr_measure_width(const char *chars, size_t start, size_t end, Clay_TextElementConfig *config) {
+    if (end <= start) return 0.0f;
+    Clay_StringSlice slice = { .length = (int32_t)(end - start), .chars = chars + start, .baseChars = chars };
+    CR_MeasureTextFn measure = $cast_nonnull(cr_runtime->measure_text);
+    return measure(slice, config, cr_runtime->measure_text_user_data).width;
+}
+
+static bool _cr_paragraph_push(CR_ParagraphLines *para, size_t start, size_t end) {
+    if (para->line_count == para->line_capacity) {
+        size_t capacity = para->line_capacity ? para->line_capacity * 2 : 64;
+        CR_TextLine *lines = realloc(para->lines, capacity * sizeof(CR_TextLine));
+        if (!lines) return false;
+        para->lines = lines;
+        para->line_capacity = capacity;
+    }
+    $cast_nonnull(para->lines)[para->line_count++] = (CR_TextLine){ (uint32_t)start, (uint32_t)end };
+    return true;
+}
+
+// Greedy word wrap of chars[start, length) onto para's lines. Greedy breaks
+// before a line never depend on what follows it, which is what lets an
+// append resume from the last line.
+static bool _cr_paragraph_break(CR_ParagraphLines *para, const char *chars, size_t length,
+        size_t start, Clay_TextElementConfig *config, float width) {
+    float space = _cr_measure_width(" ", 0, 1, config);
+    size_t line_start = start;
+    size_t line_end = start;
+    float line_width = 0.0f;
+    bool line_empty = true;
+
+    size_t i = start;
+    for (;;) {
+        size_t j = i;
+        while (j < length && chars[j] != ' ' && chars[j] != '\n') j++;
+        float word = _cr_measure_width(chars, i, j, config);
+
+        if (!line_empty && line_width + space + word > width) {
+            if (!_cr_paragraph_push(para, line_start, line_end)) return false;
+            line_start = i;
+            line_width = word;
+        } else {
+            line_width += line_empty ? word : space + word;
+        }
+        line_empty = false;
+        line_end = j;
+
+        if (j >= length) break;
+        if (chars[j] == '\n') {
+            if (!_cr_paragraph_push(para, line_start, j)) return false;
+            line_start = line_end = j + 1;
+            line_width = 0.0f;
+            line_empty = true;
+        }
+        i = j + 1;
+    }
+    return _cr_paragraph_push(para, line_start, line_end);
+}
+
+const CR_ParagraphLines * $nullable _cr_paragraph_lines(uint32_t key, Clay_String text,
+        Clay_TextElementConfig *config, float width) {
+    if (!cr_runtime) {
+        cr_init();
+    }
+    if (!cr_runtime || !cr_runtime->measure_text || key == 0 || text.length < 0) return NULL;
+
+    const char *chars = text.chars ? text.chars : "";
+    size_t length = text.chars ? (size_t)text.length : 0;
+    uint64_t font_key = (uint64_t)config->fontId |
+        (uint64_t)config->fontSize << 16 |
+        (uint64_t)config->letterSpacing << 32 |
+        (uint64_t)config->lineHeight << 48;
+
+    uint32_t index = 0;
+    CR_ParagraphLines *para;
+    if (_cr_id_map_get(&cr_runtime->paragraph_map, key, &index)) {
+        para = &cr_runtime->paragraphs[index];
+    } else {
+        if (cr_runtime->paragraph_count == cr_runtime->paragraph_capacity) {
+            size_t capacity = cr_runtime->paragraph_capacity ? cr_runtime->paragraph_capacity * 2 : 16;
+            CR_ParagraphLines *paragraphs = realloc(cr_runtime->paragraphs, capacity * sizeof(CR_ParagraphLines));
+            if (!paragraphs) return NULL;
+            cr_runtime->paragraphs = paragraphs;
+            cr_runtime->paragraph_capacity = capacity;
+        }
+        index = (uint32_t)cr_runtime->paragraph_count++;
+        para = &cr_runtime->paragraphs[index];
+        *para = (CR_ParagraphLines){ .key = key };
+        _cr_id_map_put(&cr_runtime->paragraph_map, key, index);
+    }
+    para->last_frame = cr_runtime->frame;
+
+    // Same width and font, and the text still starts with what was broken
+    size_t resume = 0;
+    if (para->line_count > 0 && para->width == width && para->font_key == font_key &&
+            length >= para->text_length &&
+            _cr_hash_text(chars, para->text_length) == para->text_hash) {
+        if (length == para->text_length) return para;
+        // Appended: only the last line can take the new words
+        para->line_count--;
+        resume = $cast_nonnull(para->lines)[para->line_count].start;
+    } else {
+        para->line_count = 0;
+    }
+
+    if (!_cr_paragraph_break(para, chars, length, resume, config, width)) {
+        para->line_count = 0;
+        return NULL;
+    }
+    para->text_length = length;
+    para->text_hash = _cr_hash_text(chars, length);
+    para->width = width;
+    para->font_key = font_key;
+    return para;
+}
+
+// Drop line caches for paragraphs that stopped rendering
+static void _cr_sweep_paragraphs(void) {
+    if (cr_runtime->paragraph_count == 0) return;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < cr_runtime->paragraph_count; i++) {
+        CR_ParagraphLines para = cr_runtime->paragraphs[i];
+        if (cr_runtime->frame - para.last_frame > CR_TEXT_MEMO_TTL) {
+            free(para.lines);
+            continue;
+        }
+        cr_runtime->paragraphs[kept++] = para;
+    }
+    if (kept == cr_runtime->paragraph_count) return;
+
+    cr_runtime->paragraph_count = kept;
+    _cr_id_map_clear(&cr_runtime->paragraph_map);
+    for (size_t i = 0; i < kept; i++) {
+        _cr_id_map_put(&cr_runtime->paragraph_map, cr_runtime->paragraphs[i].key, (uint32_t)i);
+    }
+}
+
+static void _cr_free_paragraphs(void) {
+    for (size_t i = 0; i < cr_runtime->paragraph_count; i++) {
+        free(cr_runtime->paragraphs[i].lines);
+    }
+    free(cr_runtime->paragraphs);
+    cr_runtime->paragraphs = NULL;
+    cr_runtime->paragraph_count = 0;
+    cr_runtime->paragraph_capacity = 0;
+    _cr_id_map_free(&cr_runtime->paragraph_map);
+}
+
+// ============================================================================
+// STATE SNAPSHOTS
+// ============================================================================
+
+// File layout, native byte order:
+//   header: "CRSS", u32 version, u32 record count, u32 reserved
+//   record: u64 path, u32 hook, u32 size, u64 type hash, u16 name length,
+//           name bytes, value bytes
+#define CR_SNAPSHOT_MAGIC "CRSS"
+#define CR_SNAPSHOT_VERSION 1u
+#define CR_SNAPSHOT_HEADER_SIZE 16
+#define CR_SNAPSHOT_RECORD_SIZE 26
+
+// Frames a restored snapshot waits for components to mount
+#define CR_SNAPSHOT_PENDING_FRAMES 120
+
+// Identity that survives a restart: the parent's path, the name, and either
+// the key or the child slot of unkeyed components
+static uint64_t _cr_component_path(CR_Component * $nullable parent, const char *name,
+        const CR_Id * $nullable key, size_t index) {
+    uint64_t hash = parent ? parent->path_hash : 14695981039346656037ull;
+    hash = _cr_fnv1a(hash, name, strlen(name));
+    if (key) {
+        uint32_t key_hash = key->hash;
+        uint32_t key_index = key->indexed ? key->index + 1 : 0;
+        hash = _cr_fnv1a(hash, &key_hash, sizeof(key_hash));
+        hash = _cr_fnv1a(hash, &key_index, sizeof(key_index));
+    } else {
+        uint64_t slot = (uint64_t)index;
+        hash = _cr_fnv1a(hash, &slot, sizeof(slot));
+    }
+    return hash ? hash : 1;
+}
+
+// Pointers would not survive a restart, so such types are left out
+static bool _cr_type_is_plain(struct Type type) {
+    switch (type.type) {
+        case TypeType_PRIMITIVE:
+            return type.primitive.type != TypeEncoding_CHAR_POINTER &&
+                type.primitive.type != TypeEncoding_POINTER;
+        case TypeType_POINTER:
+            return false;
+        case TypeType_ARRAY:
+            return _cr_type_is_plain(*type.array.type);
+        case TypeType_STRUCT:
+            for (size_t i = 0; i < type.structure.field_count; i++) {
+                if (!_cr_type_is_plain($cast_nonnull(type.structure.fields)[i].type)) return false;
+            }
+            return true;
+        case TypeType_UNION:
+            for (size_t i = 0; i < type.union_.field_count; i++) {
+                if (!_cr_type_is_plain($cast_nonnull(type.union_.fields)[i].type)) return false;
+            }
+            return true;
+    }
+    return false;
+}
+
+static void _cr_put_bytes(uint8_t **cursor, const void *data, size_t size) {
+    memcpy(*cursor, data, size);
+    *cursor += size;
+}
+
+// Only $use_typed_state values are saved: an untyped state's bytes may hold
+// pointers that would dangle after a restart
+static bool _cr_state_is_saved(const CR_Hook *hook) {
+    if (hook->type != CR_HOOK_STATE || !hook->state.state) return false;
+    CR_StateInternal *state = $cast_nonnull(hook->state.state);
+    if (state->size > UINT32_MAX) return false;
+    return state->type.hash != 0 && _cr_type_is_plain(state->type);
+}
+
+bool cr_snapshot_write(const char *path) {
+    if (!cr_runtime || !path) return false;
+
+    // Size first so the file is written in one go
+    size_t size = CR_SNAPSHOT_HEADER_SIZE;
+    uint32_t count = 0;
+    for (size_t i = 0; i < cr_runtime->component_count; i++) {
+        CR_Component *component = cr_runtime->components[i];
+        size_t name_length = strnlen(component->name, UINT16_MAX);
+        for (size_t h = 0; h < component->hook_count; h++) {
+            if (!_cr_state_is_saved(&component->hooks[h])) continue;
+            CR_StateInternal *state = $cast_nonnull(component->hooks[h].state.state);
+            size += CR_SNAPSHOT_RECORD_SIZE + name_length + state->size;
+            count++;
+        }
+    }
+
+    uint8_t *data = malloc(size);
+    if (!data) return false;
+    uint8_t *cursor = data;
+    uint32_t version = CR_SNAPSHOT_VERSION;
+    uint32_t reserved = 0;
+    _cr_put_bytes(&cursor, CR_SNAPSHOT_MAGIC, 4);
+    _cr_put_bytes(&cursor, &version, sizeof(version));
+    _cr_put_bytes(&cursor, &count, sizeof(count));
+    _cr_put_bytes(&cursor, &reserved, sizeof(reserved));
+
+    for (size_t i = 0; i < cr_runtime->component_count; i++) {
+        CR_Component *component = cr_runtime->components[i];
+        uint16_t name_length = (uint16_t)strnlen(component->name, UINT16_MAX);
+        for (size_t h = 0; h < component->hook_count; h++) {
+            if (!_cr_state_is_saved(&component->hooks[h])) continue;
+            CR_StateInternal *state = $cast_nonnull(component->hooks[h].state.state);
+            uint32_t hook = (uint32_t)h;
+            uint32_t value_size = (uint32_t)state->size;
+            uint64_t type_hash = state->type.hash;
+            _cr_put_bytes(&cursor, &component->path_hash, sizeof(uint64_t));
+            _cr_put_bytes(&cursor, &hook, sizeof(hook));
+            _cr_put_bytes(&cursor, &value_size, sizeof(value_size));
+            _cr_put_bytes(&cursor, &type_hash, sizeof(type_hash));
+            _cr_put_bytes(&cursor, &name_length, sizeof(name_length));
+            _cr_put_bytes(&cursor, component->name, name_length);
+            _cr_put_bytes(&cursor, state->value, state->size);
+        }
+    }
+
+    // Write beside the target and rename, so a restart mid-write keeps the
+    // previous snapshot intact
+    size_t path_length = strlen(path);
+    char *temp_path = malloc(path_length + 5);
+    if (!temp_path) {
+        free(data);
+        return false;
+    }
+    memcpy(temp_path, path, path_length);
+    memcpy(temp_path + path_length, ".tmp", 5);
+
+    bool ok = false;
+    FILE *file = fopen(temp_path, "wb");
+    if (file) {
+        ok = fwrite(data, 1, size, file) == size;
+        ok = fclose(file) == 0 && ok;
+        ok = ok && rename(temp_path, path) == 0;
+        if (!ok) {
+            remove(temp_path);
+        }
+    }
+    free(temp_path);
+    free(data);
+    return ok;
+}
+
+static void _cr_snapshot_discard(void) {
+    free(cr_runtime->snapshot_entries);
+    free(cr_runtime->snapshot_data);
+    cr_runtime->snapshot_entries = NULL;
+    cr_runtime->snapshot_entry_count = 0;
+    cr_runtime->snapshot_data = NULL;
+    cr_runtime->snapshot_size = 0;
+}
+
+static int _cr_snapshot_entry_compare(const void *a, const void *b) {
+    const CR_SnapshotEntry *left = a;
+    const CR_SnapshotEntry *right = b;
+    if (left->path != right->path) return left->path < right->path ? -1 : 1;
+    if (left->hook != right->hook) return left->hook < right->hook ? -1 : 1;
+    return 0;
+}
+
+bool cr_snapshot_restore(const char *path) {
+    if (!cr_runtime) {
+        cr_init();
+    }
+    if (!cr_runtime || !path) return false;
+    _cr_snapshot_discard();
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return false;
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        length = ftell(file);
+    }
+    if (length < CR_SNAPSHOT_HEADER_SIZE || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return false;
+    }
+    size_t size = (size_t)length;
+    uint8_t *data = malloc(size);
+    bool read = data && fread(data, 1, size, file) == size;
+    fclose(file);
+    if (!read) {
+        free(data);
+        return false;
+    }
+
+    uint32_t version = 0;
+    uint32_t count = 0;
+    memcpy(&version, data + 4, sizeof(version));
+    memcpy(&count, data + 8, sizeof(count));
+    if (memcmp(data, CR_SNAPSHOT_MAGIC, 4) != 0 || version != CR_SNAPSHOT_VERSION ||
+            count > (size - CR_SNAPSHOT_HEADER_SIZE) / CR_SNAPSHOT_RECORD_SIZE) {
+        free(data);
+        return false;
+    }
+
+    CR_SnapshotEntry *entries = count ? calloc(count, sizeof(CR_SnapshotEntry)) : NULL;
+    if (count && !entries) {
+        free(data);
+        return false;
+    }
+    size_t offset = CR_SNAPSHOT_HEADER_SIZE;
+    bool valid = true;
+    for (uint32_t i = 0; i < count; i++) {
+        if (size - offset < CR_SNAPSHOT_RECORD_SIZE) {
+            valid = false;
+            break;
+        }
+        CR_SnapshotEntry *entry = &entries[i];
+        uint16_t name_length = 0;
+        memcpy(&entry->path, data + offset, 8);
+        memcpy(&entry->hook, data + offset + 8, 4);
+        memcpy(&entry->size, data + offset + 12, 4);
+        memcpy(&entry->type_hash, data + offset + 16, 8);
+        memcpy(&name_length, data + offset + 24, 2);
+        offset += CR_SNAPSHOT_RECORD_SIZE;
+        if (size - offset < (size_t)name_length + entry->size) {
+            valid = false;
+            break;
+        }
+        entry->name = (const char *)data + offset;
+        entry->name_length = name_length;
+        entry->value = data + offset + name_length;
+        offset += (size_t)name_length + entry->size;
+    }
+    if (!valid) {
+        free(entries);
+        free(data);
+        return false;
+    }
+    if (count) {
+        qsort(entries, count, sizeof(CR_SnapshotEntry), _cr_snapshot_entry_compare);
+    }
+
+    cr_runtime->snapshot_entries = entries;
+    cr_runtime->snapshot_entry_count = count;
+    cr_runtime->snapshot_data = data;
+    cr_runtime->snapshot_size = size;
+    cr_runtime->snapshot_expires = cr_runtime->frame + CR_SNAPSHOT_PENDING_FRAMES;
+    return true;
+}
+
+// Seed a freshly mounted state from the restored snapshot, if it has one
+static void _cr_snapshot_apply(CR_StateInternal *state, CR_Component *component, uint32_t hook) {
+    CR_SnapshotEntry probe = { .path = component->path_hash, .hook = hook };
+    CR_SnapshotEntry *entry = bsearch(&probe, cr_runtime->snapshot_entries,
+        cr_runtime->snapshot_entry_count, sizeof(CR_SnapshotEntry), _cr_snapshot_entry_compare);
+    if (!entry || entry->applied) return;
+    entry->applied = true;
+
+    if (state->type.hash == 0 || !_cr_type_is_plain(state->type) ||
+            entry->size != state->size || entry->type_hash != state->type.hash) {
+        return;
+    }
+    if (entry->name_length != strnlen(component->name, UINT16_MAX) ||
+            memcmp(entry->name, component->name, entry->name_length) != 0) {
+        return;
+    }
+    memcpy(state->value, entry->value, state->size);
+}
+
+// ============================================================================
+// HOOK & COMPONENT HELPERS
+// ============================================================================
+
+typedef struct {
+    void *get;
+    void *set;
+} CR_StateHandleBlocks;
+
+// Cheapest checks first: index, then name pointer (literals are shared),
+// then the cached hashes, and only then the bytes.
+static bool _cr_id_equal(CR_Id a, CR_Id b) {
+    if (!a.name || !b.name) return false;
+    if (a.indexed != b.indexed) return false;
+    if (a.indexed && a.index != b.index) return false;
+    if (a.name == b.name) return true;
+    if (cr_id_is_hashed(a) && cr_id_is_hashed(b) &&
+        (a.hash != b.hash || a.length != b.length)) {
+        return false;
+    }
+    return strcmp($cast_nonnull(a.name), $cast_nonnull(b.name)) == 0;
+}
+
+static bool _cr_ensure_capacity(void **buffer, size_t *capacity, size_t needed, size_t item_size) {
+    if (*capacity >= needed) {
+        return true;
+    }
+    size_t new_cap = *capacity == 0 ? 8 : *capacity;
+    while (new_cap < needed) {
+        new_cap *= 2;
+    }
+    void *new_buffer = realloc(*buffer, new_cap * item_size);
+    if (!new_buffer) {
+        return false;
+    }
+    *buffer = new_buffer;
+    *capacity = new_cap;
+    return true;
+}
+
+static void _cr_register_component(CR_Component *component) {
+    if (!cr_runtime || !component) return;
+    if (!_cr_ensure_capacity((void **)&cr_runtime->components,
+            &cr_runtime->component_capacity,
+            cr_runtime->component_count + 1,
+            sizeof(*cr_runtime->components))) {
+        return;
+    }
+    component->registry_index = cr_runtime->component_count;
+    cr_runtime->components[cr_runtime->component_count++] = component;
+}
+
+static void _cr_unregister_component(CR_Component *component) {
+    if (!cr_runtime || !component) return;
+    size_t index = component->registry_index;
+    if (index >= cr_runtime->component_count || cr_runtime->components[index] != component) {
+        return;
+    }
+    CR_Component *last = cr_runtime->components[--cr_runtime->component_count];
+    cr_runtime->components[index] = last;
+    last->registry_index = index;
+}
+
+static void _cr_component_add_child(CR_Component *parent, CR_Component *child, size_t index) {
+    if (!parent || !child) return;
+    if (!_cr_ensure_capacity((void **)&parent->children,
+            &parent->child_capacity,
+            parent->child_count + 1,
+            sizeof(*parent->children))) {
+        return;
+    }
+    if (index > parent->child_count) {
+        index = parent->child_count;
+    }
+    if (index < parent->child_count) {
+        memmove(&parent->children[index + 1],
+                &parent->children[index],
+                (parent->child_count - index) * sizeof(*parent->children));
+    }
+    parent->children[index] = child;
+    parent->child_count++;
+}
+
+static void _cr_component_remove_child(CR_Component *parent, CR_Component *child) {
+    if (!parent || !child || parent->child_count == 0) return;
+    for (size_t i = 0; i < parent->child_count; i++) {
+        if (parent->children[i] == child) {
+            if (i + 1 < parent->child_count) {
+                memmove(&parent->children[i],
+                        &parent->children[i + 1],
+                        (parent->child_count - i - 1) * sizeof(*parent->children));
+            }
+            parent->child_count--;
+            return;
+        }
+    }
+}
+
+static void _cr_clear_deps(CR_Hook *hook) {
+    if (!hook) return;
+    if (hook->deps) {
+        for (size_t i = 0; i < hook->dep_count; i++) {
+            if (hook->deps[i].data) {
+                _cr_free(hook->deps[i].data, hook->deps[i].size);
+            }
+        }
+        free(hook->deps);
+    }
+    hook->deps = NULL;
+    hook->dep_count = 0;
+    hook->deps_initialized = false;
+}
+
+// Timer min-heap keyed on deadline; every timer remembers its slot so
+// rescheduling and cancellation are O(log n) without searching.
+#define CR_TIMER_UNSCHEDULED SIZE_MAX
+
+static void _cr_timer_heap_place(size_t index, CR_TimerInternal *timer) {
+    cr_runtime->timers[index] = timer;
+    timer->heap_index = index;
+}
+
+static void _cr_timer_heap_sift_up(size_t index) {
+    CR_TimerInternal *timer = cr_runtime->timers[index];
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        CR_TimerInternal *above = cr_runtime->timers[parent];
+        if (above->deadline_ns <= timer->deadline_ns) break;
+        _cr_timer_heap_place(index, above);
+        index = parent;
+    }
+    _cr_timer_heap_place(index, timer);
+}
+
+static void _cr_timer_heap_sift_down(size_t index) {
+    size_t count = cr_runtime->timer_count;
+    CR_TimerInternal *timer = cr_runtime->timers[index];
+    for (;;) {
+        size_t child = index * 2 + 1;
+        if (child >= count) break;
+        if (child + 1 < count &&
+            cr_runtime->timers[child + 1]->deadline_ns < cr_runtime->timers[child]->deadline_ns) {
+            child++;
+        }
+        CR_TimerInternal *below = cr_runtime->timers[child];
+        if (timer->deadline_ns <= below->deadline_ns) break;
+        _cr_timer_heap_place(index, below);
+        index = child;
+    }
+    _cr_timer_heap_place(index, timer);
+}
+
+static void _cr_timer_unschedule(CR_TimerInternal *timer) {
+    if (!cr_runtime || timer->heap_index == CR_TIMER_UNSCHEDULED) return;
+
+    size_t index = timer->heap_index;
+    size_t last = --cr_runtime->timer_count;
+    timer->heap_index = CR_TIMER_UNSCHEDULED;
+    if (index == last) return;
+
+    _cr_timer_heap_place(index, $cast_nonnull(cr_runtime->timers[last]));
+    _cr_timer_heap_sift_down(index);
+    _cr_timer_heap_sift_up(cr_runtime->timers[index]->heap_index);
+}
+
+static bool _cr_timer_schedule(CR_TimerInternal *timer, uint64_t deadline_ns) {
+    if (!cr_runtime) return false;
+
+    if (timer->heap_index != CR_TIMER_UNSCHEDULED) {
+        uint64_t previous = timer->deadline_ns;
+        timer->deadline_ns = deadline_ns;
+        if (deadline_ns < previous) {
+            _cr_timer_heap_sift_up(timer->heap_index);
+        } else {
+            _cr_timer_heap_sift_down(timer->heap_index);
+        }
+        return true;
+    }
+
+    if (!_cr_ensure_capacity((void **)&cr_runtime->timers,
+            &cr_runtime->timer_capacity,
+            cr_runtime->timer_count + 1,
+            sizeof(*cr_runtime->timers))) {
+        return false;
+    }
+    timer->deadline_ns = deadline_ns;
+    _cr_timer_heap_place(cr_runtime->timer_count++, timer);
+    _cr_timer_heap_sift_up(timer->heap_index);
+    return true;
+}
+
+static void _cr_cleanup_hook(CR_Hook *hook) {
+    if (!hook) return;
+
+    _cr_clear_deps(hook);
+
+    switch (hook->type) {
+        case CR_HOOK_STATE: {
+            if (hook->state.handle) {
+                CR_StateHandleBlocks *blocks = (CR_StateHandleBlocks *)hook->state.handle;
+                if (blocks->get) Block_release(blocks->get);
+                if (blocks->set) Block_release(blocks->set);
+                _cr_free(hook->state.handle, hook->state.handle_size);
+            }
+            if (hook->state.state) {
+                _cr_free(hook->state.state->value, hook->state.state->size);
+                _cr_free(hook->state.state, sizeof(*hook->state.state));
+            }
+            break;
+        }
+        case CR_HOOK_REF:
+            if (hook->ref.ptr) {
+                _cr_free(hook->ref.ptr, hook->ref.size);
+            }
+            break;
+        case CR_HOOK_TEXT_INPUT:
+            _cr_free_text_input(hook->text_input.state);
+            break;
+        case CR_HOOK_MEMO:
+            if (hook->memo.value) {
+                _cr_free(hook->memo.value, hook->memo.size);
+            }
+            break;
+        case CR_HOOK_CALLBACK:
+            if (hook->callback.block) {
+                Block_release(hook->callback.block);
+            }
+            break;
+        case CR_HOOK_EFFECT:
+            if (hook->effect.effect.cleanup) {
+                hook->effect.effect.cleanup();
+                Block_release(hook->effect.effect.cleanup);
+            }
+            if (hook->effect.effect.effect) {
+                Block_release(hook->effect.effect.effect);
+            }
+            break;
+        case CR_HOOK_TIMER:
+            if (hook->timer.timer) {
+                CR_TimerInternal *timer = $cast_nonnull(hook->timer.timer);
+                _cr_timer_unschedule(timer);
+                if (timer->callback) {
+                    Block_release(timer->callback);
+                }
+                _cr_free(timer, sizeof(CR_TimerInternal));
+            }
+            break;
+        case CR_HOOK_ID:
+        case CR_HOOK_SIGNAL:
+        case CR_HOOK_ANIMATION:
+        case CR_HOOK_NONE:
+        default:
+            break;
+    }
+
+    *hook = (CR_Hook){0};
+}
+
+// Tear down a subtree without touching the parent's child array; callers
+// either truncate that array in one go or remove the single entry. The
+// component structs go to the graveyard so queued effect references can
+// still check the dead flag until the queues are flushed.
+static void _cr_release_subtree(CR_Component *component) {
+    for (size_t i = component->child_count; i > 0; i--) {
+        _cr_release_subtree(component->children[i - 1]);
+    }
+    component->child_count = 0;
+
+    for (size_t i = 0; i < component->hook_count; i++) {
+        _cr_cleanup_hook(&component->hooks[i]);
+    }
+    component->hook_count = 0;
+
+    if (component->hooks) {
+        free(component->hooks);
+        component->hooks = NULL;
+    }
+    if (component->children) {
+        free(component->children);
+    }
+    if (component->props_copy) {
+        _cr_free(component->props_copy, component->props_size);
+        component->props_copy = NULL;
+    }
+
+    if (cr_runtime && cr_runtime->root == component) {
+        cr_runtime->root = NULL;
+    }
+
+    if (component->keep_alive && cr_runtime) {
+        for (size_t i = 0; i < cr_runtime->keep_alive_count; i++) {
+            if (cr_runtime->keep_alive_boundaries[i] == component) {
+                cr_runtime->keep_alive_boundaries[i] =
+                    cr_runtime->keep_alive_boundaries[--cr_runtime->keep_alive_count];
+                break;
+            }
+        }
+    }
+
+    _cr_unregister_component(component);
+    component->dead = true;
+    component->parent = NULL;
+    if (cr_runtime && _cr_ensure_capacity((void **)&cr_runtime->graveyard,
+            &cr_runtime->graveyard_capacity,
+            cr_runtime->graveyard_count + 1,
+            sizeof(*cr_runtime->graveyard))) {
+        cr_runtime->graveyard[cr_runtime->graveyard_count++] = component;
+    } else {
+        _cr_free(component, sizeof(*component));
+    }
+}
+
+static void _cr_destroy_component(CR_Component *component) {
+    if (!component) return;
+    if (component->parent) {
+        _cr_component_remove_child($cast_nonnull(component->parent), component);
+    }
+    _cr_release_subtree(component);
+}
+
+// Children past the cursor were not visited by this render: drop them all in
+// one pass. Hidden keep-alive boundaries skip their body and keep everything.
+static void _cr_drop_unvisited_children(CR_Component *component) {
+    if (component->keep_alive && component->hidden) return;
+    size_t keep = component->child_cursor;
+    if (keep >= component->child_count) return;
+    for (size_t i = component->child_count; i > keep; i--) {
+        _cr_release_subtree(component->children[i - 1]);
+    }
+    component->child_count = keep;
+}
+
+static CR_Component *$nullable _cr_create_component(const char *name, CR_Component *$nullable parent, bool keyed, CR_Id key) {
+    CR_Component *component = _cr_alloc(sizeof(CR_Component));
+    if (!component) return NULL;
+    component->name = name;
+    component->id = cr_runtime->next_component_id++;
+    component->parent = parent;
+    component->keyed = keyed;
+    component->key = key;
+    if (keyed && key.name && !cr_id_is_hashed(key)) {
+        // Stored keys are compared every frame; hash them once up front
+        CR_Id hashed = cr_id_hashed($cast_nonnull(key.name));
+        component->key.length = hashed.length;
+        component->key.hash = hashed.hash;
+    }
+    component->children = NULL;
+    component->child_count = 0;
+    component->child_capacity = 0;
+    component->child_cursor = 0;
+    component->hooks = NULL;
+    component->hook_count = 0;
+    component->hook_capacity = 0;
+    component->hook_cursor = 0;
+    component->last_render_frame = 0;
+    component->props_copy = NULL;
+    component->props_size = 0;
+
+    _cr_register_component(component);
+    return component;
+}
+
+static void _cr_move_child(CR_Component *parent, size_t from, size_t to) {
+    if (!parent || from == to || parent->child_count == 0) return;
+    if (to >= parent->child_count) {
+        to = parent->child_count - 1;
+    }
+    CR_Component *child = parent->children[from];
+    if (from < to) {
+        memmove(&parent->children[from],
+                &parent->children[from + 1],
+                (to - from) * sizeof(*parent->children));
+    } else {
+        memmove(&parent->children[to + 1],
+                &parent->children[to],
+                (from - to) * sizeof(*parent->children));
+    }
+    parent->children[to] = child;
+}
+
+static CR_Component *$nullable _cr_find_child_by_key(CR_Component *parent, CR_Id key, const char *name, size_t index) {
+    if (!parent || !name) return NULL;
+    size_t target = index;
+    if (target >= parent->child_count && parent->child_count > 0) {
+        target = parent->child_count - 1;
+    }
+    // Children before the cursor were already claimed this frame
+    for (size_t i = index; i < parent->child_count; i++) {
+        CR_Component *child = parent->children[i];
+        if (child->keyed && _cr_id_equal(child->key, key)) {
+            if (strcmp(child->name, name) != 0) {
+                _cr_destroy_component(child);
+                return NULL;
+            }
+            if (i != target) {
+                _cr_move_child(parent, i, target);
+            }
+            return parent->children[target];
+        }
+    }
+    return NULL;
+}
+
+static CR_Component *$nullable _cr_get_child_by_index(CR_Component *parent, const char *name, size_t index, bool *replace) {
+    *replace = false;
+    if (!parent || !name) return NULL;
+    if (index >= parent->child_count) {
+        return NULL;
+    }
+    CR_Component *child = parent->children[index];
+    if (child->keyed) {
+        // Leave it for a later key lookup; the new child is inserted before it
+        return NULL;
+    }
+    if (strcmp(child->name, name) != 0) {
+        // Positional replacement: the caller reuses the slot, no array shift
+        _cr_release_subtree(child);
+        *replace = true;
+        return NULL;
+    }
+    return child;
+}
+
+static void _cr_queue_effect(CR_Hook *hook, CR_EffectKind kind) {
+    if (!cr_runtime || !hook || !cr_runtime->current_component) return;
+    CR_Component *component = cr_runtime->current_component;
+    if (!component || !component->hooks) return;
+
+    // An idle effect waiting for its slot just picks up the newer block
+    if (kind == CR_EFFECT_IDLE && hook->effect.queued) return;
+
+    size_t hook_index = (size_t)(hook - component->hooks);
+    CR_EffectRef ref = {
+        .component = component,
+        .hook_index = hook_index,
+        .component_id = component->id,
+    };
+
+    CR_EffectRef **queue = &cr_runtime->pending_effects;
+    size_t *count = &cr_runtime->pending_effect_count;
+    size_t *capacity = &cr_runtime->pending_effect_capacity;
+    switch (kind) {
+        case CR_EFFECT_LAYOUT:
+            queue = &cr_runtime->pending_layout_effects;
+            count = &cr_runtime->pending_layout_effect_count;
+            capacity = &cr_runtime->pending_layout_effect_capacity;
+            break;
+        case CR_EFFECT_IDLE:
+            queue = &cr_runtime->pending_idle_effects;
+            count = &cr_runtime->pending_idle_effect_count;
+            capacity = &cr_runtime->pending_idle_effect_capacity;
+            break;
+        case CR_EFFECT_PASSIVE:
+        default:
+            break;
+    }
+    if (!_cr_ensure_capacity((void **)queue, capacity, *count + 1, sizeof(CR_EffectRef))) {
+        return;
+    }
+    (*queue)[(*count)++] = ref;
+    hook->effect.queued = true;
+}
+
+// Released components stay in the graveyard until every queue that could
+// reference them has been flushed, so the dead flag is always readable.
+static bool _cr_component_is_alive(CR_Component *component, uint64_t id) {
+    if (!component) return false;
+    return !component->dead && component->id == id;
+}
+
+// Resolve a queued reference to its hook, or NULL if the component is gone
+static CR_Hook *$nullable _cr_effect_ref_hook(const CR_EffectRef *ref) {
+    if (!_cr_component_is_alive(ref->component, ref->component_id)) {
+        return NULL;
+    }
+    CR_Component *component = ref->component;
+    if (!component || ref->hook_index >= component->hook_count) {
+        return NULL;
+    }
+    CR_Hook *hook = &component->hooks[ref->hook_index];
+    return hook->type == CR_HOOK_EFFECT ? hook : NULL;
+}
+
+static void _cr_flush_effect_queue(CR_EffectRef *queue, size_t *count) {
+    if (!queue || !count) return;
+    for (size_t i = 0; i < *count; i++) {
+        CR_Hook *hook = _cr_effect_ref_hook(&queue[i]);
+        if (hook) {
+            hook->effect.queued = false;
+            _cr_run_effect(&hook->effect.effect);
+        }
+    }
+    *count = 0;
+}
+
+// ============================================================================
+// CROSS-THREAD POSTING
+// ============================================================================
+
+// Intrusive MPSC queue (Vyukov): producers only touch post_head, the UI
+// thread owns post_tail. The stub node keeps the queue non-empty.
+static void _cr_post_queue_init(CR_Runtime *runtime) {
+    atomic_store_explicit(&runtime->post_stub.next, NULL, memory_order_relaxed);
+    runtime->post_stub.block = NULL;
+    atomic_store_explicit(&runtime->post_head, &runtime->post_stub, memory_order_relaxed);
+    runtime->post_tail = &runtime->post_stub;
+    atomic_store_explicit(&runtime->post_pending, false, memory_order_relaxed);
+}
+
+static void _cr_post_push(CR_Runtime *runtime, CR_PostNode *node) {
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    CR_PostNode *prev = atomic_exchange_explicit(&runtime->post_head, node, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+static CR_PostNode *$nullable _cr_post_pop(CR_Runtime *runtime) {
+    CR_PostNode *tail = runtime->post_tail;
+    CR_PostNode *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (tail == &runtime->post_stub) {
+        if (!next) return NULL;
+        runtime->post_tail = next;
+        tail = next;
+        next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    }
+    if (next) {
+        runtime->post_tail = next;
+        return tail;
+    }
+    if (tail != atomic_load_explicit(&runtime->post_head, memory_order_acquire)) {
+        return NULL; // A producer is mid-push; it will wake us again
+    }
+    _cr_post_push(runtime, &runtime->post_stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next) {
+        runtime->post_tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+static void _cr_drain_posts(bool run) {
+    if (!cr_runtime) return;
+    CR_Runtime *runtime = cr_runtime;
+
+    // Clear before draining so a post racing with the drain wakes us again
+    atomic_store_explicit(&runtime->post_pending, false, memory_order_release);
+
+    CR_PostNode *node = NULL;
+    while ((node = _cr_post_pop(runtime)) != NULL) {
+        if (node->block) {
+            if (run) {
+                node->block();
+            }
+            Block_release(node->block);
+        }
+        free(node);
+    }
+}
+
+bool cr_post_to(CR_Runtime * $nullable runtime, VoidBlock block) {
+    if (!runtime || !block) return false;
+
+    CR_PostNode *node = malloc(sizeof(CR_PostNode));
+    if (!node) return false;
+    node->block = Block_copy(block);
+    _cr_post_push(runtime, node);
+
+    if (!atomic_exchange_explicit(&runtime->post_pending, true, memory_order_acq_rel)) {
+        if (runtime->wake) {
+            runtime->wake(runtime->wake_user_data);
+        }
+    }
+    return true;
+}
+
+bool cr_post(VoidBlock block) {
+    return cr_post_to(cr_runtime, block);
+}
+
+void cr_set_wake_handler(CR_WakeFn $nullable wake, void * $nullable user_data) {
+    if (!cr_runtime) {
+        cr_init();
+    }
+    if (!cr_runtime) return;
+    cr_runtime->wake = wake;
+    cr_runtime->wake_user_data = user_data;
+}
+
+// Unmount the least recently shown hidden subtrees beyond the limit
+static void _cr_enforce_keep_alive_limit(void) {
+    size_t limit = cr_runtime->keep_alive_limit;
+    if (limit == 0) return;
+
+    for (;;) {
+        size_t retained = 0;
+        CR_Component *oldest = NULL;
+        for (size_t i = 0; i < cr_runtime->keep_alive_count; i++) {
+            CR_Component *boundary = cr_runtime->keep_alive_boundaries[i];
+            if (!boundary->hidden || boundary->child_count == 0) continue;
+            retained++;
+            if (!oldest || boundary->last_visible_frame < oldest->last_visible_frame) {
+                oldest = boundary;
+            }
+        }
+        if (retained <= limit || !oldest) return;
+
+        for (size_t i = oldest->child_count; i > 0; i--) {
+            _cr_release_subtree(oldest->children[i - 1]);
+        }
+        oldest->child_count = 0;
+    }
+}
+
+// Unvisited children are dropped as each parent finishes rendering (see
+// _cr_component_end), so only frame-level leftovers are handled here.
+static void _cr_collect_garbage(void) {
+    if (!cr_runtime) return;
+    _cr_enforce_keep_alive_limit();
+    if (cr_runtime->root && cr_runtime->root->last_render_frame != cr_runtime->frame) {
+        _cr_destroy_component($cast_nonnull(cr_runtime->root));
+    }
+}
+
+// Free released components once no effect queue can reference them. Idle
+// effects may outlive a frame, so their dead entries are purged first.
+static void _cr_free_graveyard(void) {
+    if (!cr_runtime || cr_runtime->graveyard_count == 0) return;
+
+    if (cr_runtime->pending_idle_effects) {
+        CR_EffectRef *queue = $cast_nonnull(cr_runtime->pending_idle_effects);
+        size_t kept = 0;
+        for (size_t i = 0; i < cr_runtime->pending_idle_effect_count; i++) {
+            if (!queue[i].component->dead) {
+                queue[kept++] = queue[i];
+            }
+        }
+        cr_runtime->pending_idle_effect_count = kept;
+    }
+
+    for (size_t i = 0; i < cr_runtime->graveyard_count; i++) {
+        _cr_free(cr_runtime->graveyard[i], sizeof(CR_Component));
+    }
+    cr_runtime->graveyard_count = 0;
+}
+
+// ============================================================================
+// FRAME CLOCK
+// ============================================================================
+
+static uint64_t _cr_default_clock(void * $nullable user_data) {
+    (void)user_data;
+    struct timespec ts = {0};
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void cr_set_clock(CR_ClockFn $nullable clock, void * $nullable user_data) {
+    if (!cr_runtime) {
+        cr_init();
+    }
+    if (!cr_runtime) return;
+    cr_runtime->clock = clock;
+    cr_runtime->clock_user_data = user_data;
+    cr_runtime->frame_time_ns = 0;
+}
+
+uint64_t cr_now_ns(void) {
+    if (cr_runtime && cr_runtime->clock) {
+        CR_ClockFn clock = $cast_nonnull(cr_runtime->clock);
+        return clock(cr_runtime->clock_user_data);
+    }
+    return _cr_default_clock(NULL);
+}
+
+double cr_frame_time(void) {
+    return cr_runtime ? (double)cr_runtime->frame_time_ns / 1e9 : 0.0;
+}
+
+float cr_frame_delta(void) {
+    return cr_runtime ? cr_runtime->frame_delta : 0.0f;
+}
+
+void cr_request_frame_at(uint64_t time_ns) {
+    if (!cr_runtime) {
+        cr_init();
+    }
+    if (!cr_runtime) return;
+    if (time_ns == 0) {
+        time_ns = 1;
+    }
+    if (cr_runtime->next_frame_ns == 0 || time_ns < cr_runtime->next_frame_ns) {
+        cr_runtime->next_frame_ns = time_ns;
+    }
+}
+
+// Earliest moment anything scheduled wants a frame (0 = nothing scheduled)
+static uint64_t _cr_next_deadline_ns(void) {
+    uint64_t deadline = cr_runtime->next_frame_ns;
+    if (cr_runtime->timer_count > 0) {
+        uint64_t timer_deadline = cr_runtime->timers[0]->deadline_ns;
+        if (deadline == 0 || timer_deadline < deadline) {
+            deadline = timer_deadline;
+        }
+    }
+    return deadline;
+}
+
+bool cr_is_animating(void) {
+    return cr_runtime && (cr_runtime->animating || cr_runtime->scroll_gliding || cr_runtime->scroll_coasting);
+}
+
+int cr_wait_timeout_ms(void) {
+    if (!cr_runtime || cr_should_render() || cr_runtime->pending_idle_effect_count > 0) {
+        return 0;
+    }
+    uint64_t deadline = _cr_next_deadline_ns();
+    if (deadline == 0) {
+        return -1;
+    }
+    uint64_t now = cr_now_ns();
+    if (now >= deadline) {
+        return 0;
     }
+    uint64_t ms = (deadline - now + 999999ull) / 1000000ull;
+    return ms > (uint64_t)INT_MAX ? INT_MAX : (int)ms;
+}
 
-    *hook = (CR_Hook){0};
+// Sample the clock once per frame; large gaps (idle, debugger) are clamped so
+// physics-driven hooks never take one giant step.
+static void _cr_advance_clock(void) {
+    uint64_t now = cr_now_ns();
+    uint64_t previous = cr_runtime->frame_time_ns;
+    float delta = 0.0f;
+    if (previous != 0 && now > previous) {
+        delta = (float)((double)(now - previous) / 1e9);
+    }
+    cr_runtime->frame_time_ns = now;
+    cr_runtime->frame_delta = delta > 0.1f ? 0.1f : delta;
+    // A request for later (e.g. from an event handler) outlives the frames
+    // that run before it
+    if (cr_runtime->next_frame_ns <= now) {
+        cr_runtime->next_frame_ns = 0;
+    }
+    cr_runtime->animating = false;
+    cr_runtime->scroll_gliding = false;
 }
 
-static void _cr_destroy_component(CR_Component *component) {
-    if (!component) return;
+// Fire every due timer against the frame timestamp. Intervals that fell
+// behind (long stall) skip ahead instead of firing in a burst.
+static void _cr_fire_timers(void) {
+    uint64_t now = cr_runtime->frame_time_ns;
+    while (cr_runtime->timer_count > 0 && cr_runtime->timers[0]->deadline_ns <= now) {
+        CR_TimerInternal *timer = cr_runtime->timers[0];
+        if (timer->interval_ns > 0) {
+            uint64_t next = timer->deadline_ns + timer->interval_ns;
+            if (next <= now) {
+                next = now + timer->interval_ns;
+            }
+            _cr_timer_schedule(timer, next);
+        } else {
+            _cr_timer_unschedule(timer);
+        }
+        if (timer->callback) {
+            VoidBlock callback = $cast_nonnull(timer->callback);
+            callback();
+        }
+    }
+}
 
-    while (component->child_count > 0) {
-        CR_Component *child = component->children[component->child_count - 1];
-        _cr_destroy_component(child);
+// ============================================================================
+// PAINT-ONLY FRAMES
+// ============================================================================
+
+// Hover backgrounds are the one paint input the runtime owns: components bind
+// both colors while rendering, and cr_end_frame notes which rectangle command
+// draws each element. A pointer move that only changes the hovered set then
+// rewrites those colors in place instead of rendering and laying out again.
+bool _cr_bind_hover_paint(uint32_t element_id, Clay_Color background, Clay_Color background_hover) {
+    if (!cr_runtime) return false;
+    bool hovered = _cr_id_map_get(&cr_runtime->hover_ids, element_id, NULL);
+    if (!cr_runtime->is_rendering || _cr_id_map_get(&cr_runtime->paint_map, element_id, NULL)) {
+        return hovered;
     }
 
-    if (component->parent) {
-        _cr_component_remove_child($cast_nonnull(component->parent), component);
+    if (!_cr_ensure_capacity((void **)&cr_runtime->paint_bindings,
+            &cr_runtime->paint_binding_capacity,
+            cr_runtime->paint_binding_count + 1,
+            sizeof(CR_PaintBinding))) {
+        cr_runtime->hover_reads = true;
+        return hovered;
+    }
+    size_t index = cr_runtime->paint_binding_count++;
+    cr_runtime->paint_bindings[index] = (CR_PaintBinding){
+        .element_id = element_id,
+        .command = -1,
+        .background = background,
+        .background_hover = background_hover,
+        .hovered = hovered,
+    };
+    if (!_cr_id_map_put(&cr_runtime->paint_map, element_id, (uint32_t)index + 1)) {
+        cr_runtime->hover_reads = true;
     }
+    return hovered;
+}
 
-    for (size_t i = 0; i < component->hook_count; i++) {
-        _cr_cleanup_hook(&component->hooks[i]);
+static void _cr_paint_reset(void) {
+    cr_runtime->paint_ready = false;
+    cr_runtime->hover_reads = false;
+    cr_runtime->paint_binding_count = 0;
+    _cr_id_map_clear(&cr_runtime->paint_map);
+}
+
+// Remember the frame and find each bound element's background rectangle
+static void _cr_paint_capture(Clay_RenderCommandArray commands) {
+    cr_runtime->paint_commands = commands;
+    cr_runtime->paint_ready = true;
+    if (cr_runtime->paint_binding_count == 0) return;
+
+    for (int32_t i = 0; i < commands.length; i++) {
+        Clay_RenderCommand *command = Clay_RenderCommandArray_Get(&commands, i);
+        if (command->commandType != CLAY_RENDER_COMMAND_TYPE_RECTANGLE) continue;
+        uint32_t index = 0;
+        if (!_cr_id_map_get(&cr_runtime->paint_map, command->id, &index)) continue;
+        CR_PaintBinding *binding = &cr_runtime->paint_bindings[index - 1];
+        if (binding->command < 0) {
+            binding->command = i;
+        }
     }
+}
 
-    if (component->hooks) {
-        free(component->hooks);
+static void _cr_free_paint(void) {
+    free(cr_runtime->paint_bindings);
+    cr_runtime->paint_bindings = NULL;
+    cr_runtime->paint_binding_count = 0;
+    cr_runtime->paint_binding_capacity = 0;
+    _cr_id_map_free(&cr_runtime->paint_map);
+}
+
+bool cr_paint_frame(Clay_RenderCommandArray *commands) {
+    if (!cr_runtime || !cr_runtime->paint_ready || cr_runtime->hover_reads || cr_runtime->is_rendering ||
+        cr_runtime->scroll_translated) {
+        return false;
     }
-    if (component->children) {
-        free(component->children);
+    // Only a changed hover set is paint-only; anything else reaching
+    // cr_should_render may move geometry
+    if (!cr_runtime->hover_dirty || cr_runtime->needs_render || cr_runtime->pointer_down ||
+        cr_runtime->scroll_coasting ||
+        atomic_load_explicit(&cr_runtime->post_pending, memory_order_acquire)) {
+        return false;
     }
-    if (component->props_copy) {
-        _cr_free(component->props_copy, component->props_size);
+    uint64_t deadline = _cr_next_deadline_ns();
+    if (deadline != 0 && cr_now_ns() >= deadline) {
+        return false;
     }
 
-    if (cr_runtime && cr_runtime->root == component) {
-        cr_runtime->root = NULL;
+    // Hover listeners see the new set exactly as a full frame would deliver
+    // it; the next cr_begin_frame diffs against it, so nothing repeats
+    _cr_update_hover();
+    if (cr_runtime->needs_render) {
+        return false;
     }
 
-    _cr_unregister_component(component);
-    _cr_free(component, sizeof(*component));
+    // Clay skips transparent backgrounds, so an element without a rectangle
+    // cannot change color in place. The hover set was already consumed, so
+    // ask for the full frame explicitly.
+    for (size_t i = 0; i < cr_runtime->paint_binding_count; i++) {
+        CR_PaintBinding *binding = &cr_runtime->paint_bindings[i];
+        if (binding->command < 0 &&
+            _cr_id_map_get(&cr_runtime->hover_ids, binding->element_id, NULL) != binding->hovered) {
+            cr_runtime->needs_render = true;
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < cr_runtime->paint_binding_count; i++) {
+        CR_PaintBinding *binding = &cr_runtime->paint_bindings[i];
+        bool hovered = _cr_id_map_get(&cr_runtime->hover_ids, binding->element_id, NULL);
+        if (hovered == binding->hovered) continue;
+        binding->hovered = hovered;
+        Clay_RenderCommand *command = Clay_RenderCommandArray_Get(&cr_runtime->paint_commands, binding->command);
+        command->renderData.rectangle.backgroundColor = hovered ? binding->background_hover : binding->background;
+    }
+
+    cr_runtime->paint_frames++;
+    *commands = cr_runtime->paint_commands;
+    return true;
 }
 
-static CR_Component *$nullable _cr_create_component(const char *name, CR_Component *$nullable parent, bool keyed, CR_Id key) {
-    CR_Component *component = _cr_alloc(sizeof(CR_Component));
-    if (!component) return NULL;
-    component->name = name;
-    component->id = _cr_next_component_id++;
-    component->parent = parent;
-    component->keyed = keyed;
-    component->key = key;
-    component->children = NULL;
-    component->child_count = 0;
-    component->child_capacity = 0;
-    component->child_cursor = 0;
-    component->hooks = NULL;
-    component->hook_count = 0;
-    component->hook_capacity = 0;
-    component->hook_cursor = 0;
-    component->last_render_frame = 0;
-    component->props_copy = NULL;
-    component->props_size = 0;
+bool cr_last_frame(Clay_RenderCommandArray *commands) {
+    if (!cr_runtime || !cr_runtime->paint_ready || cr_runtime->is_rendering || cr_should_render()) {
+        return false;
+    }
+    *commands = cr_runtime->paint_commands;
+    return true;
+}
 
-    _cr_register_component(component);
-    return component;
+// ============================================================================
+// SCROLL-ONLY FRAMES
+// ============================================================================
+
+// Deeper scissor nesting leaves scrolling to full frames
+#define CR_SCROLL_MAX_NESTING 32
+// Window fraction kept past each edge by frames laid out mid-glide
+#define CR_SCROLL_OVERSCAN 0.5f
+
+void cr_bind_scroll_window(Clay_ElementId clip_id, Clay_ElementId anchor_id, float top, float bottom) {
+    if (!cr_runtime || !cr_runtime->is_rendering) return;
+    if (!_cr_ensure_capacity((void **)&cr_runtime->scroll_windows,
+            &cr_runtime->scroll_window_capacity,
+            cr_runtime->scroll_window_count + 1,
+            sizeof(CR_ScrollWindow))) {
+        cr_runtime->scroll_unbound = true;
+        return;
+    }
+    cr_runtime->scroll_windows[cr_runtime->scroll_window_count++] = (CR_ScrollWindow){
+        .clip_id = clip_id.id,
+        .anchor_id = anchor_id.id,
+        .top = top,
+        .bottom = bottom,
+    };
 }
 
-static void _cr_move_child(CR_Component *parent, size_t from, size_t to) {
-    if (!parent || from == to || parent->child_count == 0) return;
-    if (to >= parent->child_count) {
-        to = parent->child_count - 1;
+bool cr_layout_translated(void) {
+    return cr_runtime && cr_runtime->scroll_translated;
+}
+
+static void _cr_scroll_reset(void) {
+    cr_runtime->scroll_ready = false;
+    cr_runtime->scroll_translated = false;
+    cr_runtime->scroll_unbound = false;
+    cr_runtime->scroll_region_count = 0;
+    cr_runtime->scroll_window_count = 0;
+}
+
+static CR_ScrollRegion * $nullable _cr_scroll_region(uint32_t element_id) {
+    for (size_t i = 0; i < cr_runtime->scroll_region_count; i++) {
+        if (cr_runtime->scroll_regions[i].element_id == element_id) {
+            return &cr_runtime->scroll_regions[i];
+        }
     }
-    CR_Component *child = parent->children[from];
-    if (from < to) {
-        memmove(&parent->children[from],
-                &parent->children[from + 1],
-                (to - from) * sizeof(*parent->children));
-    } else {
-        memmove(&parent->children[to + 1],
-                &parent->children[to],
-                (from - to) * sizeof(*parent->children));
+    return NULL;
+}
+
+static bool _cr_boxes_overlap(Clay_BoundingBox a, Clay_BoundingBox b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width &&
+           a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+// The area this frame keeps commands for: the window, grown by the
+// overscan margin while a glide is under way
+static bool _cr_scroll_bounds(Clay_BoundingBox *bounds) {
+    Clay_ElementData root = Clay_GetElementData(Clay_GetElementId(CLAY_STRING("Clay__RootContainer")));
+    if (!root.found) return false;
+    float margin = cr_runtime->scroll_overscan ? CR_SCROLL_OVERSCAN : 0.0f;
+    Clay_Dimensions window = { root.boundingBox.width, root.boundingBox.height };
+    *bounds = (Clay_BoundingBox){
+        -window.width * margin, -window.height * margin,
+        window.width * (1.0f + 2.0f * margin), window.height * (1.0f + 2.0f * margin),
+    };
+    return true;
+}
+
+// Clay lays out overscan frames without culling; drop what lies beyond the
+// margin instead. Scissor commands stay so regions still pair up.
+static void _cr_scroll_cull(Clay_RenderCommandArray *commands) {
+    Clay_BoundingBox bounds;
+    if (!_cr_scroll_bounds(&bounds)) return;
+    int32_t kept = 0;
+    for (int32_t i = 0; i < commands->length; i++) {
+        Clay_RenderCommand *command = Clay_RenderCommandArray_Get(commands, i);
+        bool scissor = command->commandType == CLAY_RENDER_COMMAND_TYPE_SCISSOR_START ||
+                       command->commandType == CLAY_RENDER_COMMAND_TYPE_SCISSOR_END;
+        if (!scissor && !_cr_boxes_overlap(command->boundingBox, bounds)) continue;
+        if (kept != i) {
+            *Clay_RenderCommandArray_Get(commands, kept) = *command;
+        }
+        kept++;
     }
-    parent->children[to] = child;
+    commands->length = kept;
 }
 
-static CR_Component *$nullable _cr_find_child_by_key(CR_Component *parent, CR_Id key, const char *name, size_t index) {
-    if (!parent || !name) return NULL;
-    size_t target = index;
-    if (target >= parent->child_count && parent->child_count > 0) {
-        target = parent->child_count - 1;
+// Pair up the frame's scissor commands and fold each windowed component's
+// rows into the container it scrolls with
+static void _cr_scroll_capture(Clay_RenderCommandArray commands) {
+    if (cr_runtime->scroll_unbound) return;
+    if (!_cr_scroll_bounds(&cr_runtime->scroll_bounds)) return;
+
+    size_t stack[CR_SCROLL_MAX_NESTING];
+    size_t depth = 0;
+    for (int32_t i = 0; i < commands.length; i++) {
+        Clay_RenderCommand *command = Clay_RenderCommandArray_Get(&commands, i);
+        if (command->commandType == CLAY_RENDER_COMMAND_TYPE_SCISSOR_START) {
+            if (depth == CR_SCROLL_MAX_NESTING ||
+                !_cr_ensure_capacity((void **)&cr_runtime->scroll_regions,
+                    &cr_runtime->scroll_region_capacity,
+                    cr_runtime->scroll_region_count + 1,
+                    sizeof(CR_ScrollRegion))) {
+                return;
+            }
+            Clay_ScrollContainerData data = Clay_GetScrollContainerData((Clay_ElementId){ .id = command->id });
+            Clay_Vector2 position = data.found ? *$cast_nonnull(data.scrollPosition) : (Clay_Vector2){0};
+            size_t index = cr_runtime->scroll_region_count++;
+            cr_runtime->scroll_regions[index] = (CR_ScrollRegion){
+                .element_id = command->id,
+                .start = i,
+                .end = -1,
+                .clip = command->boundingBox,
+                .laid_out = position,
+                .shown = position,
+                .window_top = -INFINITY,
+                .window_bottom = INFINITY,
+                .pinned = !data.found,
+            };
+            stack[depth++] = index;
+        } else if (command->commandType == CLAY_RENDER_COMMAND_TYPE_SCISSOR_END) {
+            if (depth == 0) return;
+            cr_runtime->scroll_regions[stack[--depth]].end = i;
+        }
     }
-    for (size_t i = 0; i < parent->child_count; i++) {
-        CR_Component *child = parent->children[i];
-        if (child->keyed && _cr_id_equal(child->key, key)) {
-            if (strcmp(child->name, name) != 0) {
-                _cr_destroy_component(child);
-                return NULL;
+    if (depth != 0) return;
+
+    for (size_t i = 0; i < cr_runtime->scroll_window_count; i++) {
+        CR_ScrollWindow window = cr_runtime->scroll_windows[i];
+        Clay_ElementData anchor = window.anchor_id != 0 ?
+            Clay_GetElementData((Clay_ElementId){ .id = window.anchor_id }) :
+            (Clay_ElementData){0};
+        CR_ScrollRegion *region = window.clip_id != 0 ? _cr_scroll_region(window.clip_id) : NULL;
+        if (!region) {
+            // Rows picked against the window move with whichever container
+            // holds them
+            if (!anchor.found) return;
+            for (size_t j = 0; j < cr_runtime->scroll_region_count; j++) {
+                CR_ScrollRegion *other = &cr_runtime->scroll_regions[j];
+                if (_cr_boxes_overlap(anchor.boundingBox, other->clip)) {
+                    other->pinned = true;
+                }
             }
-            if (i != target) {
-                _cr_move_child(parent, i, target);
+            continue;
+        }
+        float origin = 0.0f;
+        if (window.anchor_id != 0) {
+            if (!anchor.found) {
+                region->pinned = true;
+                continue;
             }
-            return parent->children[target];
+            origin = anchor.boundingBox.y - (region->clip.y + region->laid_out.y);
         }
+        if (window.top + origin > region->window_top) region->window_top = window.top + origin;
+        if (window.bottom + origin < region->window_bottom) region->window_bottom = window.bottom + origin;
     }
-    return NULL;
+    cr_runtime->scroll_ready = true;
 }
 
-static CR_Component *$nullable _cr_get_child_by_index(CR_Component *parent, const char *name, size_t index) {
-    if (!parent || !name) return NULL;
-    if (index >= parent->child_count) {
-        return NULL;
+static void _cr_free_scroll(void) {
+    free(cr_runtime->scroll_regions);
+    cr_runtime->scroll_regions = NULL;
+    cr_runtime->scroll_region_count = 0;
+    cr_runtime->scroll_region_capacity = 0;
+    free(cr_runtime->scroll_windows);
+    cr_runtime->scroll_windows = NULL;
+    cr_runtime->scroll_window_count = 0;
+    cr_runtime->scroll_window_capacity = 0;
+}
+
+// Everything the moved viewport shows must have been laid out: inside the
+// area the frame was culled to, and inside every window bound to it
+static bool _cr_scroll_region_covered(const CR_ScrollRegion *region, Clay_Vector2 position) {
+    if (region->pinned) return false;
+    float left = region->clip.x - (position.x - region->laid_out.x);
+    float top = region->clip.y - (position.y - region->laid_out.y);
+    Clay_BoundingBox bounds = cr_runtime->scroll_bounds;
+    if (left < bounds.x || top < bounds.y ||
+        left + region->clip.width > bounds.x + bounds.width ||
+        top + region->clip.height > bounds.y + bounds.height) {
+        return false;
     }
-    CR_Component *child = parent->children[index];
-    if (!child || child->keyed || strcmp(child->name, name) != 0) {
-        if (child) {
-            _cr_destroy_component(child);
+    return -position.y >= region->window_top && -position.y + region->clip.height <= region->window_bottom;
+}
+
+bool cr_scroll_frame(Clay_RenderCommandArray *commands) {
+    if (!cr_runtime || !cr_runtime->paint_ready || !cr_runtime->scroll_ready || cr_runtime->is_rendering) {
+        return false;
+    }
+    // Drags and release momentum take full frames: Clay_UpdateScrollContainers
+    // drops containers not laid out since its last call
+    Clay_Vector2 remaining = cr_runtime->scroll_remaining;
+    if ((remaining.x == 0.0f && remaining.y == 0.0f) || cr_runtime->needs_render || cr_runtime->animating ||
+        cr_runtime->pointer_down || cr_runtime->scroll_coasting ||
+        atomic_load_explicit(&cr_runtime->post_pending, memory_order_acquire)) {
+        return false;
+    }
+    if (cr_runtime->timer_count > 0 && cr_now_ns() >= cr_runtime->timers[0]->deadline_ns) {
+        return false;
+    }
+
+    _cr_advance_clock();
+    float dt = cr_runtime->frame_delta > 0.0f ? cr_runtime->frame_delta : 1.0f / 60.0f;
+    _cr_glide_scroll(dt);
+
+    // Check every moved container before translating any, so a fallback
+    // leaves the cached frame as it was
+    for (size_t i = 0; i < cr_runtime->scroll_region_count; i++) {
+        CR_ScrollRegion *region = &cr_runtime->scroll_regions[i];
+        Clay_ScrollContainerData data = Clay_GetScrollContainerData((Clay_ElementId){ .id = region->element_id });
+        if (!data.found) continue;
+        Clay_Vector2 position = *$cast_nonnull(data.scrollPosition);
+        if (position.x == region->shown.x && position.y == region->shown.y) continue;
+        if (!_cr_scroll_region_covered(region, position)) {
+            cr_runtime->needs_render = true;
+            return false;
         }
-        return NULL;
     }
-    return child;
-}
 
-static void _cr_queue_effect(CR_Hook *hook, bool is_layout) {
-    if (!cr_runtime || !hook || !cr_runtime->current_component) return;
-    CR_Component *component = cr_runtime->current_component;
-    if (!component || !component->hooks) return;
+    // Nested containers sit inside their parent's range, so they ride along
+    for (size_t i = 0; i < cr_runtime->scroll_region_count; i++) {
+        CR_ScrollRegion *region = &cr_runtime->scroll_regions[i];
+        Clay_ScrollContainerData data = Clay_GetScrollContainerData((Clay_ElementId){ .id = region->element_id });
+        if (!data.found) continue;
+        Clay_Vector2 position = *$cast_nonnull(data.scrollPosition);
+        float dx = position.x - region->shown.x;
+        float dy = position.y - region->shown.y;
+        if (dx == 0.0f && dy == 0.0f) continue;
+        for (int32_t j = region->start + 1; j < region->end; j++) {
+            Clay_RenderCommand *command = Clay_RenderCommandArray_Get(&cr_runtime->paint_commands, j);
+            command->boundingBox.x += dx;
+            command->boundingBox.y += dy;
+        }
+        region->shown = position;
+        cr_runtime->scroll_translated = true;
+    }
 
-    size_t hook_index = (size_t)(hook - component->hooks);
-    CR_EffectRef ref = {
-        .component = component,
-        .hook_index = hook_index,
-        .component_id = component->id,
-    };
+    // The glide's last step hands over to a full frame so hit testing and
+    // hover catch up with what is on screen
+    if (!cr_runtime->scroll_gliding && cr_runtime->scroll_translated) {
+        cr_runtime->needs_render = true;
+    }
+    cr_runtime->scroll_frames++;
+    *commands = cr_runtime->paint_commands;
+    return true;
+}
 
-    CR_EffectRef **queue = is_layout ? &cr_runtime->pending_layout_effects : &cr_runtime->pending_effects;
-    size_t *count = is_layout ? &cr_runtime->pending_layout_effect_count : &cr_runtime->pending_effect_count;
-    size_t *capacity = is_layout ? &cr_runtime->pending_layout_effect_capacity : &cr_runtime->pending_effect_capacity;
-    if (!_cr_ensure_capacity((void **)queue, capacity, *count + 1, sizeof(CR_EffectRef))) {
-        return;
+// ============================================================================
+// EFFECT SCHEDULING
+// ============================================================================
+
+void cr_set_effect_deferral(bool deferred) {
+    if (!cr_runtime) {
+        cr_init();
     }
-    (*queue)[(*count)++] = ref;
+    if (!cr_runtime) return;
+    if (!deferred) {
+        cr_flush_effects();
+    }
+    cr_runtime->defer_effects = deferred;
 }
 
-static bool _cr_component_is_alive(CR_Component *component, uint64_t id) {
-    if (!cr_runtime || !component) return false;
-    for (size_t i = 0; i < cr_runtime->component_count; i++) {
-        if (cr_runtime->components[i] == component) {
-            return component->id == id;
-        }
+void cr_flush_effects(void) {
+    if (!cr_runtime || !cr_runtime->pending_effects) return;
+    _cr_flush_effect_queue($cast_nonnull(cr_runtime->pending_effects), &cr_runtime->pending_effect_count);
+}
+
+void cr_set_frame_budget(uint64_t budget_ns) {
+    if (!cr_runtime) {
+        cr_init();
     }
-    return false;
+    if (!cr_runtime) return;
+    cr_runtime->frame_budget_ns = budget_ns;
 }
 
-static void _cr_flush_effect_queue(CR_EffectRef *queue, size_t *count) {
-    if (!queue || !count) return;
-    for (size_t i = 0; i < *count; i++) {
-        CR_EffectRef *ref = &queue[i];
-        if (!_cr_component_is_alive(ref->component, ref->component_id)) {
-            continue;
-        }
-        CR_Component *component = ref->component;
-        if (!component || ref->hook_index >= component->hook_count) {
-            continue;
-        }
-        CR_Hook *hook = &component->hooks[ref->hook_index];
-        if (hook->type == CR_HOOK_EFFECT) {
+uint64_t cr_frame_budget_ns(void) {
+    return cr_runtime ? cr_runtime->frame_budget_ns : 0;
+}
+
+uint64_t cr_frame_headroom_ns(void) {
+    if (!cr_runtime || cr_runtime->frame_time_ns == 0) return 0;
+    uint64_t deadline = cr_runtime->frame_time_ns + cr_runtime->frame_budget_ns;
+    uint64_t now = cr_now_ns();
+    return now < deadline ? deadline - now : 0;
+}
+
+bool cr_has_idle_work(void) {
+    return cr_runtime && cr_runtime->pending_idle_effect_count > 0;
+}
+
+bool cr_run_idle_effects(uint64_t budget_ns) {
+    if (!cr_runtime || !cr_runtime->pending_idle_effects) return false;
+
+    CR_EffectRef *queue = $cast_nonnull(cr_runtime->pending_idle_effects);
+    size_t count = cr_runtime->pending_idle_effect_count;
+    uint64_t start = cr_now_ns();
+    size_t done = 0;
+    while (done < count && cr_now_ns() - start < budget_ns) {
+        CR_Hook *hook = _cr_effect_ref_hook(&queue[done++]);
+        if (hook) {
+            hook->effect.queued = false;
             _cr_run_effect(&hook->effect.effect);
         }
     }
-    *count = 0;
-}
 
-static void _cr_collect_garbage(void) {
-    if (!cr_runtime) return;
-    for (size_t i = 0; i < cr_runtime->component_count; ) {
-        CR_Component *component = cr_runtime->components[i];
-        if (component->last_render_frame != cr_runtime->frame) {
-            _cr_destroy_component(component);
-            continue;
-        }
-        i++;
+    // Whatever did not fit waits for the next idle slot, in order
+    size_t remaining = count - done;
+    if (done > 0 && remaining > 0) {
+        memmove(queue, queue + done, remaining * sizeof(CR_EffectRef));
     }
+    cr_runtime->pending_idle_effect_count = remaining;
+    return remaining > 0;
 }
 
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
 
+static CR_Runtime * $nullable _cr_runtime_alloc(void) {
+    CR_Runtime *runtime = calloc(1, sizeof(CR_Runtime));
+    if (!runtime) {
+        fprintf(stderr, "Clay React: Failed to allocate runtime\n");
+        return NULL;
+    }
+
+    runtime->frame_budget_ns = 16666666ull;
+    runtime->needs_render = true;
+    runtime->next_uid = 1;
+    runtime->next_component_id = 1;
+    _cr_post_queue_init(runtime);
+    return runtime;
+}
+
 void cr_init(void) {
     if (cr_runtime != NULL) {
         return; // Already initialized
     }
 
-    cr_runtime = calloc(1, sizeof(CR_Runtime));
-    if (!cr_runtime) {
-        fprintf(stderr, "Clay React: Failed to allocate runtime\n");
-        return;
-    }
+    // Runs on whatever Clay context the caller set up; the context is picked
+    // up the first time another runtime is made current
+    cr_runtime = _cr_runtime_alloc();
+}
 
-    cr_runtime->current_component = NULL;
-    cr_runtime->root = NULL;
-    cr_runtime->context_stack = NULL;
-    cr_runtime->is_rendering = false;
-    cr_runtime->frame = 0;
-    cr_runtime->click_handlers = NULL;
-    cr_runtime->click_handler_count = 0;
-    cr_runtime->click_handler_capacity = 0;
-    cr_runtime->temp_strings = NULL;
-    cr_runtime->temp_string_count = 0;
-    cr_runtime->temp_string_capacity = 0;
-    cr_runtime->components = NULL;
-    cr_runtime->component_count = 0;
-    cr_runtime->component_capacity = 0;
-    cr_runtime->component_stack = NULL;
-    cr_runtime->component_stack_count = 0;
-    cr_runtime->component_stack_capacity = 0;
-    cr_runtime->pending_effects = NULL;
-    cr_runtime->pending_effect_count = 0;
-    cr_runtime->pending_effect_capacity = 0;
-    cr_runtime->pending_layout_effects = NULL;
-    cr_runtime->pending_layout_effect_count = 0;
-    cr_runtime->pending_layout_effect_capacity = 0;
-    cr_runtime->needs_render = true;
-    cr_runtime->next_uid = 1;
-    cr_runtime->has_next_key = false;
+CR_Runtime * $nullable cr_runtime_create(Clay_Dimensions dimensions, Clay_ErrorHandler error_handler) {
+    CR_Runtime *runtime = _cr_runtime_alloc();
+    if (!runtime) return NULL;
+
+    uint64_t memory_size = Clay_MinMemorySize();
+    Clay_Arena arena = {
+        .memory = calloc(1, memory_size),
+        .capacity = memory_size,
+    };
+    if (!arena.memory) {
+        fprintf(stderr, "Clay React: Failed to allocate Clay arena\n");
+        free(runtime);
+        return NULL;
+    }
+    runtime->clay_memory = arena.memory;
+
+    // Clay_Initialize switches to the new context; the caller's stays current
+    Clay_Context *previous = Clay_GetCurrentContext();
+    runtime->clay_context = Clay_Initialize(arena, dimensions, error_handler);
+    runtime->owns_clay_context = true;
+    Clay_SetCurrentContext(previous);
+
+    // Measure function pointers are global in Clay; give the new context the
+    // current runtime's user data
+    if (cr_runtime && cr_runtime->measure_text) {
+        runtime->measure_text = cr_runtime->measure_text;
+        runtime->measure_text_user_data = cr_runtime->measure_text_user_data;
+        Clay_SetCurrentContext(runtime->clay_context);
+        Clay_SetMeasureTextFunction(runtime->measure_text, runtime->measure_text_user_data);
+        Clay_SetCurrentContext(previous);
+    }
+    return runtime;
 }
 
-void cr_shutdown(void) {
-    if (!cr_runtime) {
-        return;
+CR_Runtime * $nullable cr_runtime_make_current(CR_Runtime * $nullable runtime) {
+    CR_Runtime *previous = cr_runtime;
+
+    // Clay's current context is process-wide, so making the same runtime
+    // current again still restores it after another thread's frame
+    if (previous == runtime) {
+        if (runtime && runtime->clay_context) {
+            Clay_SetCurrentContext($cast_nonnull(runtime->clay_context));
+        }
+        return previous;
     }
 
+    // A cr_init runtime adopts the Clay context that was current for it
+    if (previous && !previous->clay_context) {
+        previous->clay_context = Clay_GetCurrentContext();
+    }
+    cr_runtime = runtime;
+    if (runtime && runtime->clay_context) {
+        Clay_SetCurrentContext($cast_nonnull(runtime->clay_context));
+    }
+    return previous;
+}
+
+CR_Runtime * $nullable cr_runtime_current(void) {
+    return cr_runtime;
+}
+
+void cr_runtime_destroy(CR_Runtime * $nullable runtime) {
+    if (!runtime) return;
+
+    // Teardown runs hooks' cleanups, which expect their own runtime current
+    CR_Runtime *previous = cr_runtime_make_current(runtime);
+
+    // Release posted blocks that never got a frame
+    _cr_drain_posts(false);
+
     // Free click handlers
     _cr_clear_handlers();
     if (cr_runtime->click_handlers) {
         free(cr_runtime->click_handlers);
     }
-
-    // Free temp strings
-    _cr_clear_temp_strings();
-    if (cr_runtime->temp_strings) {
-        free(cr_runtime->temp_strings);
+    if (cr_runtime->listeners) {
+        free(cr_runtime->listeners);
+    }
+    if (cr_runtime->event_path) {
+        free(cr_runtime->event_path);
+    }
+    if (cr_runtime->element_stack) {
+        free(cr_runtime->element_stack);
     }
+    for (size_t i = 0; i < sizeof(cr_runtime->top_listeners) / sizeof(cr_runtime->top_listeners[0]); i++) {
+        if (cr_runtime->top_listeners[i].indices) {
+            free(cr_runtime->top_listeners[i].indices);
+        }
+    }
+    _cr_id_map_free(&cr_runtime->listener_map);
+    _cr_id_map_free(&cr_runtime->element_parents);
+    _cr_id_map_free(&cr_runtime->hover_ids);
+    _cr_id_map_free(&cr_runtime->hover_prev);
+    _cr_free_paint();
+    _cr_free_scroll();
+
+    // Free frame text, memoized formats, paragraph lines and any pending
+    // snapshot
+    _cr_free_text_arena();
+    _cr_free_text_memos();
+    _cr_free_paragraphs();
+    _cr_snapshot_discard();
 
     // Free context stack
     while (cr_runtime->context_stack) {
@@ -525,10 +2706,14 @@ void cr_shutdown(void) {
     if (cr_runtime->root) {
         _cr_destroy_component($cast_nonnull(cr_runtime->root));
     }
+    _cr_free_graveyard();
 
     if (cr_runtime->components) {
         free(cr_runtime->components);
     }
+    if (cr_runtime->graveyard) {
+        free(cr_runtime->graveyard);
+    }
     if (cr_runtime->component_stack) {
         free(cr_runtime->component_stack);
     }
@@ -538,9 +2723,33 @@ void cr_shutdown(void) {
     if (cr_runtime->pending_layout_effects) {
         free(cr_runtime->pending_layout_effects);
     }
+    if (cr_runtime->pending_idle_effects) {
+        free(cr_runtime->pending_idle_effects);
+    }
+    if (cr_runtime->timers) {
+        free(cr_runtime->timers);
+    }
+    if (cr_runtime->keep_alive_boundaries) {
+        free(cr_runtime->keep_alive_boundaries);
+    }
+    _cr_free_interned();
+
+    if (cr_runtime->owns_clay_context) {
+        if (Clay_GetCurrentContext() == cr_runtime->clay_context) {
+            Clay_SetCurrentContext(NULL);
+        }
+        free(cr_runtime->clay_memory);
+    }
 
     free(cr_runtime);
     cr_runtime = NULL;
+    if (previous != runtime) {
+        cr_runtime_make_current(previous);
+    }
+}
+
+void cr_shutdown(void) {
+    cr_runtime_destroy(cr_runtime);
 }
 
 void cr_begin_frame(void) {
@@ -548,7 +2757,21 @@ void cr_begin_frame(void) {
         cr_init();
     }
 
-    _cr_clear_temp_strings();
+    // Apply cross-thread updates first so this frame renders them
+    _cr_drain_posts(true);
+
+    // Deferred passive effects the backend never flushed still run before
+    // the next render so they observe the state they were queued for
+    cr_flush_effects();
+    _cr_free_graveyard();
+
+    _cr_reset_text_arena();
+    if ((cr_runtime->frame & 127) == 0) {
+        _cr_sweep_text_memos();
+        _cr_sweep_paragraphs();
+    }
+    _cr_advance_clock();
+    _cr_fire_timers();
 
     cr_runtime->is_rendering = true;
     cr_runtime->frame++;
@@ -557,21 +2780,41 @@ void cr_begin_frame(void) {
     cr_runtime->component_stack_count = 0;
     cr_runtime->has_next_key = false;
 
-    // Clear handlers from previous frame
+    // Hover events go to the handlers the previous frame registered
+    _cr_update_hover();
+    _cr_step_scroll();
+
+    // A glide still under way will translate this frame, so keep the rows
+    // its next steps bring into view
+    Clay_Vector2 remaining = cr_runtime->scroll_remaining;
+    cr_runtime->scroll_overscan = remaining.x != 0.0f || remaining.y != 0.0f;
+    Clay_SetCullingEnabled(!cr_runtime->scroll_overscan);
+
+    // Clear handlers and paint bindings from previous frame
     _cr_clear_handlers();
+    _cr_paint_reset();
+    _cr_scroll_reset();
 
     Clay_BeginLayout();
 }
 
 Clay_RenderCommandArray cr_end_frame(void) {
     Clay_RenderCommandArray commands = Clay_EndLayout();
+    if (cr_runtime->scroll_overscan) {
+        _cr_scroll_cull(&commands);
+    }
     if (cr_runtime->pending_layout_effects) {
         _cr_flush_effect_queue($cast_nonnull(cr_runtime->pending_layout_effects), &cr_runtime->pending_layout_effect_count);
     }
-    if (cr_runtime->pending_effects) {
-        _cr_flush_effect_queue($cast_nonnull(cr_runtime->pending_effects), &cr_runtime->pending_effect_count);
+    if (!cr_runtime->defer_effects) {
+        cr_flush_effects();
     }
     _cr_collect_garbage();
+    if (cr_runtime->snapshot_data && cr_runtime->frame >= cr_runtime->snapshot_expires) {
+        _cr_snapshot_discard();
+    }
+    _cr_paint_capture(commands);
+    _cr_scroll_capture(commands);
     cr_runtime->is_rendering = false;
     return commands;
 }
@@ -580,7 +2823,23 @@ bool cr_should_render(void) {
     if (!cr_runtime) {
         return true;
     }
-    return cr_runtime->needs_render;
+    if (cr_runtime->needs_render ||
+        atomic_load_explicit(&cr_runtime->post_pending, memory_order_acquire)) {
+        return true;
+    }
+    // A moving pointer only needs a frame if someone listens for hover
+    if (cr_runtime->pointer_moved && cr_runtime->hover_listener_count > 0) {
+        return true;
+    }
+    if (cr_runtime->hover_dirty) {
+        return true;
+    }
+    // Releasing a drag coasts until the momentum decays
+    if (cr_runtime->scroll_coasting) {
+        return true;
+    }
+    uint64_t deadline = _cr_next_deadline_ns();
+    return deadline != 0 && cr_now_ns() >= deadline;
 }
 
 void cr_request_render(void) {
@@ -600,6 +2859,15 @@ void _cr_schedule_render(void) {
     }
 }
 
+// A state set from another runtime's handler still re-renders its own tree
+void _cr_schedule_state_render(CR_StateInternal *state) {
+    if (state->runtime) {
+        state->runtime->needs_render = true;
+    } else {
+        _cr_schedule_render();
+    }
+}
+
 uint32_t _cr_next_uid(void) {
     if (!cr_runtime) {
         cr_init();
@@ -711,7 +2979,7 @@ void _cr_deps_store(CR_Hook *$nullable hook, CR_DepList deps) {
     hook->deps_initialized = true;
 }
 
-void _cr_use_effect_impl(EffectBlock $nullable effect, CR_DepList deps, bool is_layout) {
+void _cr_use_effect_impl(EffectBlock $nullable effect, CR_DepList deps, CR_EffectKind kind) {
     if (!effect) return;
     CR_Hook *hook = _cr_use_hook(CR_HOOK_EFFECT);
     if (!hook) return;
@@ -725,9 +2993,9 @@ void _cr_use_effect_impl(EffectBlock $nullable effect, CR_DepList deps, bool is_
         Block_release(hook->effect.effect.effect);
     }
     hook->effect.effect.effect = Block_copy(effect);
-    hook->effect.is_layout = is_layout;
+    hook->effect.kind = kind;
     _cr_deps_store(hook, deps);
-    _cr_queue_effect(hook, is_layout);
+    _cr_queue_effect(hook, kind);
 }
 
 void cr_key(CR_Id key) {
@@ -754,8 +3022,9 @@ void _cr_component_begin(const char *name, const void * $nullable props, size_t
         has_key = false;
     }
 
+    size_t index = 0;
     if (parent) {
-        size_t index = parent->child_cursor;
+        index = parent->child_cursor;
         if (has_key) {
             component = _cr_find_child_by_key(parent, key, name, index);
             if (!component) {
@@ -763,10 +3032,17 @@ void _cr_component_begin(const char *name, const void * $nullable props, size_t
                 _cr_component_add_child(parent, component, index);
             }
         } else {
-            component = _cr_get_child_by_index(parent, name, index);
+            bool replace = false;
+            component = _cr_get_child_by_index(parent, name, index, &replace);
             if (!component) {
                 component = _cr_create_component(name, parent, false, (CR_Id){0});
-                _cr_component_add_child(parent, component, index);
+                if (!replace) {
+                    _cr_component_add_child(parent, component, index);
+                } else if (component) {
+                    parent->children[index] = $cast_nonnull(component);
+                } else {
+                    _cr_component_remove_child(parent, parent->children[index]);
+                }
             }
         }
         parent->child_cursor++;
@@ -783,6 +3059,9 @@ void _cr_component_begin(const char *name, const void * $nullable props, size_t
     }
 
     if (!component) return;
+    if (component->path_hash == 0) {
+        component->path_hash = _cr_component_path(parent, name, has_key ? &component->key : NULL, index);
+    }
 
     component->last_render_frame = cr_runtime->frame;
     component->hook_cursor = 0;
@@ -818,6 +3097,9 @@ void _cr_component_end(void) {
         }
         return;
     }
+    if (cr_runtime->current_component) {
+        _cr_drop_unvisited_children($cast_nonnull(cr_runtime->current_component));
+    }
     cr_runtime->current_component =
         cr_runtime->component_stack[--cr_runtime->component_stack_count];
 }
@@ -834,6 +3116,10 @@ void * $nullable _cr_current_props(void) {
 // ============================================================================
 
 CR_StateInternal * $nullable _cr_alloc_state(size_t size, void *initial) {
+    return _cr_alloc_typed_state(size, initial, (struct Type){0});
+}
+
+CR_StateInternal * $nullable _cr_alloc_typed_state(size_t size, void *initial, struct Type type) {
     CR_StateInternal *state = _cr_alloc(sizeof(CR_StateInternal));
     if (!state) return NULL;
 
@@ -847,6 +3133,13 @@ CR_StateInternal * $nullable _cr_alloc_state(size_t size, void *initial) {
     memcpy(state->value, initial, size);
     state->size = size;
     state->version = 0;
+    state->type = type;
+    state->runtime = cr_runtime;
+
+    CR_Component *component = cr_runtime ? cr_runtime->current_component : NULL;
+    if (component && cr_runtime->snapshot_entry_count > 0 && component->hook_cursor > 0) {
+        _cr_snapshot_apply(state, $cast_nonnull(component), (uint32_t)(component->hook_cursor - 1));
+    }
 
     return state;
 }
@@ -892,89 +3185,785 @@ void _cr_run_effect(CR_EffectInternal *effect) {
     }
 }
 
+// ============================================================================
+// TIMER IMPLEMENTATION
+// ============================================================================
+
+void _cr_use_timer(VoidBlock $nullable callback, int64_t ms, bool repeat) {
+    CR_Hook *hook = _cr_use_hook(CR_HOOK_TIMER);
+    if (!hook) return;
+
+    CR_TimerInternal *timer = hook->timer.timer;
+    bool restart = false;
+    if (!timer) {
+        timer = _cr_alloc(sizeof(CR_TimerInternal));
+        if (!timer) return;
+        timer->heap_index = CR_TIMER_UNSCHEDULED;
+        hook->timer.timer = timer;
+        restart = true;
+    } else if (hook->timer.ms != ms) {
+        restart = true;
+    }
+    hook->timer.ms = ms;
+
+    // Always keep the latest callback so it sees current state
+    if (timer->callback) {
+        Block_release(timer->callback);
+    }
+    timer->callback = callback ? Block_copy(callback) : NULL;
+
+    if (!restart) return;
+
+    if (ms < 0) {
+        _cr_timer_unschedule(timer);
+        return;
+    }
+    uint64_t delay_ns = (uint64_t)ms * 1000000ull;
+    timer->interval_ns = repeat ? (delay_ns > 0 ? delay_ns : 1000000ull) : 0;
+    _cr_timer_schedule(timer, cr_runtime->frame_time_ns + delay_ns);
+}
+
+// ============================================================================
+// ANIMATION IMPLEMENTATION
+// ============================================================================
+
+static $always_inline float _cr_absf(float x) {
+    return x < 0.0f ? -x : x;
+}
+
+// Ask for the next frame as soon as the backend can present it
+static void _cr_request_animation_frame(void) {
+    cr_runtime->animating = true;
+    cr_request_frame_at(cr_runtime->frame_time_ns);
+}
+
+float _cr_use_animation(float target, CR_AnimationParams params) {
+    CR_Hook *hook = _cr_use_hook(CR_HOOK_ANIMATION);
+    if (!hook) return target;
+
+    if (!hook->anim.initialized) {
+        hook->anim.from = target;
+        hook->anim.to = target;
+        hook->anim.value = target;
+        hook->anim.initialized = true;
+        return target;
+    }
+
+    uint64_t now = cr_runtime->frame_time_ns;
+    if (target != hook->anim.to) {
+        // Retarget from wherever we are now so interruptions stay continuous
+        hook->anim.from = hook->anim.value;
+        hook->anim.to = target;
+        hook->anim.start_ns = now;
+        hook->anim.active = true;
+    }
+
+    if (!hook->anim.active) {
+        return hook->anim.value;
+    }
+
+    float duration = params.duration > 0.0f ? params.duration : 0.2f;
+    float t = (float)((double)(now - hook->anim.start_ns) / 1e9) / duration;
+    if (t >= 1.0f) {
+        hook->anim.value = hook->anim.to;
+        hook->anim.active = false;
+        return hook->anim.value;
+    }
+
+    CR_EasingFn easing = params.easing ? $cast_nonnull(params.easing) : cr_ease_out_cubic;
+    hook->anim.value = lerp(hook->anim.from, hook->anim.to, easing(t));
+    _cr_request_animation_frame();
+    return hook->anim.value;
+}
+
+float _cr_use_spring(float target, CR_SpringParams params) {
+    CR_Hook *hook = _cr_use_hook(CR_HOOK_ANIMATION);
+    if (!hook) return target;
+
+    if (!hook->anim.initialized) {
+        hook->anim.to = target;
+        hook->anim.value = target;
+        hook->anim.velocity = 0.0f;
+        hook->anim.initialized = true;
+        return target;
+    }
+
+    if (!hook->anim.active) {
+        if (target == hook->anim.to) {
+            return hook->anim.value;
+        }
+        // Start integrating next frame; this frame's delta may span an idle gap
+        hook->anim.to = target;
+        hook->anim.active = true;
+        _cr_request_animation_frame();
+        return hook->anim.value;
+    }
+    hook->anim.to = target;
+
+    float stiffness = params.stiffness > 0.0f ? params.stiffness : 170.0f;
+    float damping = params.damping > 0.0f ? params.damping : 26.0f;
+    float mass = params.mass > 0.0f ? params.mass : 1.0f;
+    float precision = params.precision > 0.0f ? params.precision : 0.01f;
+
+    // Semi-implicit Euler in fixed substeps keeps stiff springs stable at low frame rates
+    float remaining = cr_runtime->frame_delta;
+    const float max_step = 1.0f / 120.0f;
+    while (remaining > 0.0f) {
+        float h = remaining > max_step ? max_step : remaining;
+        float displacement = hook->anim.value - hook->anim.to;
+        float acceleration = (-stiffness * displacement - damping * hook->anim.velocity) / mass;
+        hook->anim.velocity += acceleration * h;
+        hook->anim.value += hook->anim.velocity * h;
+        remaining -= h;
+    }
+
+    if (_cr_absf(hook->anim.velocity) < precision &&
+        _cr_absf(hook->anim.value - hook->anim.to) < precision) {
+        hook->anim.value = hook->anim.to;
+        hook->anim.velocity = 0.0f;
+        hook->anim.active = false;
+        return hook->anim.value;
+    }
+
+    _cr_request_animation_frame();
+    return hook->anim.value;
+}
+
 // ============================================================================
 // SIGNAL IMPLEMENTATION
 // ============================================================================
 
-CR_SignalInternal * $nullable _cr_alloc_signal(size_t size, void *initial, struct Type type) {
-    CR_SignalInternal *signal = _cr_alloc(sizeof(CR_SignalInternal));
-    if (!signal) return NULL;
+CR_SignalInternal * $nullable _cr_alloc_signal(size_t size, void *initial, struct Type type) {
+    CR_SignalInternal *signal = _cr_alloc(sizeof(CR_SignalInternal));
+    if (!signal) return NULL;
+
+    void *value = _cr_alloc(size);
+    if (!value) {
+        _cr_free(signal, sizeof(CR_SignalInternal));
+        return NULL;
+    }
+    signal->value = (void * $nonnull)value;
+
+    memcpy(signal->value, initial, size);
+    signal->size = size;
+    signal->type = type;
+    signal->version = 0;
+    signal->subscribers = NULL;
+    signal->subscriber_count = 0;
+
+    return signal;
+}
+
+void _cr_signal_notify(CR_SignalInternal * $nullable signal) {
+    if (!signal) return;
+
+    for (size_t i = 0; i < signal->subscriber_count; i++) {
+        if (signal->subscribers[i].handler) {
+            signal->subscribers[i].handler(signal->value);
+        }
+    }
+}
+
+bool _cr_signal_set_if_changed(CR_SignalInternal * $nullable signal, void * $nullable value) {
+    if (!signal || !value) return false;
+    if (memcmp(signal->value, value, signal->size) == 0) {
+        return false;
+    }
+    memcpy(signal->value, value, signal->size);
+    signal->version++;
+    _cr_signal_notify(signal);
+    return true;
+}
+
+// ============================================================================
+// EVENT HANDLING
+// ============================================================================
+
+// Listeners on top-level elements are also listed per event type, for key
+// events with no tracked target. Hooks may register before or after their
+// element opens, so both sides note them; the list stays in registration
+// order.
+static void _cr_note_top_listener(uint32_t index) {
+    CR_EventType type = cr_runtime->listeners[index - 1].type;
+    typeof(cr_runtime->top_listeners[0]) *list = &cr_runtime->top_listeners[type];
+    if (!_cr_ensure_capacity((void **)&list->indices, &list->capacity, list->count + 1, sizeof(uint32_t))) {
+        return;
+    }
+    uint32_t *indices = $cast_nonnull(list->indices);
+    size_t slot = list->count++;
+    for (; slot > 0 && indices[slot - 1] > index; slot--) {
+        indices[slot] = indices[slot - 1];
+    }
+    indices[slot] = index;
+}
+
+// Listeners live for one frame. Each element keeps a chain in registration
+// order, found through listener_map.
+static bool _cr_push_listener(uint32_t element_id, CR_EventType type, CR_ListenerKind kind,
+                              bool capture, bool owns_block, void * $nullable block) {
+    if (!cr_runtime || element_id == 0 || !block) return false;
+    if (!_cr_ensure_capacity((void **)&cr_runtime->listeners,
+                             &cr_runtime->listener_capacity,
+                             cr_runtime->listener_count + 1,
+                             sizeof(CR_Listener))) {
+        return false;
+    }
+
+    uint32_t index = (uint32_t)cr_runtime->listener_count + 1;
+    uint32_t head = 0;
+    if (_cr_id_map_get(&cr_runtime->listener_map, element_id, &head)) {
+        uint32_t tail = head;
+        while (cr_runtime->listeners[tail - 1].next_on_element) {
+            tail = cr_runtime->listeners[tail - 1].next_on_element;
+        }
+        cr_runtime->listeners[tail - 1].next_on_element = index;
+    } else if (!_cr_id_map_put(&cr_runtime->listener_map, element_id, index)) {
+        return false;
+    }
+
+    cr_runtime->listeners[index - 1] = (CR_Listener){
+        .element_id = element_id,
+        .type = type,
+        .kind = kind,
+        .capture = capture,
+        .owns_block = owns_block,
+        .block = block,
+    };
+    cr_runtime->listener_count++;
+    if (type == CR_EVENT_HOVER) {
+        cr_runtime->hover_listener_count++;
+    }
+    uint32_t parent = 0;
+    if (_cr_id_map_get(&cr_runtime->element_parents, element_id, &parent) && parent == 0) {
+        _cr_note_top_listener(index);
+    }
+    return true;
+}
+
+// Typed listeners handle the event outright, except key listeners, which say
+// so through handled; OnEventBlock listeners choose whether it keeps travelling
+static void _cr_invoke_listener(const CR_Listener *listener, CR_Event *event) {
+    void *block = listener->block;
+    if (!block) return;
+
+    event->current = listener->element_id;
+    switch (listener->kind) {
+        case CR_LISTENER_EVENT:
+            ((OnEventBlock)block)(event);
+            return;
+        case CR_LISTENER_CLICK:
+            ((VoidBlock)block)();
+            break;
+        case CR_LISTENER_HOVER:
+            ((OnHoverBlock)block)(&event->hover);
+            break;
+        case CR_LISTENER_SCROLL:
+            ((OnScrollBlock)block)(&event->scroll);
+            break;
+        case CR_LISTENER_KEY:
+            ((OnKeyBlock)block)(&event->key);
+            if (!event->key.handled) return;
+            break;
+    }
+    event->propagation_stopped = true;
+}
+
+static void _cr_run_element_listeners(uint32_t element_id, CR_Event *event, bool capture, CR_EventPhase phase) {
+    uint32_t index = 0;
+    if (!_cr_id_map_get(&cr_runtime->listener_map, element_id, &index)) return;
+
+    for (; index && !event->propagation_stopped; index = cr_runtime->listeners[index - 1].next_on_element) {
+        const CR_Listener *listener = &cr_runtime->listeners[index - 1];
+        if (listener->type != event->type || listener->capture != capture) continue;
+        event->phase = phase;
+        _cr_invoke_listener(listener, event);
+    }
+}
+
+// Pointer events follow Clay's pointer-over ids, which list the elements
+// under the pointer from the root down
+static bool _cr_dispatch_pointer(CR_Event *event) {
+    Clay_ElementIdArray over = Clay_GetPointerOverIds();
+    if (over.length == 0 || cr_runtime->listener_count == 0) return false;
+
+    int32_t last = over.length - 1;
+    event->target = over.internalArray[last].id;
+    for (int32_t i = 0; i <= last && !event->propagation_stopped; i++) {
+        _cr_run_element_listeners(over.internalArray[i].id, event, true,
+                                  i == last ? CR_PHASE_TARGET : CR_PHASE_CAPTURE);
+    }
+    for (int32_t i = last; i >= 0 && !event->propagation_stopped; i--) {
+        _cr_run_element_listeners(over.internalArray[i].id, event, false,
+                                  i == last ? CR_PHASE_TARGET : CR_PHASE_BUBBLE);
+    }
+    return event->propagation_stopped;
+}
+
+// Listeners on elements components opened at the top level, for keys with
+// no tracked target
+static void _cr_run_top_listeners(CR_Event *event, bool capture) {
+    typeof(cr_runtime->top_listeners[0]) *list = &cr_runtime->top_listeners[event->type];
+    for (size_t i = 0; i < list->count && !event->propagation_stopped; i++) {
+        const CR_Listener *listener = &cr_runtime->listeners[$cast_nonnull(list->indices)[i] - 1];
+        if (listener->capture != capture) continue;
+        event->phase = listener->element_id == event->target ? CR_PHASE_TARGET :
+            capture ? CR_PHASE_CAPTURE : CR_PHASE_BUBBLE;
+        _cr_invoke_listener(listener, event);
+    }
+}
+
+// Key events follow the element parents the last render recorded, from the
+// focused element up. A target no component opened only adds itself under
+// the top-level elements.
+bool cr_dispatch_key(KeyEvent key) {
+    if (!cr_runtime || cr_runtime->listener_count == 0) return false;
+
+    CR_Event event = { .type = CR_EVENT_KEY, .target = cr_runtime->focused_element, .key = key };
+
+    // path[0] is the target; the bound keeps a duplicated id from looping
+    size_t limit = cr_runtime->element_parents.count + 1;
+    if (!_cr_ensure_capacity((void **)&cr_runtime->event_path,
+                             &cr_runtime->event_path_capacity,
+                             limit, sizeof(uint32_t))) {
+        return false;
+    }
+    uint32_t *path = $cast_nonnull(cr_runtime->event_path);
+    size_t depth = 0;
+    bool tracked = false;
+    if (event.target) {
+        uint32_t element = event.target;
+        path[depth++] = element;
+        uint32_t parent = 0;
+        tracked = _cr_id_map_get(&cr_runtime->element_parents, element, &parent);
+        while (parent && depth < limit) {
+            path[depth++] = parent;
+            if (!_cr_id_map_get(&cr_runtime->element_parents, parent, &parent)) break;
+        }
+    }
+
+    if (!tracked) {
+        _cr_run_top_listeners(&event, true);
+    }
+    for (size_t i = depth; i > 0 && !event.propagation_stopped; i--) {
+        _cr_run_element_listeners(path[i - 1], &event, true, i == 1 ? CR_PHASE_TARGET : CR_PHASE_CAPTURE);
+    }
+    for (size_t i = 0; i < depth && !event.propagation_stopped; i++) {
+        _cr_run_element_listeners(path[i], &event, false, i == 0 ? CR_PHASE_TARGET : CR_PHASE_BUBBLE);
+    }
+    if (!tracked) {
+        _cr_run_top_listeners(&event, false);
+    }
+    return event.propagation_stopped;
+}
+
+void cr_set_focus(Clay_ElementId element_id) {
+    if (!cr_runtime) return;
+    if (cr_runtime->focused_input && cr_runtime->focused_input->element_id != element_id.id) {
+        _cr_unfocus_input();
+    }
+    cr_runtime->focused_element = element_id.id;
+}
+
+uint32_t cr_focused_element(void) {
+    return cr_runtime ? cr_runtime->focused_element : 0;
+}
+
+void _cr_register_click(uint32_t element_id, VoidBlock $nullable handler) {
+    if (!cr_runtime || !handler) return;
+
+    // Grow array if needed
+    if (cr_runtime->click_handler_count >= cr_runtime->click_handler_capacity) {
+        size_t new_cap = cr_runtime->click_handler_capacity == 0 ? 32 : cr_runtime->click_handler_capacity * 2;
+        void *new_handlers = realloc(cr_runtime->click_handlers,
+            new_cap * sizeof(cr_runtime->click_handlers[0]));
+        if (!new_handlers) return;
+        cr_runtime->click_handlers = new_handlers;
+        cr_runtime->click_handler_capacity = new_cap;
+    }
+
+    cr_runtime->click_handlers[cr_runtime->click_handler_count++] = (typeof(cr_runtime->click_handlers[0])){
+        .element_id = element_id,
+        .handler = handler,
+    };
+    _cr_push_listener(element_id, CR_EVENT_CLICK, CR_LISTENER_CLICK, false, false, (void *)handler);
+}
+
+void _cr_register_hover(uint32_t element_id, OnHoverBlock $nullable handler) {
+    if (handler && !_cr_push_listener(element_id, CR_EVENT_HOVER, CR_LISTENER_HOVER, false, true, (void *)handler)) {
+        Block_release(handler);
+    }
+}
+
+void _cr_register_scroll(uint32_t element_id, OnScrollBlock $nullable handler) {
+    if (handler && !_cr_push_listener(element_id, CR_EVENT_SCROLL, CR_LISTENER_SCROLL, false, true, (void *)handler)) {
+        Block_release(handler);
+    }
+}
+
+void _cr_register_key(uint32_t element_id, OnKeyBlock $nullable handler) {
+    if (handler && !_cr_push_listener(element_id, CR_EVENT_KEY, CR_LISTENER_KEY, false, true, (void *)handler)) {
+        Block_release(handler);
+    }
+}
+
+void _cr_add_listener(uint32_t element_id, CR_EventType type, bool capture, OnEventBlock $nullable handler) {
+    if (handler && !_cr_push_listener(element_id, type, CR_LISTENER_EVENT, capture, true, (void *)handler)) {
+        Block_release(handler);
+    }
+}
+
+// Components bracket the elements they open so key routing knows each one's
+// parent. Anonymous elements repeat the enclosing id and stay transparent.
+void _cr_element_open(uint32_t element_id) {
+    if (!cr_runtime || !cr_runtime->is_rendering) return;
+    size_t count = cr_runtime->element_stack_count;
+    uint32_t parent = count ? $cast_nonnull(cr_runtime->element_stack)[count - 1] : 0;
+    if (element_id) {
+        uint32_t previous = 0;
+        bool seen = _cr_id_map_get(&cr_runtime->element_parents, element_id, &previous);
+        _cr_id_map_put(&cr_runtime->element_parents, element_id, parent);
+        // Listeners registered before the element opened
+        uint32_t index = 0;
+        if (!seen && parent == 0 && _cr_id_map_get(&cr_runtime->listener_map, element_id, &index)) {
+            for (; index; index = cr_runtime->listeners[index - 1].next_on_element) {
+                _cr_note_top_listener(index);
+            }
+        }
+    }
+    if (!_cr_ensure_capacity((void **)&cr_runtime->element_stack,
+                             &cr_runtime->element_stack_capacity,
+                             count + 1, sizeof(uint32_t))) {
+        return;
+    }
+    $cast_nonnull(cr_runtime->element_stack)[count] = element_id ? element_id : parent;
+    cr_runtime->element_stack_count = count + 1;
+}
+
+void _cr_element_close(void) {
+    if (!cr_runtime || !cr_runtime->is_rendering || cr_runtime->element_stack_count == 0) return;
+    cr_runtime->element_stack_count--;
+}
+
+// Wheel glide bounds (seconds) and the distance below which it snaps home
+#define CR_SCROLL_MIN_GLIDE (1.0f / 60.0f)
+#define CR_SCROLL_MAX_GLIDE 0.12f
+#define CR_SCROLL_SNAP 0.5f
+// Clay_UpdateScrollContainers moves 10 px per unit of wheel delta, and the
+// backends' deltas are tuned for it
+#define CR_SCROLL_WHEEL_SCALE 10.0f
+// Release momentum decay rate (1/s), close to Clay's 0.95 per frame at
+// 60 Hz, and the speed (px/s) at which coasting stops
+#define CR_SCROLL_FRICTION 3.0f
+#define CR_SCROLL_COAST_MIN 20.0f
+
+// Moves a container to target, clamped to its range along the axes it
+// scrolls. Returns false once the container is gone.
+static bool _cr_scroll_move_to(uint32_t element_id, Clay_Vector2 target, Clay_Vector2 *moved) {
+    Clay_ScrollContainerData data = Clay_GetScrollContainerData((Clay_ElementId){ .id = element_id });
+    if (!data.found) return false;
+    Clay_Vector2 *position = $cast_nonnull(data.scrollPosition);
+    float max_x = data.contentDimensions.width - data.scrollContainerDimensions.width;
+    float max_y = data.contentDimensions.height - data.scrollContainerDimensions.height;
+    if (data.config.horizontal && max_x > 0.0f) {
+        position->x = target.x > 0.0f ? 0.0f : target.x < -max_x ? -max_x : target.x;
+    }
+    if (data.config.vertical && max_y > 0.0f) {
+        position->y = target.y > 0.0f ? 0.0f : target.y < -max_y ? -max_y : target.y;
+    }
+    *moved = *position;
+    return true;
+}
+
+// The innermost container under the pointer with room to scroll
+static uint32_t _cr_scroll_grab(Clay_Vector2 pointer) {
+    Clay_ElementIdArray over = Clay_GetPointerOverIds();
+    for (int32_t i = over.length - 1; i >= 0; i--) {
+        Clay_ScrollContainerData data = Clay_GetScrollContainerData(over.internalArray[i]);
+        if (!data.found) continue;
+        bool along_x = data.config.horizontal && data.contentDimensions.width > data.scrollContainerDimensions.width;
+        bool along_y = data.config.vertical && data.contentDimensions.height > data.scrollContainerDimensions.height;
+        if (!along_x && !along_y) continue;
+
+        Clay_Vector2 position = *$cast_nonnull(data.scrollPosition);
+        cr_runtime->scroll_drag_origin = (Clay_Vector2){ position.x - pointer.x, position.y - pointer.y };
+        cr_runtime->scroll_drag_last = position;
+        return over.internalArray[i].id;
+    }
+    return 0;
+}
+
+void cr_set_pointer_state(Clay_Vector2 position, bool pointer_down) {
+    if (!cr_runtime) {
+        cr_init();
+    }
+    Clay_SetPointerState(position, pointer_down);
+    if (!cr_runtime) return;
+
+    bool moved = position.x != cr_runtime->pointer_position.x || position.y != cr_runtime->pointer_position.y;
+    if (moved) {
+        cr_runtime->pointer_moved = true;
+    }
+    if (pointer_down && !cr_runtime->pointer_down) {
+        // Grabbing a coasting container stops it
+        cr_runtime->scroll_coasting = false;
+        cr_runtime->scroll_velocity = (Clay_Vector2){0};
+        cr_runtime->scroll_drag_id = _cr_scroll_grab(position);
+    } else if (pointer_down && moved && cr_runtime->scroll_drag_id) {
+        // Content follows the pointer; the next frame shows it
+        Clay_Vector2 origin = cr_runtime->scroll_drag_origin;
+        Clay_Vector2 target = { origin.x + position.x, origin.y + position.y };
+        Clay_Vector2 dragged;
+        if (_cr_scroll_move_to(cr_runtime->scroll_drag_id, target, &dragged)) {
+            cr_runtime->needs_render = true;
+        } else {
+            cr_runtime->scroll_drag_id = 0;
+        }
+    } else if (!pointer_down && cr_runtime->pointer_down && cr_runtime->scroll_drag_id) {
+        Clay_Vector2 velocity = cr_runtime->scroll_velocity;
+        cr_runtime->scroll_coasting = _cr_absf(velocity.x) >= CR_SCROLL_COAST_MIN ||
+                                      _cr_absf(velocity.y) >= CR_SCROLL_COAST_MIN;
+        if (!cr_runtime->scroll_coasting) {
+            cr_runtime->scroll_drag_id = 0;
+        }
+    }
+    cr_runtime->pointer_position = position;
+    cr_runtime->pointer_down = pointer_down;
+
+    // Hover styling depends on the pointer-over set, not the position, so only
+    // a change of set makes plain motion worth a frame
+    if (!cr_runtime->hover_dirty) {
+        Clay_ElementIdArray over = Clay_GetPointerOverIds();
+        if ((size_t)over.length != cr_runtime->hover_ids.count) {
+            cr_runtime->hover_dirty = true;
+        } else {
+            for (int32_t i = 0; i < over.length; i++) {
+                if (!_cr_id_map_get(&cr_runtime->hover_ids, over.internalArray[i].id, NULL)) {
+                    cr_runtime->hover_dirty = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void cr_update_scroll(Clay_Vector2 delta, float delta_time) {
+    if (!cr_runtime) {
+        cr_init();
+    }
+    if (!cr_runtime) return;
+
+    if (cr_runtime->listener_count > 0) {
+        CR_Event event = { .type = CR_EVENT_SCROLL, .scroll = { .dx = delta.x, .dy = delta.y } };
+        _cr_dispatch_pointer(&event);
+    }
+
+    // Slow wheel clicks glide over their own interval, fast streams follow
+    // closely; either way the remaining distance is applied exactly
+    float glide = delta_time;
+    if (glide < CR_SCROLL_MIN_GLIDE) glide = CR_SCROLL_MIN_GLIDE;
+    if (glide > CR_SCROLL_MAX_GLIDE) glide = CR_SCROLL_MAX_GLIDE;
+    cr_runtime->scroll_rate = 1.0f / glide;
+    cr_runtime->scroll_remaining.x += delta.x * CR_SCROLL_WHEEL_SCALE;
+    cr_runtime->scroll_remaining.y += delta.y * CR_SCROLL_WHEEL_SCALE;
+    cr_request_frame_at(cr_now_ns());
+}
+
+// Release momentum, integrated exactly over dt: the distance coasted and
+// the time it takes are the same at any frame rate. Clay's own momentum
+// decays by a fixed factor per call, so the runtime drags containers itself.
+static void _cr_coast_scroll(float dt) {
+    Clay_Vector2 *velocity = &cr_runtime->scroll_velocity;
+    float decay = expf(-CR_SCROLL_FRICTION * dt);
+    float reach = (1.0f - decay) / CR_SCROLL_FRICTION;
+    Clay_ScrollContainerData data = Clay_GetScrollContainerData((Clay_ElementId){ .id = cr_runtime->scroll_drag_id });
+    Clay_Vector2 target = {0};
+    Clay_Vector2 moved = {0};
+    if (data.found) {
+        Clay_Vector2 position = *$cast_nonnull(data.scrollPosition);
+        target = (Clay_Vector2){ position.x + velocity->x * reach, position.y + velocity->y * reach };
+    }
+    if (!data.found || !_cr_scroll_move_to(cr_runtime->scroll_drag_id, target, &moved)) {
+        *velocity = (Clay_Vector2){0};
+    }
+    // An edge stops the axis it was moving along
+    if (moved.x != target.x) velocity->x = 0.0f;
+    if (moved.y != target.y) velocity->y = 0.0f;
+    velocity->x *= decay;
+    velocity->y *= decay;
+    if (_cr_absf(velocity->x) < CR_SCROLL_COAST_MIN && _cr_absf(velocity->y) < CR_SCROLL_COAST_MIN) {
+        *velocity = (Clay_Vector2){0};
+        cr_runtime->scroll_coasting = false;
+        cr_runtime->scroll_drag_id = 0;
+    }
+}
+
+// Drags sample their speed and released drags coast here, with the real
+// frame delta; Clay only keeps its container bookkeeping. Runs every frame:
+// skipping frames would freeze them.
+void _cr_step_scroll(void) {
+    if (!cr_runtime) return;
 
-    void *value = _cr_alloc(size);
-    if (!value) {
-        _cr_free(signal, sizeof(CR_SignalInternal));
-        return NULL;
+    float dt = cr_runtime->frame_delta > 0.0f ? cr_runtime->frame_delta : 1.0f / 60.0f;
+    Clay_UpdateScrollContainers(false, (Clay_Vector2){0}, dt);
+    if (cr_runtime->scroll_drag_id && cr_runtime->pointer_down) {
+        Clay_ScrollContainerData data = Clay_GetScrollContainerData((Clay_ElementId){ .id = cr_runtime->scroll_drag_id });
+        if (data.found) {
+            Clay_Vector2 position = *$cast_nonnull(data.scrollPosition);
+            Clay_Vector2 last = cr_runtime->scroll_drag_last;
+            cr_runtime->scroll_velocity = (Clay_Vector2){ (position.x - last.x) / dt, (position.y - last.y) / dt };
+            cr_runtime->scroll_drag_last = position;
+        }
+    } else if (cr_runtime->scroll_coasting) {
+        _cr_coast_scroll(dt);
     }
-    signal->value = (void * $nonnull)value;
+    _cr_glide_scroll(dt);
+}
 
-    memcpy(signal->value, initial, size);
-    signal->size = size;
-    signal->type = type;
-    signal->version = 0;
-    signal->subscribers = NULL;
-    signal->subscriber_count = 0;
+// Move this frame's share of the queued wheel distance. The runtime applies
+// it itself, in pixels, to the innermost container under the pointer that
+// can move along the wheel's axis, so cr_scroll_frame steps exactly like a
+// full frame.
+void _cr_glide_scroll(float dt) {
+    Clay_Vector2 *remaining = &cr_runtime->scroll_remaining;
+    if (remaining->x == 0.0f && remaining->y == 0.0f) return;
+
+    // Exponential approach: frame-rate independent, never overshoots
+    float fraction = 1.0f - expf(-cr_runtime->scroll_rate * dt);
+    Clay_Vector2 step = { remaining->x * fraction, remaining->y * fraction };
+    if (_cr_absf(remaining->x - step.x) < CR_SCROLL_SNAP && _cr_absf(remaining->y - step.y) < CR_SCROLL_SNAP) {
+        step = *remaining;
+    }
+    remaining->x -= step.x;
+    remaining->y -= step.y;
+    if (remaining->x != 0.0f || remaining->y != 0.0f) {
+        cr_runtime->scroll_gliding = true;
+        cr_request_frame_at(cr_runtime->frame_time_ns);
+    }
 
-    return signal;
+    Clay_ElementIdArray over = Clay_GetPointerOverIds();
+    for (int32_t i = over.length - 1; i >= 0; i--) {
+        Clay_ScrollContainerData data = Clay_GetScrollContainerData(over.internalArray[i]);
+        if (!data.found) continue;
+        float max_x = data.contentDimensions.width - data.scrollContainerDimensions.width;
+        float max_y = data.contentDimensions.height - data.scrollContainerDimensions.height;
+        bool along_x = data.config.horizontal && max_x > 0.0f && step.x != 0.0f;
+        bool along_y = data.config.vertical && max_y > 0.0f && step.y != 0.0f;
+        if (!along_x && !along_y) continue;
+
+        Clay_Vector2 *position = $cast_nonnull(data.scrollPosition);
+        if (along_x) {
+            position->x += step.x;
+            if (position->x > 0.0f) position->x = 0.0f;
+            if (position->x < -max_x) position->x = -max_x;
+        }
+        if (along_y) {
+            position->y += step.y;
+            if (position->y > 0.0f) position->y = 0.0f;
+            if (position->y < -max_y) position->y = -max_y;
+        }
+        return;
+    }
 }
 
-void _cr_signal_notify(CR_SignalInternal * $nullable signal) {
-    if (!signal) return;
+bool cr_is_hovered(Clay_ElementId element_id) {
+    if (!cr_runtime) return false;
+    // Render output now depends on hover in ways no binding describes
+    if (cr_runtime->is_rendering) {
+        cr_runtime->hover_reads = true;
+    }
+    return _cr_id_map_get(&cr_runtime->hover_ids, element_id.id, NULL);
+}
 
-    for (size_t i = 0; i < signal->subscriber_count; i++) {
-        if (signal->subscribers[i].handler) {
-            signal->subscribers[i].handler(signal->value);
-        }
+bool _cr_hovered(void) {
+    if (cr_runtime && cr_runtime->is_rendering) {
+        cr_runtime->hover_reads = true;
     }
+    return Clay_Hovered();
 }
 
-bool _cr_signal_set_if_changed(CR_SignalInternal * $nullable signal, void * $nullable value) {
-    if (!signal || !value) return false;
-    if (memcmp(signal->value, value, signal->size) == 0) {
-        return false;
+// Enter/exit are per element (they do not bubble), so only the element's own
+// hover listeners run
+static void _cr_emit_hover(uint32_t element_id, bool entered, bool exited, Clay_Vector2 delta) {
+    uint32_t index = 0;
+    if (!_cr_id_map_get(&cr_runtime->listener_map, element_id, &index)) return;
+
+    for (; index; index = cr_runtime->listeners[index - 1].next_on_element) {
+        const CR_Listener *listener = &cr_runtime->listeners[index - 1];
+        if (listener->type != CR_EVENT_HOVER) continue;
+        CR_Event event = {
+            .type = CR_EVENT_HOVER,
+            .phase = CR_PHASE_TARGET,
+            .target = element_id,
+            .hover = {
+                .x = cr_runtime->pointer_position.x,
+                .y = cr_runtime->pointer_position.y,
+                .dx = delta.x,
+                .dy = delta.y,
+                .entered = entered,
+                .exited = exited,
+            },
+        };
+        _cr_invoke_listener(listener, &event);
     }
-    memcpy(signal->value, value, signal->size);
-    signal->version++;
-    _cr_signal_notify(signal);
-    return true;
 }
 
-// ============================================================================
-// EVENT HANDLING
-// ============================================================================
+// Sample Clay's pointer-over ids once per frame and diff against the last
+// sample. Runs before the previous frame's handlers are cleared, so events go
+// to the handlers registered by the elements the pointer actually crossed.
+void _cr_update_hover(void) {
+    if (!cr_runtime) return;
 
-void _cr_register_click(uint32_t element_id, VoidBlock $nullable handler) {
-    if (!cr_runtime || !handler) return;
+    CR_IdMap recycled = cr_runtime->hover_prev;
+    cr_runtime->hover_prev = cr_runtime->hover_ids;
+    cr_runtime->hover_ids = recycled;
+    _cr_id_map_clear(&cr_runtime->hover_ids);
 
-    // Grow array if needed
-    if (cr_runtime->click_handler_count >= cr_runtime->click_handler_capacity) {
-        size_t new_cap = cr_runtime->click_handler_capacity == 0 ? 32 : cr_runtime->click_handler_capacity * 2;
-        void *new_handlers = realloc(cr_runtime->click_handlers,
-            new_cap * sizeof(cr_runtime->click_handlers[0]));
-        if (!new_handlers) return;
-        cr_runtime->click_handlers = new_handlers;
-        cr_runtime->click_handler_capacity = new_cap;
+    Clay_ElementIdArray over = Clay_GetPointerOverIds();
+    for (int32_t i = 0; i < over.length; i++) {
+        _cr_id_map_put(&cr_runtime->hover_ids, over.internalArray[i].id, (uint32_t)i);
     }
 
-    cr_runtime->click_handlers[cr_runtime->click_handler_count++] = (typeof(cr_runtime->click_handlers[0])){
-        .element_id = element_id,
-        .handler = handler,
+    Clay_Vector2 delta = {
+        cr_runtime->pointer_position.x - cr_runtime->pointer_last_frame.x,
+        cr_runtime->pointer_position.y - cr_runtime->pointer_last_frame.y,
     };
+    bool moved = cr_runtime->pointer_moved;
+    cr_runtime->pointer_last_frame = cr_runtime->pointer_position;
+    cr_runtime->pointer_moved = false;
+    cr_runtime->hover_dirty = false;
+
+    if (cr_runtime->hover_listener_count == 0) return;
+
+    for (int32_t i = 0; i < over.length; i++) {
+        uint32_t id = over.internalArray[i].id;
+        bool entered = !_cr_id_map_get(&cr_runtime->hover_prev, id, NULL);
+        if (entered || moved) {
+            _cr_emit_hover(id, entered, false, delta);
+        }
+    }
+
+    CR_IdMap *prev = &cr_runtime->hover_prev;
+    for (size_t i = 0; i < prev->capacity; i++) {
+        uint32_t id = prev->keys[i];
+        if (id && !_cr_id_map_get(&cr_runtime->hover_ids, id, NULL)) {
+            _cr_emit_hover(id, false, true, delta);
+        }
+    }
 }
 
 void _cr_dispatch_clicks(void) {
     if (!cr_runtime) return;
 
-    Clay_ElementIdArray hovered = Clay_GetPointerOverIds();
-    for (int32_t i = 0; i < hovered.length; i++) {
-        for (size_t j = 0; j < cr_runtime->click_handler_count; j++) {
-            if (hovered.internalArray[i].id == cr_runtime->click_handlers[j].element_id) {
-                if (cr_runtime->click_handlers[j].handler) {
-                    cr_runtime->click_handlers[j].handler();
-                }
-                return; // Only fire one handler per click
-            }
-        }
-    }
+    CR_Event event = {
+        .type = CR_EVENT_CLICK,
+        .click = {
+            .x = cr_runtime->pointer_position.x,
+            .y = cr_runtime->pointer_position.y,
+            .button = 1,    // Left
+            .is_press = true,
+        },
+    };
+    _cr_dispatch_pointer(&event);
 }
 
 void _cr_clear_handlers(void) {
@@ -986,6 +3975,21 @@ void _cr_clear_handlers(void) {
         }
     }
     cr_runtime->click_handler_count = 0;
+
+    for (size_t i = 0; i < cr_runtime->listener_count; i++) {
+        CR_Listener *listener = &cr_runtime->listeners[i];
+        if (listener->owns_block && listener->block) {
+            Block_release(listener->block);
+        }
+    }
+    cr_runtime->listener_count = 0;
+    cr_runtime->hover_listener_count = 0;
+    _cr_id_map_clear(&cr_runtime->listener_map);
+    _cr_id_map_clear(&cr_runtime->element_parents);
+    cr_runtime->element_stack_count = 0;
+    for (size_t i = 0; i < sizeof(cr_runtime->top_listeners) / sizeof(cr_runtime->top_listeners[0]); i++) {
+        cr_runtime->top_listeners[i].count = 0;
+    }
 }
 
 // ============================================================================
@@ -996,7 +4000,7 @@ CR_Context * $nullable _cr_create_context_impl(const char *name, size_t size, vo
     CR_Context *ctx = calloc(1, sizeof(CR_Context));
     if (!ctx) return NULL;
 
-    ctx->id = _cr_next_context_id++;
+    ctx->id = atomic_fetch_add_explicit(&_cr_next_context_id, 1, memory_order_relaxed);
     ctx->name = name;
     ctx->value_size = size;
     ctx->type = type;
@@ -1053,21 +4057,70 @@ void _cr_pop_context(CR_ContextProvider * $nullable provider) {
     free(provider);
 }
 
+// ============================================================================
+// KEEP-ALIVE IMPLEMENTATION
+// ============================================================================
+
+bool _cr_keep_alive_begin(CR_Id key, bool visible) {
+    cr_key(key);
+    _cr_component_begin("KeepAlive", NULL, 0);
+    if (!cr_runtime || !cr_runtime->current_component) {
+        return visible;
+    }
+
+    CR_Component *boundary = cr_runtime->current_component;
+    if (!boundary->keep_alive) {
+        if (!_cr_ensure_capacity((void **)&cr_runtime->keep_alive_boundaries,
+                &cr_runtime->keep_alive_capacity,
+                cr_runtime->keep_alive_count + 1,
+                sizeof(*cr_runtime->keep_alive_boundaries))) {
+            return visible;
+        }
+        cr_runtime->keep_alive_boundaries[cr_runtime->keep_alive_count++] = boundary;
+        boundary->keep_alive = true;
+    }
+
+    boundary->hidden = !visible;
+    if (visible) {
+        boundary->last_visible_frame = cr_runtime->frame;
+    }
+    return visible;
+}
+
+void _cr_keep_alive_end(void) {
+    _cr_component_end();
+}
+
+void cr_set_keep_alive_limit(size_t limit) {
+    if (!cr_runtime) {
+        cr_init();
+    }
+    if (!cr_runtime) return;
+    cr_runtime->keep_alive_limit = limit;
+}
+
 // ============================================================================
 // TEXT INPUT IMPLEMENTATION
 // ============================================================================
 
-CR_TextInputState * $nullable _cr_alloc_text_input(size_t buffer_size) {
+#define CR_TEXT_INPUT_MIN_CAPACITY 16
+
+CR_TextInputState * $nullable _cr_alloc_text_input(size_t capacity) {
     CR_TextInputState *input = calloc(1, sizeof(CR_TextInputState));
     if (!input) return NULL;
 
-    input->buffer = calloc(1, buffer_size);
+    if (capacity < CR_TEXT_INPUT_MIN_CAPACITY) {
+        capacity = CR_TEXT_INPUT_MIN_CAPACITY;
+    }
+    input->buffer = calloc(1, capacity);
     if (!input->buffer) {
         free(input);
         return NULL;
     }
 
-    input->buffer_size = buffer_size;
+    input->capacity = capacity;
+    input->gap_start = 0;
+    input->gap_end = capacity;
     input->length = 0;
     input->cursor_pos = 0;
     input->focused = false;
@@ -1078,139 +4131,553 @@ CR_TextInputState * $nullable _cr_alloc_text_input(size_t buffer_size) {
     return input;
 }
 
-void _cr_text_input_set_text(CR_TextInputState * $nullable input, const char * $nullable text) {
-    if (!input || !text) return;
+void _cr_free_text_input(CR_TextInputState * $nullable input) {
+    if (!input) return;
+    if (cr_runtime && cr_runtime->focused_input == input) {
+        _cr_unfocus_input();
+    }
+    free(input->buffer);
+    free(input->line_starts);
+    free(input->line_widths);
+    free(input);
+}
 
-    size_t len = strlen(text);
-    if (len >= input->buffer_size) {
-        len = input->buffer_size - 1;
+// Byte at a logical offset, skipping the gap
+static $always_inline char _cr_text_input_byte(const CR_TextInputState *input, size_t pos) {
+    char *buffer = $cast_nonnull(input->buffer);
+    return pos < input->gap_start ? buffer[pos] : buffer[pos + (input->gap_end - input->gap_start)];
+}
+
+// Park the gap at pos; costs the distance moved, not the text length
+static void _cr_text_input_move_gap(CR_TextInputState *input, size_t pos) {
+    char *buffer = $cast_nonnull(input->buffer);
+    if (pos < input->gap_start) {
+        size_t count = input->gap_start - pos;
+        memmove(buffer + input->gap_end - count, buffer + pos, count);
+        input->gap_start -= count;
+        input->gap_end -= count;
+    } else if (pos > input->gap_start) {
+        size_t count = pos - input->gap_start;
+        memmove(buffer + input->gap_start, buffer + input->gap_end, count);
+        input->gap_start += count;
+        input->gap_end += count;
     }
+}
 
-    bool same_text = (len == input->length) &&
-        (memcmp(input->buffer, text, len) == 0);
-    bool cursor_changed = input->cursor_pos != len;
-    if (same_text && !cursor_changed) {
+// Make room for extra bytes while always leaving one byte of gap for the
+// terminator _cr_text_input_text writes
+static bool _cr_text_input_reserve(CR_TextInputState *input, size_t extra) {
+    size_t gap = input->gap_end - input->gap_start;
+    if (gap > extra) return true;
+
+    size_t capacity = input->capacity * 2;
+    if (capacity < input->length + extra + 1) {
+        capacity = input->length + extra + 1;
+    }
+    char *buffer = realloc(input->buffer, capacity);
+    if (!buffer) return false;
+
+    size_t tail = input->capacity - input->gap_end;
+    memmove(buffer + capacity - tail, buffer + input->gap_end, tail);
+    input->buffer = buffer;
+    input->gap_end = capacity - tail;
+    input->capacity = capacity;
+    return true;
+}
+
+static $always_inline bool _cr_utf8_is_continuation(char byte) {
+    return ((unsigned char)byte & 0xC0) == 0x80;
+}
+
+// Non-ASCII counts as a word character so accented and CJK text is not
+// split at every code point
+static $always_inline bool _cr_text_is_word(char byte) {
+    unsigned char c = (unsigned char)byte;
+    return c >= 0x80 || c == '_' ||
+        (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static size_t _cr_text_input_prev_char(const CR_TextInputState *input, size_t pos) {
+    if (pos == 0) return 0;
+    pos--;
+    while (pos > 0 && _cr_utf8_is_continuation(_cr_text_input_byte(input, pos))) {
+        pos--;
+    }
+    return pos;
+}
+
+static size_t _cr_text_input_next_char(const CR_TextInputState *input, size_t pos) {
+    if (pos >= input->length) return input->length;
+    pos++;
+    while (pos < input->length && _cr_utf8_is_continuation(_cr_text_input_byte(input, pos))) {
+        pos++;
+    }
+    return pos;
+}
+
+// Where one step of unit in direction lands from pos
+static size_t _cr_text_input_boundary(const CR_TextInputState *input, size_t pos, CR_TextMove unit, int direction) {
+    switch (unit) {
+        case CR_TEXT_MOVE_CHAR:
+            return direction < 0 ? _cr_text_input_prev_char(input, pos) : _cr_text_input_next_char(input, pos);
+        case CR_TEXT_MOVE_WORD:
+            if (direction < 0) {
+                while (pos > 0 && !_cr_text_is_word(_cr_text_input_byte(input, pos - 1))) pos--;
+                while (pos > 0 && _cr_text_is_word(_cr_text_input_byte(input, pos - 1))) pos--;
+            } else {
+                while (pos < input->length && !_cr_text_is_word(_cr_text_input_byte(input, pos))) pos++;
+                while (pos < input->length && _cr_text_is_word(_cr_text_input_byte(input, pos))) pos++;
+            }
+            // Word runs stop on ASCII bytes, which are always boundaries
+            return pos;
+        case CR_TEXT_MOVE_LINE:
+            if (direction < 0) {
+                while (pos > 0 && _cr_text_input_byte(input, pos - 1) != '\n') pos--;
+            } else {
+                while (pos < input->length && _cr_text_input_byte(input, pos) != '\n') pos++;
+            }
+            return pos;
+    }
+    return pos;
+}
+
+// ----------------------------------------------------------------------------
+// Line index: line_starts[i] is the byte offset of line i. Edits patch the
+// index around the edited line instead of rescanning the text; offsets after
+// it shift by the edit length, which is a tight loop over plain integers.
+// ----------------------------------------------------------------------------
+
+static bool _cr_text_lines_reserve(CR_TextInputState *input, size_t extra) {
+    size_t needed = input->line_count + extra;
+    if (needed <= input->line_capacity) return true;
+    size_t capacity = input->line_capacity ? input->line_capacity * 2 : 64;
+    while (capacity < needed) capacity *= 2;
+    size_t *starts = realloc(input->line_starts, capacity * sizeof(size_t));
+    if (!starts) return false;
+    input->line_starts = starts;
+    float *widths = realloc(input->line_widths, capacity * sizeof(float));
+    if (!widths) return false;
+    input->line_widths = widths;
+    input->line_capacity = capacity;
+    return true;
+}
+
+static void _cr_text_lines_forget_width(CR_TextInputState *input, size_t line) {
+    float *widths = $cast_nonnull(input->line_widths);
+    if (widths[line] >= input->max_line_width) {
+        input->line_widths_dirty = true;
+    }
+    widths[line] = -1.0f;
+}
+
+static void _cr_text_lines_rebuild(CR_TextInputState *input) {
+    input->line_count = 0;
+    input->max_line_width = 0.0f;
+    input->line_widths_dirty = false;
+    if (!_cr_text_lines_reserve(input, 1)) return;
+    $cast_nonnull(input->line_starts)[0] = 0;
+    $cast_nonnull(input->line_widths)[0] = -1.0f;
+    input->line_count = 1;
+
+    for (size_t pos = 0; pos < input->length; pos++) {
+        if (_cr_text_input_byte(input, pos) != '\n') continue;
+        if (!_cr_text_lines_reserve(input, 1)) return;
+        $cast_nonnull(input->line_starts)[input->line_count] = pos + 1;
+        $cast_nonnull(input->line_widths)[input->line_count] = -1.0f;
+        input->line_count++;
+    }
+}
+
+// Text [pos, pos + length) was just inserted
+static void _cr_text_lines_inserted(CR_TextInputState *input, size_t pos, const char *text, size_t length) {
+    if (!input->line_starts) return;
+
+    size_t added = 0;
+    for (size_t i = 0; i < length; i++) {
+        added += text[i] == '\n';
+    }
+    if (!_cr_text_lines_reserve(input, added)) {
+        _cr_text_lines_rebuild(input);
         return;
     }
 
-    if (!same_text) {
-        memcpy(input->buffer, text, len);
-        input->buffer[len] = '\0';
-        input->length = len;
+    size_t *starts = $cast_nonnull(input->line_starts);
+    float *widths = $cast_nonnull(input->line_widths);
+    size_t line = _cr_text_input_line_at(input, pos);
+    _cr_text_lines_forget_width(input, line);
+
+    size_t tail = input->line_count - line - 1;
+    memmove(starts + line + 1 + added, starts + line + 1, tail * sizeof(size_t));
+    memmove(widths + line + 1 + added, widths + line + 1, tail * sizeof(float));
+    for (size_t i = line + 1 + added; i < input->line_count + added; i++) {
+        starts[i] += length;
     }
-    input->cursor_pos = len;
 
-    if (input->on_change && !same_text) {
-        input->on_change(input->buffer);
+    size_t next = line + 1;
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] != '\n') continue;
+        starts[next] = pos + i + 1;
+        widths[next] = -1.0f;
+        next++;
     }
+    input->line_count += added;
+}
 
-    _cr_schedule_render();
+// Text [from, to) is about to be removed
+static void _cr_text_lines_removed(CR_TextInputState *input, size_t from, size_t to) {
+    if (!input->line_starts) return;
+
+    size_t *starts = $cast_nonnull(input->line_starts);
+    float *widths = $cast_nonnull(input->line_widths);
+    size_t first = _cr_text_input_line_at(input, from);
+    size_t last = _cr_text_input_line_at(input, to);
+    for (size_t i = first; i <= last; i++) {
+        _cr_text_lines_forget_width(input, i);
+    }
+
+    // Lines first+1..last started inside the removed range
+    size_t removed = last - first;
+    size_t tail = input->line_count - last - 1;
+    memmove(starts + first + 1, starts + last + 1, tail * sizeof(size_t));
+    memmove(widths + first + 1, widths + last + 1, tail * sizeof(float));
+    input->line_count -= removed;
+    for (size_t i = first + 1; i < input->line_count; i++) {
+        starts[i] -= to - from;
+    }
 }
 
-void _cr_text_input_insert(CR_TextInputState * $nullable input, const char * $nullable text) {
-    if (!input || !text) return;
+bool _cr_text_input_enable_lines(CR_TextInputState * $nullable input) {
+    if (!input) return false;
+    if (input->line_starts) return true;
+    _cr_text_lines_rebuild(input);
+    input->multiline = true;
+    return input->line_starts != NULL;
+}
+
+size_t _cr_text_input_line_at(CR_TextInputState * $nullable input, size_t pos) {
+    if (!input || !input->line_starts || input->line_count == 0) return 0;
+    const size_t *starts = $cast_nonnull(input->line_starts);
+    size_t low = 0;
+    size_t high = input->line_count - 1;
+    while (low < high) {
+        size_t mid = low + (high - low + 1) / 2;
+        if (starts[mid] <= pos) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
 
-    size_t insert_len = strlen(text);
-    if (input->length + insert_len >= input->buffer_size) {
-        insert_len = input->buffer_size - input->length - 1;
+size_t _cr_text_input_line_end(CR_TextInputState * $nullable input, size_t line) {
+    if (!input || !input->line_starts || line + 1 >= input->line_count) {
+        return input ? input->length : 0;
     }
-    if (insert_len == 0) return;
+    return $cast_nonnull(input->line_starts)[line + 1] - 1;
+}
 
-    // Move text after cursor
-    memmove(input->buffer + input->cursor_pos + insert_len,
-            input->buffer + input->cursor_pos,
-            input->length - input->cursor_pos + 1);
+void _cr_text_input_set_line_width(CR_TextInputState * $nullable input, size_t line, float width) {
+    if (!input || !input->line_widths || line >= input->line_count) return;
+    $cast_nonnull(input->line_widths)[line] = width;
+    if (width > input->max_line_width) {
+        input->max_line_width = width;
+    }
+}
 
-    // Insert new text
-    memcpy(input->buffer + input->cursor_pos, text, insert_len);
-    input->length += insert_len;
-    input->cursor_pos += insert_len;
+float _cr_text_input_content_width(CR_TextInputState * $nullable input) {
+    if (!input || !input->line_widths) return 0.0f;
+    if (input->line_widths_dirty) {
+        const float *widths = $cast_nonnull(input->line_widths);
+        float max_width = 0.0f;
+        for (size_t i = 0; i < input->line_count; i++) {
+            if (widths[i] > max_width) max_width = widths[i];
+        }
+        input->max_line_width = max_width;
+        input->line_widths_dirty = false;
+    }
+    return input->max_line_width;
+}
 
-    if (input->on_change) {
-        input->on_change(input->buffer);
+static void _cr_text_input_set_cursor(CR_TextInputState *input, size_t pos, bool extend) {
+    input->cursor_pos = pos;
+    if (!extend) {
+        input->selection_start = pos;
     }
+    input->selection_end = pos;
+}
 
+// Drop [from, to) by widening the gap over it
+static void _cr_text_input_remove(CR_TextInputState *input, size_t from, size_t to) {
+    _cr_text_lines_removed(input, from, to);
+    _cr_text_input_move_gap(input, from);
+    input->gap_end += to - from;
+    input->length -= to - from;
+    _cr_text_input_set_cursor(input, from, false);
+}
+
+static bool _cr_text_input_remove_selection(CR_TextInputState *input) {
+    size_t start = 0;
+    size_t end = 0;
+    if (!_cr_text_input_selection(input, &start, &end)) return false;
+    _cr_text_input_remove(input, start, end);
+    return true;
+}
+
+static void _cr_text_input_changed(CR_TextInputState *input) {
+    input->revision++;
+    if (input->on_change) {
+        input->on_change(_cr_text_input_view(input, 0, input->length));
+    }
     _cr_schedule_render();
 }
 
-void _cr_text_input_backspace(CR_TextInputState * $nullable input) {
-    if (!input || input->cursor_pos == 0) return;
+const char *_cr_text_input_text(CR_TextInputState * $nullable input) {
+    if (!input || !input->buffer) return "";
+    // Closing the gap at the end makes the text contiguous; the gap always
+    // keeps a byte for the terminator
+    _cr_text_input_move_gap(input, input->length);
+    char *buffer = $cast_nonnull(input->buffer);
+    buffer[input->length] = '\0';
+    return buffer;
+}
 
-    memmove(input->buffer + input->cursor_pos - 1,
-            input->buffer + input->cursor_pos,
-            input->length - input->cursor_pos + 1);
+CR_TextView _cr_text_input_view(CR_TextInputState * $nullable input, size_t start, size_t end) {
+    if (!input || !input->buffer) return (CR_TextView){ .before = "", .after = "" };
+    if (end > input->length) end = input->length;
+    if (start > end) start = end;
+
+    // [start, end) in logical offsets, split where the gap sits
+    const char *buffer = $cast_nonnull(input->buffer);
+    size_t split = input->gap_start;
+    size_t before_end = end < split ? end : split;
+    size_t after_start = start > split ? start : split;
+    size_t gap = input->gap_end - input->gap_start;
+    return (CR_TextView){
+        .before = buffer + start,
+        .before_length = start < before_end ? before_end - start : 0,
+        .after = buffer + after_start + gap,
+        .after_length = after_start < end ? end - after_start : 0,
+    };
+}
 
-    input->length--;
-    input->cursor_pos--;
+size_t _cr_text_input_copy(CR_TextInputState * $nullable input, char *dest, size_t size) {
+    CR_TextView view = _cr_text_input_view(input, 0, input ? input->length : 0);
+    if (size == 0) return view.before_length + view.after_length;
+
+    size_t room = size - 1;
+    size_t first = view.before_length < room ? view.before_length : room;
+    memcpy(dest, view.before, first);
+    size_t second = view.after_length < room - first ? view.after_length : room - first;
+    memcpy(dest + first, view.after, second);
+    dest[first + second] = '\0';
+    return view.before_length + view.after_length;
+}
 
-    if (input->on_change) {
-        input->on_change(input->buffer);
+void _cr_text_input_set_text(CR_TextInputState * $nullable input, const char * $nullable text) {
+    if (!input || !text) return;
+
+    size_t len = strlen(text);
+    CR_TextView current = _cr_text_input_view(input, 0, input->length);
+    bool same_text = (len == input->length) &&
+        memcmp(current.before, text, current.before_length) == 0 &&
+        memcmp(current.after, text + current.before_length, current.after_length) == 0;
+    bool cursor_changed = input->cursor_pos != len || input->selection_start != len;
+    if (same_text && !cursor_changed) {
+        return;
     }
 
-    _cr_schedule_render();
+    if (!same_text) {
+        _cr_text_input_move_gap(input, input->length);
+        input->gap_start = 0;
+        input->length = 0;
+        if (!_cr_text_input_reserve(input, len)) return;
+        memcpy($cast_nonnull(input->buffer), text, len);
+        input->gap_start = len;
+        input->length = len;
+        if (input->line_starts) {
+            _cr_text_lines_rebuild(input);
+        }
+    }
+    _cr_text_input_set_cursor(input, len, false);
+
+    if (!same_text) {
+        _cr_text_input_changed(input);
+    } else {
+        _cr_schedule_render();
+    }
+}
+
+void _cr_text_input_insert_n(CR_TextInputState * $nullable input, const char * $nullable text, size_t length) {
+    if (!input || !text) return;
+
+    bool removed = _cr_text_input_remove_selection(input);
+    if (length == 0 || !_cr_text_input_reserve(input, length)) {
+        if (removed) {
+            _cr_text_input_changed(input);
+        }
+        return;
+    }
+
+    _cr_text_input_move_gap(input, input->cursor_pos);
+    memcpy($cast_nonnull(input->buffer) + input->gap_start, text, length);
+    input->gap_start += length;
+    input->length += length;
+    _cr_text_lines_inserted(input, input->cursor_pos, text, length);
+    _cr_text_input_set_cursor(input, input->gap_start, false);
+
+    _cr_text_input_changed(input);
+}
+
+void _cr_text_input_insert(CR_TextInputState * $nullable input, const char * $nullable text) {
+    if (!text) return;
+    _cr_text_input_insert_n(input, text, strlen(text));
+}
+
+void _cr_text_input_erase(CR_TextInputState * $nullable input, CR_TextMove unit, int direction) {
+    if (!input) return;
+
+    if (!_cr_text_input_remove_selection(input)) {
+        size_t target = _cr_text_input_boundary(input, input->cursor_pos, unit, direction);
+        if (target == input->cursor_pos) return;
+        if (target < input->cursor_pos) {
+            _cr_text_input_remove(input, target, input->cursor_pos);
+        } else {
+            _cr_text_input_remove(input, input->cursor_pos, target);
+        }
+    }
+
+    _cr_text_input_changed(input);
+}
+
+void _cr_text_input_backspace(CR_TextInputState * $nullable input) {
+    _cr_text_input_erase(input, CR_TEXT_MOVE_CHAR, -1);
 }
 
 void _cr_text_input_delete(CR_TextInputState * $nullable input) {
-    if (!input || input->cursor_pos >= input->length) return;
+    _cr_text_input_erase(input, CR_TEXT_MOVE_CHAR, 1);
+}
 
-    memmove(input->buffer + input->cursor_pos,
-            input->buffer + input->cursor_pos + 1,
-            input->length - input->cursor_pos);
+void _cr_text_input_move(CR_TextInputState * $nullable input, CR_TextMove unit, int direction, bool extend) {
+    if (!input) return;
 
-    input->length--;
+    size_t start = 0;
+    size_t end = 0;
+    size_t target;
+    if (!extend && unit == CR_TEXT_MOVE_CHAR && _cr_text_input_selection(input, &start, &end)) {
+        // Collapsing a selection lands on its edge rather than stepping past it
+        target = direction < 0 ? start : end;
+    } else {
+        target = _cr_text_input_boundary(input, input->cursor_pos, unit, direction);
+    }
 
-    if (input->on_change) {
-        input->on_change(input->buffer);
+    bool had_selection = input->selection_start != input->selection_end;
+    if (target == input->cursor_pos && (extend || !had_selection)) {
+        return;
     }
+    _cr_text_input_set_cursor(input, target, extend);
 
     _cr_schedule_render();
 }
 
 void _cr_text_input_move_cursor(CR_TextInputState * $nullable input, int delta) {
     if (!input) return;
+    int direction = delta < 0 ? -1 : 1;
+    for (int steps = delta < 0 ? -delta : delta; steps > 0; steps--) {
+        _cr_text_input_move(input, CR_TEXT_MOVE_CHAR, direction, false);
+    }
+}
+
+void _cr_text_input_move_vertical(CR_TextInputState * $nullable input, int direction, bool extend) {
+    if (!input || !input->line_starts) return;
+
+    size_t line = _cr_text_input_line_at(input, input->cursor_pos);
+    size_t target;
+    if (direction < 0 && line == 0) {
+        target = 0;
+    } else if (direction > 0 && line + 1 >= input->line_count) {
+        target = input->length;
+    } else {
+        // Keep the column in code points, clamped to the target line
+        const size_t *starts = $cast_nonnull(input->line_starts);
+        size_t column = 0;
+        for (size_t pos = starts[line]; pos < input->cursor_pos; pos = _cr_text_input_next_char(input, pos)) {
+            column++;
+        }
+        size_t target_line = direction < 0 ? line - 1 : line + 1;
+        size_t end = _cr_text_input_line_end(input, target_line);
+        target = starts[target_line];
+        for (; column > 0 && target < end; column--) {
+            target = _cr_text_input_next_char(input, target);
+        }
+    }
 
-    int new_pos = (int)input->cursor_pos + delta;
-    if (new_pos < 0) new_pos = 0;
-    if (new_pos > (int)input->length) new_pos = (int)input->length;
-    if ((size_t)new_pos == input->cursor_pos) {
+    if (target == input->cursor_pos && (extend || input->selection_start == input->selection_end)) {
         return;
     }
-    input->cursor_pos = (size_t)new_pos;
+    _cr_text_input_set_cursor(input, target, extend);
+    _cr_schedule_render();
+}
 
+void _cr_text_input_select_all(CR_TextInputState * $nullable input) {
+    if (!input) return;
+    if (input->selection_start == 0 && input->cursor_pos == input->length) return;
+    input->selection_start = 0;
+    input->cursor_pos = input->length;
+    input->selection_end = input->length;
     _cr_schedule_render();
 }
 
+bool _cr_text_input_selection(CR_TextInputState * $nullable input, size_t *start, size_t *end) {
+    if (!input || input->selection_start == input->selection_end) return false;
+    bool forward = input->selection_start < input->selection_end;
+    *start = forward ? input->selection_start : input->selection_end;
+    *end = forward ? input->selection_end : input->selection_start;
+    return true;
+}
+
 void _cr_focus_input(CR_TextInputState * $nullable input, uint32_t element_id) {
-    if (input && _cr_focused_input == input &&
+    if (!cr_runtime) {
+        cr_init();
+    }
+    if (!cr_runtime) return;
+
+    CR_TextInputState *previous = cr_runtime->focused_input;
+    if (input && previous == input &&
             input->focused && input->editing && input->element_id == element_id) {
         return;
     }
 
     // Unfocus previous
-    if (_cr_focused_input && _cr_focused_input != input) {
-        _cr_focused_input->focused = false;
-        _cr_focused_input->editing = false;
+    if (previous && previous != input) {
+        previous->focused = false;
+        previous->editing = false;
     }
 
-    _cr_focused_input = input;
+    cr_runtime->focused_input = input;
     if (input) {
         input->focused = true;
         input->editing = true;
         input->element_id = element_id;
-        input->cursor_pos = input->length; // Move cursor to end
+        _cr_text_input_set_cursor(input, input->length, false); // Move cursor to end
     }
+    cr_runtime->focused_element = input ? element_id : 0;
 
     _cr_schedule_render();
 }
 
 void _cr_unfocus_input(void) {
-    if (!_cr_focused_input) {
+    CR_TextInputState *input = cr_runtime ? cr_runtime->focused_input : NULL;
+    if (!input) {
         return;
     }
-    bool was_focused = _cr_focused_input->focused || _cr_focused_input->editing;
-    _cr_focused_input->focused = false;
-    _cr_focused_input->editing = false;
-    _cr_focused_input = NULL;
+    bool was_focused = input->focused || input->editing;
+    if (cr_runtime->focused_element == input->element_id) {
+        cr_runtime->focused_element = 0;
+    }
+    input->focused = false;
+    input->editing = false;
+    cr_runtime->focused_input = NULL;
 
     if (was_focused) {
         _cr_schedule_render();
@@ -1218,37 +4685,70 @@ void _cr_unfocus_input(void) {
 }
 
 void _cr_handle_text_event(const char * $nullable text) {
-    if (_cr_focused_input && text) {
-        _cr_text_input_insert(_cr_focused_input, text);
+    if (cr_runtime && cr_runtime->focused_input && text) {
+        _cr_text_input_insert(cr_runtime->focused_input, text);
     }
 }
 
-void _cr_handle_key_event(int keycode, bool is_press) {
-    if (!_cr_focused_input || !is_press) return;
+void _cr_handle_key(KeyEvent event) {
+    // Listeners get first refusal; text editing is the default action
+    if (cr_dispatch_key(event)) return;
+    CR_TextInputState *input = cr_runtime ? cr_runtime->focused_input : NULL;
+    if (!input || !event.is_press) return;
+
+    bool extend = (event.modifiers & CR_MOD_SHIFT) != 0;
+    CR_TextMove step = (event.modifiers & (CR_MOD_CTRL | CR_MOD_ALT)) ? CR_TEXT_MOVE_WORD : CR_TEXT_MOVE_CHAR;
+    if (event.modifiers & CR_MOD_SUPER) {
+        step = CR_TEXT_MOVE_LINE;
+    }
 
-    // SDL keycodes
-    switch (keycode) {
-        case 8:   // Backspace
-            _cr_text_input_backspace(_cr_focused_input);
+    switch (event.keycode) {
+        case CR_KEY_BACKSPACE:
+            _cr_text_input_erase(input, step, -1);
             break;
-        case 127: // Delete
-            _cr_text_input_delete(_cr_focused_input);
+        case CR_KEY_DELETE:
+            _cr_text_input_erase(input, step, 1);
             break;
-        case 1073741904: // Left arrow (SDL_SCANCODE_LEFT)
-            _cr_text_input_move_cursor(_cr_focused_input, -1);
+        case CR_KEY_LEFT:
+            _cr_text_input_move(input, step, -1, extend);
             break;
-        case 1073741903: // Right arrow (SDL_SCANCODE_RIGHT)
-            _cr_text_input_move_cursor(_cr_focused_input, 1);
+        case CR_KEY_RIGHT:
+            _cr_text_input_move(input, step, 1, extend);
             break;
-        case 27:  // Escape
-            _cr_unfocus_input();
+        case CR_KEY_HOME:
+            _cr_text_input_move(input, CR_TEXT_MOVE_LINE, -1, extend);
+            break;
+        case CR_KEY_END:
+            _cr_text_input_move(input, CR_TEXT_MOVE_LINE, 1, extend);
+            break;
+        case 'a':
+            if (event.modifiers & (CR_MOD_CTRL | CR_MOD_SUPER)) {
+                _cr_text_input_select_all(input);
+            }
+            break;
+        case CR_KEY_UP:
+            _cr_text_input_move_vertical(input, -1, extend);
             break;
-        case 13:  // Enter - unfocus but keep text
+        case CR_KEY_DOWN:
+            _cr_text_input_move_vertical(input, 1, extend);
+            break;
+        case CR_KEY_ESCAPE:
             _cr_unfocus_input();
             break;
+        case CR_KEY_RETURN:
+            if (input->multiline) {
+                _cr_text_input_insert_n(input, "\n", 1);
+            } else {
+                _cr_unfocus_input(); // Unfocus but keep text
+            }
+            break;
     }
 }
 
+void _cr_handle_key_event(int keycode, bool is_press) {
+    _cr_handle_key((KeyEvent){ .keycode = keycode, .is_press = is_press });
+}
+
 // ============================================================================
 // DEBUG
 // ============================================================================
@@ -46,6 +46,8 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <math.h>
 #include <iso646.h>
 #include "reflect.h"
 
@@ -82,6 +84,8 @@ typedef struct CR_ContextProvider CR_ContextProvider;
 typedef struct CR_Signal CR_Signal;
 typedef struct CR_StateInternal CR_StateInternal;
 typedef struct CR_SignalInternal CR_SignalInternal;
+typedef struct CR_TimerInternal CR_TimerInternal;
+typedef struct CR_Style CR_Style;
 typedef struct CR_Runtime CR_Runtime;
 
 // ============================================================================
@@ -167,11 +171,33 @@ typedef struct {
 typedef struct {
     int keycode;
     int scancode;
-    int modifiers;
+    int modifiers;          // CR_KeyModifier bits
     bool is_press;
     bool is_repeat;
+    bool handled;           // Set by an $on_key handler to stop the key here
 } KeyEvent;
 
+typedef enum {
+    CR_MOD_SHIFT = 1 << 0,
+    CR_MOD_CTRL  = 1 << 1,
+    CR_MOD_ALT   = 1 << 2,
+    CR_MOD_SUPER = 1 << 3,
+} CR_KeyModifier;
+
+// Keycodes the runtime acts on (SDL values, which every backend maps to)
+enum {
+    CR_KEY_BACKSPACE = 8,
+    CR_KEY_RETURN    = 13,
+    CR_KEY_ESCAPE    = 27,
+    CR_KEY_DELETE    = 127,
+    CR_KEY_HOME      = 1073741898,
+    CR_KEY_END       = 1073741901,
+    CR_KEY_RIGHT     = 1073741903,
+    CR_KEY_LEFT      = 1073741904,
+    CR_KEY_DOWN      = 1073741905,
+    CR_KEY_UP        = 1073741906,
+};
+
 typedef struct {
     float dx, dy;
 } ScrollEvent;
@@ -180,7 +206,63 @@ typedef void (^OnClickBlock)(ClickEvent *event);
 typedef void (^OnHoverBlock)(HoverEvent *event);
 typedef void (^OnKeyBlock)(KeyEvent *event);
 typedef void (^OnScrollBlock)(ScrollEvent *event);
-typedef void (^OnTextChangeBlock)(const char *text);
+
+/**
+ * CR_TextView - Text as a gap buffer holds it: before then after
+ *
+ * Points into the input's buffer and is valid until its next edit. Neither
+ * piece is NUL-terminated; _cr_text_input_copy makes the text contiguous.
+ */
+typedef struct {
+    const char *before;
+    size_t before_length;
+    const char *after;
+    size_t after_length;
+} CR_TextView;
+
+typedef void (^OnTextChangeBlock)(CR_TextView text);
+
+typedef enum {
+    CR_EVENT_CLICK = 0,
+    CR_EVENT_KEY,
+    CR_EVENT_SCROLL,
+    CR_EVENT_HOVER,
+} CR_EventType;
+
+typedef enum {
+    CR_PHASE_CAPTURE = 0,
+    CR_PHASE_TARGET,
+    CR_PHASE_BUBBLE,
+} CR_EventPhase;
+
+/**
+ * CR_Event - Routed event seen by $on_event listeners
+ *
+ * Pointer events travel the elements under the pointer; key events travel
+ * from the focused element up through the elements clay_react components
+ * opened around it (elements opened with CLAY() directly are not on that
+ * path). Capture runs root to target, bubble runs target to root, and
+ * cr_stop_propagation ends the walk.
+ */
+typedef struct {
+    CR_EventType type;
+    CR_EventPhase phase;
+    uint32_t target;        // Element the event is aimed at (0 = root)
+    uint32_t current;       // Element whose listener is running
+    bool propagation_stopped;
+    union {
+        ClickEvent click;
+        KeyEvent key;
+        ScrollEvent scroll;
+        HoverEvent hover;
+    };
+} CR_Event;
+
+typedef void (^OnEventBlock)(CR_Event *event);
+
+static inline void cr_stop_propagation(CR_Event *event) {
+    event->propagation_stopped = true;
+}
 
 // ============================================================================
 // TEXT INPUT STATE
@@ -188,49 +270,95 @@ typedef void (^OnTextChangeBlock)(const char *text);
 
 /**
  * Text input field state - used for editable text fields
+ *
+ * The text lives in a growable gap buffer: bytes [0, gap_start) and
+ * [gap_end, capacity) with the gap parked at the last edit, so typing at the
+ * cursor is O(1) amortized. Offsets are bytes of UTF-8 and the cursor only
+ * rests on code point boundaries. Rendering reads the two pieces through
+ * _cr_text_input_view; _cr_text_input_text closes the gap for a C string and
+ * _cr_text_input_copy copies one out without disturbing it.
  */
 typedef struct CR_TextInputState {
-    char *buffer;           // Text buffer
-    size_t buffer_size;     // Allocated size
+    char * $nullable buffer; // Gap buffer storage
+    size_t capacity;        // Allocated size
+    size_t gap_start;       // First byte of the gap
+    size_t gap_end;         // One past the gap
     size_t length;          // Current text length
     size_t cursor_pos;      // Cursor position
-    size_t selection_start; // Selection start (if any)
-    size_t selection_end;   // Selection end (if any)
+    size_t selection_start; // Selection anchor (== selection_end if none)
+    size_t selection_end;   // Moving end of the selection, always cursor_pos
     bool focused;           // Is this input focused?
     bool editing;           // Is text being edited?
     uint32_t element_id;    // Associated element ID
     OnTextChangeBlock $nullable on_change; // Callback when text changes
+    uint64_t revision;      // Bumped on every text change
+
+    // Line index, built once a TextArea shows this state
+    size_t * $nullable line_starts; // Byte offset of each line
+    float * $nullable line_widths;  // Measured width per line (< 0 = unknown)
+    size_t line_count;
+    size_t line_capacity;
+    float max_line_width;   // Widest measured line
+    bool line_widths_dirty; // max_line_width needs a rescan
+    bool multiline;         // Enter inserts a newline instead of unfocusing
+    uint64_t laid_out_revision; // revision the last TextArea layout showed
 } CR_TextInputState;
 
-// Current focused input (only one at a time)
-extern CR_TextInputState * $nullable _cr_focused_input;
-
-// Text input management
-CR_TextInputState * $nullable _cr_alloc_text_input(size_t buffer_size);
+// Units for cursor movement and deletion
+typedef enum {
+    CR_TEXT_MOVE_CHAR,      // One code point
+    CR_TEXT_MOVE_WORD,      // To the previous word start / next word end
+    CR_TEXT_MOVE_LINE,      // To the start / end of the line
+} CR_TextMove;
+
+// Text input management (capacity is an initial size; the buffer grows)
+CR_TextInputState * $nullable _cr_alloc_text_input(size_t capacity);
+void _cr_free_text_input(CR_TextInputState * $nullable input);
+const char *_cr_text_input_text(CR_TextInputState * $nullable input);
+CR_TextView _cr_text_input_view(CR_TextInputState * $nullable input, size_t start, size_t end);
+size_t _cr_text_input_copy(CR_TextInputState * $nullable input, char *dest, size_t size);
 void _cr_text_input_set_text(CR_TextInputState * $nullable input, const char * $nullable text);
 void _cr_text_input_insert(CR_TextInputState * $nullable input, const char * $nullable text);
+void _cr_text_input_insert_n(CR_TextInputState * $nullable input, const char * $nullable text, size_t length);
 void _cr_text_input_backspace(CR_TextInputState * $nullable input);
 void _cr_text_input_delete(CR_TextInputState * $nullable input);
+void _cr_text_input_erase(CR_TextInputState * $nullable input, CR_TextMove unit, int direction);
 void _cr_text_input_move_cursor(CR_TextInputState * $nullable input, int delta);
+void _cr_text_input_move(CR_TextInputState * $nullable input, CR_TextMove unit, int direction, bool extend);
+void _cr_text_input_select_all(CR_TextInputState * $nullable input);
+bool _cr_text_input_selection(CR_TextInputState * $nullable input, size_t *start, size_t *end);
+void _cr_text_input_move_vertical(CR_TextInputState * $nullable input, int direction, bool extend);
+bool _cr_text_input_enable_lines(CR_TextInputState * $nullable input);
+size_t _cr_text_input_line_at(CR_TextInputState * $nullable input, size_t pos);
+size_t _cr_text_input_line_end(CR_TextInputState * $nullable input, size_t line);
+void _cr_text_input_set_line_width(CR_TextInputState * $nullable input, size_t line, float width);
+float _cr_text_input_content_width(CR_TextInputState * $nullable input);
 void _cr_focus_input(CR_TextInputState * $nullable input, uint32_t element_id);
 void _cr_unfocus_input(void);
 void _cr_handle_text_event(const char * $nullable text);
+void _cr_handle_key(KeyEvent event);
 void _cr_handle_key_event(int keycode, bool is_press);
 
 // Frame-scoped string allocation (used by formatted text helpers)
 char * $nullable _cr_temp_string_alloc(size_t size);
 
+
 // ============================================================================
 // CORE COMPONENT TYPES
 // ============================================================================
 
 /**
  * CR_Id - Component identity (string + optional index)
+ *
+ * hash/length are filled in lazily; ids built with cr_id_hashed, $id_lit or
+ * $use_id carry them so element ids never rescan the name.
  */
 typedef struct {
     const char * $nullable name;
     uint32_t index;
     bool indexed;
+    uint32_t length;
+    uint32_t hash;      // One-at-a-time accumulator over name (0 = not hashed)
 } CR_Id;
 
 static $always_inline CR_Id cr_id(const char *name) {
@@ -241,6 +369,128 @@ static $always_inline CR_Id cr_idi(const char *name, uint32_t index) {
     return (CR_Id){ .name = name, .index = index, .indexed = true };
 }
 
+// Same accumulation Clay uses for element ids, minus the finalisation. Clay
+// adds plain char, so bytes >= 0x80 sign-extend where char is signed.
+static $always_inline uint32_t cr_hash_bytes(const char *chars, size_t length) {
+    uint32_t hash = 0;
+    for (size_t i = 0; i < length; i++) {
+        hash += (uint32_t)chars[i];
+        hash += (hash << 10);
+        hash ^= (hash >> 6);
+    }
+    return hash;
+}
+
+static $always_inline bool cr_id_is_hashed(CR_Id id) {
+    return id.hash != 0 || id.length != 0;
+}
+
+static $always_inline CR_Id cr_id_hashed(const char *name) {
+    size_t length = strlen(name);
+    return (CR_Id){
+        .name = name,
+        .length = (uint32_t)length,
+        .hash = cr_hash_bytes(name, length),
+    };
+}
+
+static $always_inline CR_Id cr_id_index(CR_Id id, uint32_t index) {
+    id.index = index;
+    id.indexed = true;
+    return id;
+}
+
+/**
+ * $id_lit - CR_Id for a string literal, hashed once per call site and thread
+ *
+ * Usage:
+ *   Button((ButtonParams){ .id = $id_lit("SaveButton"), ... });
+ *   $keyi_lit("Row", row->id);
+ */
+#define $id_lit(s) \
+    ({ \
+        static _Thread_local CR_Id _cr_lit_id = {0}; \
+        if (!_cr_lit_id.name) { \
+            _cr_lit_id = cr_id_hashed("" s ""); \
+        } \
+        _cr_lit_id; \
+    })
+#define $id_liti(s, i) cr_id_index($id_lit(s), (uint32_t)(i))
+
+/**
+ * CR_Str - Length-carrying string for text content
+ *
+ * is_static marks storage that outlives the program's frames (literals and
+ * interned strings); Clay then keys its measure cache by pointer instead of
+ * rehashing the bytes every frame.
+ *
+ * Usage:
+ *   Text((TextParams){ .str = $lit("Help") });
+ *   Button((ButtonParams){ .label_str = cr_intern(name), ... });
+ */
+typedef struct {
+    const char * $nullable chars;
+    uint32_t length;
+    uint32_t hash;      // cr_hash_bytes over chars (0 = not hashed)
+    bool is_static;
+} CR_Str;
+
+#define $lit(s) ((CR_Str){ .chars = "" s "", .length = (uint32_t)(sizeof(s) - 1), .is_static = true })
+
+static $always_inline CR_Str cr_str(const char * $nullable chars) {
+    if (!chars) return (CR_Str){0};
+    return (CR_Str){ .chars = chars, .length = (uint32_t)strlen(chars) };
+}
+
+static $always_inline CR_Str cr_str_n(const char *chars, size_t length) {
+    return (CR_Str){ .chars = chars, .length = (uint32_t)length };
+}
+
+// Caller guarantees chars stays valid and unchanged until shutdown
+static $always_inline CR_Str cr_str_static(const char * $nullable chars) {
+    CR_Str str = cr_str(chars);
+    str.is_static = str.chars != NULL;
+    return str;
+}
+
+static $always_inline bool cr_str_equal(CR_Str a, CR_Str b) {
+    if (a.length != b.length) return false;
+    if (a.chars == b.chars) return true;
+    if (a.hash && b.hash && a.hash != b.hash) return false;
+    if (!a.chars || !b.chars) return a.length == 0;
+    return memcmp($cast_nonnull(a.chars), $cast_nonnull(b.chars), a.length) == 0;
+}
+
+/**
+ * cr_intern - Runtime-owned, deduplicated copy of a string
+ *
+ * Equal contents return the same pointer, so interned strings are hashed and
+ * measured once. Storage lives until cr_shutdown.
+ */
+CR_Str cr_intern(const char * $nullable chars);
+CR_Str cr_intern_n(const char * $nullable chars, size_t length);
+
+/**
+ * cr_format - printf into the frame arena in a single pass
+ *
+ * Plain %d %i %u %x %c %s and %f/%.Nf go through built-in formatters; flags,
+ * widths and other conversions fall back to snprintf per specifier. The
+ * result is valid until the next cr_begin_frame.
+ */
+CR_Str cr_format(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+CR_Str _cr_format_v(const char *fmt, va_list args);
+CR_Str _cr_format_memo_v(uint32_t key, const char *fmt, va_list args);
+
+/**
+ * cr_set_measure_text - Install the text measure function
+ *
+ * Hands the function to Clay and keeps it for components that break lines
+ * themselves (Paragraph). Backends call this instead of
+ * Clay_SetMeasureTextFunction.
+ */
+void cr_set_measure_text(CR_MeasureTextFn measure, void * $nullable user_data);
+const CR_ParagraphLines * $nullable _cr_paragraph_lines(uint32_t key, Clay_String text, Clay_TextElementConfig *config, float width);
+
 /**
  * View style configuration for layout containers and components.
  */
@@ -265,6 +515,10 @@ typedef struct {
     bool scroll_x;
     bool scroll_y;
     VoidBlock $nullable on_click;
+    OnHoverBlock $nullable on_hover;
+    OnScrollBlock $nullable on_scroll;
+    OnKeyBlock $nullable on_key;
+    const CR_Style * $nullable compiled;    // Replaces style when set (see $style)
 } BoxParams;
 
 /**
@@ -286,16 +540,146 @@ typedef struct {
 typedef struct {
     const char * $nullable text;
     TextConfig style;
+    CR_Str str;         // Takes precedence over text when set
+    CR_Id memo_id;      // Textf: reuse the formatted text while the arguments match
 } TextParams;
 
+/**
+ * ParagraphParams - Long word-wrapped text (see Paragraph).
+ */
+typedef struct {
+    CR_Id id;           // Required: keys the line cache and supplies the wrap width
+    const char * $nullable text;
+    CR_Str str;         // Takes precedence over text when set
+    TextConfig style;   // wrap_mode is ignored; lines break at spaces and newlines
+    CR_Id clip_id;      // Enclosing scroll container (default: the window)
+} ParagraphParams;
+
 // ============================================================================
 // CORE RUNTIME
 // ============================================================================
 
-typedef struct {
-    char *ptr;
+// Frame text arena chunk (see _cr_temp_string_alloc)
+typedef struct CR_ArenaChunk {
+    struct CR_ArenaChunk * $nullable next;
     size_t size;
-} CR_TempString;
+    size_t used;
+    char data[];
+} CR_ArenaChunk;
+
+// Memoized Textf output for one element (see TextParams.memo_id)
+typedef struct {
+    uint32_t key;                   // Element id
+    const char * $nullable fmt;     // Format the text was built from
+    uint64_t arg_hash;              // Hash of the argument values
+    char * $nullable chars;
+    size_t length;
+    size_t capacity;
+    uint64_t last_frame;
+} CR_TextMemo;
+
+// One wrapped Paragraph line: text[start, end)
+typedef struct {
+    uint32_t start;
+    uint32_t end;
+} CR_TextLine;
+
+// Cached line breaks for one Paragraph (see _cr_paragraph_lines)
+typedef struct {
+    uint32_t key;                   // Element id
+    uint64_t text_hash;             // Hash of the text the lines cover
+    size_t text_length;
+    float width;                    // Width the lines were broken at
+    uint64_t font_key;              // Font id, size, spacing and line height
+    CR_TextLine * $nullable lines;
+    size_t line_count;              // 0 = nothing cached
+    size_t line_capacity;
+    uint64_t last_frame;
+} CR_ParagraphLines;
+
+// One saved state from cr_snapshot_restore, waiting for its hook to mount
+typedef struct {
+    uint64_t path;                  // Component path hash (see cr_snapshot_write)
+    uint32_t hook;                  // Hook index within the component
+    uint32_t size;
+    uint64_t type_hash;             // 0 for untyped state
+    const char *name;               // Component name, inside snapshot_data
+    size_t name_length;
+    const uint8_t *value;           // Inside snapshot_data
+    bool applied;
+} CR_SnapshotEntry;
+
+typedef Clay_Dimensions (*CR_MeasureTextFn)(Clay_StringSlice text, Clay_TextElementConfig *config, void *user_data);
+
+/**
+ * Open-addressed uint32 -> uint32 map keyed by Clay element id
+ * (0 marks an empty slot; Clay never hands out id 0)
+ */
+typedef struct {
+    uint32_t * $nullable keys;
+    uint32_t * $nullable values;
+    size_t count;
+    size_t capacity;
+} CR_IdMap;
+
+typedef enum {
+    CR_LISTENER_EVENT = 0,  // OnEventBlock: sees phases, decides propagation
+    CR_LISTENER_CLICK,      // VoidBlock from _cr_register_click
+    CR_LISTENER_HOVER,      // OnHoverBlock
+    CR_LISTENER_SCROLL,     // OnScrollBlock
+    CR_LISTENER_KEY,        // OnKeyBlock
+} CR_ListenerKind;
+
+/**
+ * Listener registered during render. Typed (non-EVENT) listeners run in the
+ * bubble phase and stop propagation once they fire, so the innermost one
+ * handles the event; key listeners only stop it when they set handled.
+ */
+typedef struct {
+    uint32_t element_id;
+    uint32_t next_on_element;       // listeners index + 1 (0 ends the chain)
+    CR_EventType type;
+    CR_ListenerKind kind;
+    bool capture;
+    bool owns_block;                // Click blocks belong to click_handlers
+    void * $nullable block;
+} CR_Listener;
+
+/**
+ * Colors an element swaps between on hover, bound during render so a pointer
+ * move can repaint the cached frame (see cr_paint_frame)
+ */
+typedef struct {
+    uint32_t element_id;
+    int32_t command;                // Rectangle in paint_commands (-1 = none drawn)
+    Clay_Color background;
+    Clay_Color background_hover;
+    bool hovered;                   // Which color paint_commands shows
+} CR_PaintBinding;
+
+/**
+ * A clipped container in the cached frame: the commands between its scissor
+ * pair move with its scroll position (see cr_scroll_frame)
+ */
+typedef struct {
+    uint32_t element_id;
+    int32_t start;                  // SCISSOR_START in paint_commands
+    int32_t end;                    // Matching SCISSOR_END
+    Clay_BoundingBox clip;          // Container box when laid out
+    Clay_Vector2 laid_out;          // Scroll position the layout used
+    Clay_Vector2 shown;             // Scroll position paint_commands show
+    float window_top;               // Content rows laid out (see cr_bind_scroll_window)
+    float window_bottom;
+    bool pinned;                    // Moving it needs a layout
+} CR_ScrollRegion;
+
+// Rows a windowed component laid out, bound during render
+typedef struct {
+    uint32_t clip_id;
+    uint32_t anchor_id;
+    float top;
+    float bottom;
+} CR_ScrollWindow;
 
 typedef struct {
     CR_Component *component;
@@ -303,6 +687,25 @@ typedef struct {
     uint64_t component_id;
 } CR_EffectRef;
 
+/**
+ * Node in the cross-thread post queue (see cr_post)
+ */
+typedef struct CR_PostNode CR_PostNode;
+struct CR_PostNode {
+    _Atomic(CR_PostNode * $nullable) next;
+    VoidBlock $nullable block;
+};
+
+/**
+ * Backend hook used to interrupt a blocking event wait from any thread
+ */
+typedef void (*CR_WakeFn)(void * $nullable user_data);
+
+/**
+ * Monotonic clock in nanoseconds (see cr_set_clock)
+ */
+typedef uint64_t (*CR_ClockFn)(void * $nullable user_data);
+
 struct CR_Runtime {
     CR_Component * $nullable current_component;
     CR_Component * $nullable root;
@@ -319,14 +722,73 @@ struct CR_Runtime {
     size_t click_handler_count;
     size_t click_handler_capacity;
 
+    // Routed listeners (see EVENT ROUTING in clay_react.c)
+    CR_Listener * $nullable listeners;
+    size_t listener_count;
+    size_t listener_capacity;
+    size_t hover_listener_count;
+    CR_IdMap listener_map;          // element id -> first listener + 1
+    CR_IdMap element_parents;       // element id -> enclosing tracked element (0 = top)
+    uint32_t * $nullable element_stack; // Tracked elements open while rendering
+    size_t element_stack_count;
+    size_t element_stack_capacity;
+    uint32_t * $nullable event_path;
+    size_t event_path_capacity;
+    struct {
+        uint32_t * $nullable indices;   // Listener index + 1, in registration order
+        size_t count;
+        size_t capacity;
+    } top_listeners[CR_EVENT_HOVER + 1]; // Per event type, on top-level elements
+    uint32_t focused_element;       // Key event target (0 = root)
+
+    // Pointer tracking (see cr_set_pointer_state)
+    Clay_Vector2 pointer_position;
+    Clay_Vector2 pointer_last_frame;
+    bool pointer_down;
+    bool pointer_moved;             // Moved since the last frame sampled it
+    bool hover_dirty;               // Pointer-over set differs from hover_ids
+
+    // Scroll controller (see cr_update_scroll)
+    Clay_Vector2 scroll_remaining;  // Wheel distance not yet handed to Clay
+    float scroll_rate;              // Approach rate for scroll_remaining (1/s)
+    uint32_t scroll_drag_id;        // Container being dragged or coasting (0 = none)
+    Clay_Vector2 scroll_drag_origin; // Scroll position minus pointer at the press
+    Clay_Vector2 scroll_drag_last;  // Drag position the previous frame saw
+    Clay_Vector2 scroll_velocity;   // Drag speed, then release momentum (px/s)
+    bool scroll_coasting;           // Momentum still moves scroll_drag_id
+    CR_IdMap hover_ids;             // Pointer-over ids sampled at frame start
+    CR_IdMap hover_prev;            // Previous frame's set, for enter/exit
+
     // Memory tracking
     size_t allocated;
     size_t peak_allocated;
 
-    // Frame-scoped text buffers
-    CR_TempString * $nullable temp_strings;
-    size_t temp_string_count;
-    size_t temp_string_capacity;
+    // Frame-scoped text arena, reset (not freed) every frame
+    CR_ArenaChunk * $nullable text_arena;
+    CR_ArenaChunk * $nullable text_arena_top;
+
+    // Memoized Textf output keyed by element id
+    CR_TextMemo * $nullable text_memos;
+    size_t text_memo_count;
+    size_t text_memo_capacity;
+    CR_IdMap text_memo_map;
+
+    // Text measurement shared with Clay (see cr_set_measure_text)
+    CR_MeasureTextFn $nullable measure_text;
+    void * $nullable measure_text_user_data;
+
+    // Cached Paragraph line breaks keyed by element id
+    CR_ParagraphLines * $nullable paragraphs;
+    size_t paragraph_count;
+    size_t paragraph_capacity;
+    CR_IdMap paragraph_map;
+
+    // Snapshot loaded by cr_snapshot_restore, applied as states mount
+    CR_SnapshotEntry * $nullable snapshot_entries;  // Sorted by (path, hook)
+    size_t snapshot_entry_count;
+    uint8_t * $nullable snapshot_data;
+    size_t snapshot_size;
+    uint64_t snapshot_expires;      // Frame after which unmatched entries go
 
     // Component registry
     CR_Component * $nullable * $nullable components;
@@ -345,6 +807,11 @@ struct CR_Runtime {
     CR_EffectRef * $nullable pending_layout_effects;
     size_t pending_layout_effect_count;
     size_t pending_layout_effect_capacity;
+    CR_EffectRef * $nullable pending_idle_effects;
+    size_t pending_idle_effect_count;
+    size_t pending_idle_effect_capacity;
+    bool defer_effects;         // Passive effects wait for cr_flush_effects
+    uint64_t frame_budget_ns;
 
     // Keyed component support
     CR_Id next_key;
@@ -355,9 +822,81 @@ struct CR_Runtime {
 
     // Unique IDs for $use_id
     uint32_t next_uid;
+
+    // Cross-thread update queue (lock-free MPSC, drained in cr_begin_frame)
+    _Atomic(CR_PostNode * $nullable) post_head;
+    CR_PostNode *post_tail;
+    CR_PostNode post_stub;
+    atomic_bool post_pending;
+    CR_WakeFn $nullable wake;
+    void * $nullable wake_user_data;
+
+    // Frame clock
+    CR_ClockFn $nullable clock;
+    void * $nullable clock_user_data;
+    uint64_t frame_time_ns;
+    float frame_delta;
+    uint64_t next_frame_ns;     // Earliest time a hook wants another frame (0 = none)
+    bool animating;             // An animation hook is mid-flight
+
+    // Timer min-heap ordered by deadline
+    CR_TimerInternal * $nullable * $nullable timers;
+    size_t timer_count;
+    size_t timer_capacity;
+
+    // Keep-alive boundaries (see $keep_alive)
+    CR_Component * $nullable * $nullable keep_alive_boundaries;
+    size_t keep_alive_count;
+    size_t keep_alive_capacity;
+    size_t keep_alive_limit;    // Max hidden subtrees retained (0 = unlimited)
+
+    // Released components awaiting free (see _cr_free_graveyard)
+    CR_Component * $nullable * $nullable graveyard;
+    size_t graveyard_count;
+    size_t graveyard_capacity;
+
+    // String intern table (open addressing, see cr_intern)
+    CR_Str * $nullable interned;
+    size_t interned_count;
+    size_t interned_capacity;
+
+    // Paint-only frames (see cr_paint_frame)
+    CR_PaintBinding * $nullable paint_bindings;
+    size_t paint_binding_count;
+    size_t paint_binding_capacity;
+    CR_IdMap paint_map;             // element id -> paint binding + 1
+    Clay_RenderCommandArray paint_commands; // Last full frame's output
+    bool paint_ready;               // paint_commands matches the current tree
+    bool hover_reads;               // Render read hover state outside a binding
+    uint64_t paint_frames;          // Frames served by cr_paint_frame
+
+    // Scroll-only frames (see cr_scroll_frame)
+    CR_ScrollRegion * $nullable scroll_regions;
+    size_t scroll_region_count;
+    size_t scroll_region_capacity;
+    CR_ScrollWindow * $nullable scroll_windows;
+    size_t scroll_window_count;
+    size_t scroll_window_capacity;
+    Clay_BoundingBox scroll_bounds;     // Area laid out: the window plus any overscan
+    bool scroll_overscan;           // This frame culls with a margin for the glide
+    bool scroll_ready;              // scroll_regions describe paint_commands
+    bool scroll_translated;         // paint_commands moved past Clay's layout
+    bool scroll_unbound;            // Render windowed rows no binding describes
+    bool scroll_gliding;            // A wheel glide wants the next frame
+    uint64_t scroll_frames;         // Frames served by cr_scroll_frame
+
+    // Focused text input (only one at a time per runtime)
+    CR_TextInputState * $nullable focused_input;
+    uint64_t next_component_id;
+
+    // Clay context this runtime lays out into (see cr_runtime_make_current)
+    Clay_Context * $nullable clay_context;
+    void * $nullable clay_memory;   // Arena behind clay_context when owned
+    bool owns_clay_context;
 };
 
-extern CR_Runtime * $nullable cr_runtime;
+// Runtime of the calling thread (see cr_runtime_make_current)
+extern _Thread_local CR_Runtime * $nullable cr_runtime;
 
 // ============================================================================
 // INITIALIZATION
@@ -370,6 +909,117 @@ Clay_RenderCommandArray cr_end_frame(void);
 bool cr_should_render(void);
 void cr_request_render(void);
 
+/**
+ * Runtime instances
+ *
+ * Every cr_* call works on the calling thread's current runtime. cr_init
+ * creates one around whatever Clay context is current; cr_runtime_create
+ * builds a runtime with its own Clay context and arena, and
+ * cr_runtime_make_current switches both the runtime and Clay's current
+ * context (returning the previous runtime). Runtimes may live on different
+ * threads, but Clay keeps its current context, measure text function and
+ * scroll offset function in process globals, so only one thread may lay
+ * out at a time: hold a shared lock around each frame (and any other Clay
+ * call), and call cr_runtime_make_current after taking it to point Clay
+ * back at this thread's runtime. A runtime must only be current on one
+ * thread at once; other threads hand it work with cr_post_to (cr_post only
+ * reaches the calling thread's own runtime). Install the same measure text
+ * function everywhere (user data is per context).
+ *
+ * Across threads, $id_lit and $style are safe: they cache per call site and
+ * thread. $signal is not: its first evaluation and its set/subscribe are
+ * unsynchronised, so create signals before other threads use them and
+ * change them from one thread (posting to it from the rest).
+ *
+ * Usage:
+ *   CR_Runtime *panel = cr_runtime_create(size, errors);
+ *   CR_Runtime *previous = cr_runtime_make_current(panel);
+ *   cr_begin_frame();
+ *   Panel();
+ *   Clay_RenderCommandArray commands = cr_end_frame();
+ *   cr_runtime_make_current(previous);
+ *
+ *   // A runtime on its own thread
+ *   pthread_mutex_lock(&layout_lock);
+ *   cr_runtime_make_current(panel);
+ *   cr_begin_frame();
+ *   Panel();
+ *   commands = cr_end_frame();
+ *   pthread_mutex_unlock(&layout_lock);
+ */
+CR_Runtime * $nullable cr_runtime_create(Clay_Dimensions dimensions, Clay_ErrorHandler error_handler);
+CR_Runtime * $nullable cr_runtime_make_current(CR_Runtime * $nullable runtime);
+CR_Runtime * $nullable cr_runtime_current(void);
+void cr_runtime_destroy(CR_Runtime * $nullable runtime);
+
+/**
+ * State snapshots
+ *
+ * cr_snapshot_write saves the value of every mounted $use_typed_state,
+ * keyed by the component's path (names, keys and child slots from the root)
+ * and its hook index, to a compact binary file in native byte order. Call
+ * cr_snapshot_restore before the first frame: each state then starts from
+ * its saved value when the same path mounts it, and unmatched entries are
+ * dropped after a couple of seconds of frames.
+ *
+ * Restored values must match the saved type hash, and types that hold
+ * pointers are never saved. Plain $use_state carries no type to check, so
+ * it is never saved and always starts from its initial value.
+ */
+bool cr_snapshot_write(const char *path);
+bool cr_snapshot_restore(const char *path);
+
+/**
+ * cr_post_to - Run a block on a runtime's thread at the start of its next frame
+ *
+ * Safe to call from any thread; take the runtime from cr_runtime_current on
+ * the thread that renders it. Posted blocks run in submission order inside
+ * cr_begin_frame, before any component renders, so state they set is visible
+ * in that same frame. Only the first post after a drain invokes the wake
+ * handler, so bursts of posts cost one backend wakeup. cr_post is the
+ * shorthand for the calling thread's current runtime, which worker threads
+ * do not have.
+ *
+ * Usage:
+ *   CR_Runtime *ui = cr_runtime_current();         // On the UI thread
+ *   cr_post_to(ui, ^{ samples->set(latest); });    // From a worker
+ */
+bool cr_post_to(CR_Runtime * $nullable runtime, VoidBlock block);
+bool cr_post(VoidBlock block);
+void cr_set_wake_handler(CR_WakeFn $nullable wake, void * $nullable user_data);
+
+/**
+ * Frame clock and scheduling
+ *
+ * cr_begin_frame samples the clock once; hooks read that timestamp so every
+ * component in a frame sees the same time. Backends use cr_wait_timeout_ms as
+ * the timeout for their blocking event wait: 0 means render now, -1 means
+ * nothing is scheduled and the loop may sleep until input arrives.
+ */
+void cr_set_clock(CR_ClockFn $nullable clock, void * $nullable user_data);
+uint64_t cr_now_ns(void);
+double cr_frame_time(void);
+float cr_frame_delta(void);
+void cr_request_frame_at(uint64_t time_ns);
+bool cr_is_animating(void);
+int cr_wait_timeout_ms(void);
+
+/**
+ * Effect scheduling
+ *
+ * With deferral enabled, cr_end_frame only runs layout effects; backends call
+ * cr_flush_effects after presenting, and any leftovers run at the start of
+ * the next cr_begin_frame. Idle effects run from cr_run_idle_effects, which
+ * stops once budget_ns is spent and reports whether work remains.
+ */
+void cr_set_effect_deferral(bool deferred);
+void cr_flush_effects(void);
+void cr_set_frame_budget(uint64_t budget_ns);
+uint64_t cr_frame_budget_ns(void);
+uint64_t cr_frame_headroom_ns(void);
+bool cr_has_idle_work(void);
+bool cr_run_idle_effects(uint64_t budget_ns);
+
 // ============================================================================
 // STATE IMPLEMENTATION
 // ============================================================================
@@ -378,6 +1028,15 @@ struct CR_StateInternal {
     void *value;
     size_t size;
     uint64_t version;
+    struct Type type;           // From $use_typed_state (hash 0 = untyped)
+    CR_Runtime * $nullable runtime; // Owner; set() marks it for render
+};
+
+struct CR_TimerInternal {
+    VoidBlock $nullable callback;
+    uint64_t deadline_ns;
+    uint64_t interval_ns;       // 0 for one-shot timers
+    size_t heap_index;          // Position in cr_runtime->timers, SIZE_MAX when idle
 };
 
 typedef enum {
@@ -390,6 +1049,8 @@ typedef enum {
     CR_HOOK_CALLBACK,
     CR_HOOK_ID,
     CR_HOOK_SIGNAL,
+    CR_HOOK_ANIMATION,
+    CR_HOOK_TIMER,
 } CR_HookType;
 
 typedef struct {
@@ -419,6 +1080,12 @@ typedef struct CR_EffectInternal {
     CleanupBlock $nullable cleanup;
 } CR_EffectInternal;
 
+typedef enum {
+    CR_EFFECT_PASSIVE = 0,  // After the frame is presented
+    CR_EFFECT_LAYOUT,       // Synchronously in cr_end_frame
+    CR_EFFECT_IDLE,         // Only while the frame budget has headroom
+} CR_EffectKind;
+
 struct CR_Hook {
     int type;
     bool deps_initialized;
@@ -447,10 +1114,13 @@ struct CR_Hook {
         } callback;
         struct {
             CR_EffectInternal effect;
-            bool is_layout;
+            CR_EffectKind kind;
+            bool queued;
         } effect;
         struct {
             uint32_t id;
+            uint32_t hash;
+            uint32_t length;
             bool initialized;
         } uid;
         struct {
@@ -458,10 +1128,24 @@ struct CR_Hook {
             void * $nullable handle;
             size_t handle_size;
         } signal;
+        struct {
+            float from;
+            float to;
+            float value;
+            float velocity;
+            uint64_t start_ns;
+            bool initialized;
+            bool active;
+        } anim;
+        struct {
+            CR_TimerInternal * $nullable timer;
+            int64_t ms;
+        } timer;
     };
 };
 
 CR_StateInternal * $nullable _cr_alloc_state(size_t size, void *initial);
+CR_StateInternal * $nullable _cr_alloc_typed_state(size_t size, void *initial, struct Type type);
 void * $nullable _cr_state_get(CR_StateInternal * $nullable state);
 void _cr_state_set(CR_StateInternal * $nullable state, void * $nullable value);
 bool _cr_state_set_if_changed(CR_StateInternal * $nullable state, void * $nullable value);
@@ -469,8 +1153,10 @@ CR_Hook * $nullable _cr_use_hook(int type);
 bool _cr_deps_should_run(CR_Hook * $nullable hook, CR_DepList deps);
 void _cr_deps_store(CR_Hook * $nullable hook, CR_DepList deps);
 void _cr_schedule_render(void);
+void _cr_schedule_state_render(CR_StateInternal *state);
 uint32_t _cr_next_uid(void);
-void _cr_use_effect_impl(EffectBlock $nullable effect, CR_DepList deps, bool is_layout);
+void _cr_use_effect_impl(EffectBlock $nullable effect, CR_DepList deps, CR_EffectKind kind);
+void _cr_use_timer(VoidBlock $nullable callback, int64_t ms, bool repeat);
 
 #define $dep(value) \
     ((CR_Dep){ .ptr = &(typeof(value)){ (value) }, .size = sizeof(value) })
@@ -513,16 +1199,15 @@ void _cr_use_effect_impl(EffectBlock $nullable effect, CR_DepList deps, bool is_
  *   auto person = $use_state(((Person){ .name = "John", .age = 30 }));
  *   person->ptr->age = 31;  // Direct access via ptr
  */
-#define $use_state(...) \
+#define _CR_USE_STATE_IMPL(T, type, ...) \
     ({ \
-        typedef typeof(__VA_ARGS__) T; \
         typedef CR_STATE_HANDLE(T) CR_StateHandle_T; \
         CR_StateHandle_T *_result = NULL; \
         CR_Hook *_hook = _cr_use_hook(CR_HOOK_STATE); \
         if (_hook) { \
             if (!_hook->state.state) { \
                 T _init = (__VA_ARGS__); \
-                _hook->state.state = _cr_alloc_state(sizeof(T), &_init); \
+                _hook->state.state = _cr_alloc_typed_state(sizeof(T), &_init, type); \
             } \
             if (!_hook->state.handle) { \
                 _hook->state.handle_size = sizeof(CR_StateHandle_T); \
@@ -535,7 +1220,7 @@ void _cr_use_effect_impl(EffectBlock $nullable effect, CR_DepList deps, bool is_
                 _handle->get = Block_copy(^T{ return *(T *)_state->value; }); \
                 _handle->set = Block_copy(^(T value){ \
                     if (_cr_state_set_if_changed(_state, &value)) { \
-                        _cr_schedule_render(); \
+                        _cr_schedule_state_render(_state); \
                     } \
                 }); \
             } \
@@ -543,6 +1228,23 @@ void _cr_use_effect_impl(EffectBlock $nullable effect, CR_DepList deps, bool is_
         } \
         _result; \
     })
+#define $use_state(...) \
+    ({ \
+        typedef typeof(__VA_ARGS__) _CR_StateValue; \
+        _CR_USE_STATE_IMPL(_CR_StateValue, (struct Type){0}, __VA_ARGS__); \
+    })
+
+/**
+ * $use_typed_state - $use_state that carries its $reflect type
+ *
+ * Snapshots check the type hash before restoring the value, so a layout
+ * change between builds falls back to the initial value.
+ *
+ * Usage:
+ *   auto settings = $use_typed_state(Settings, ((Settings){ .volume = 5 }));
+ */
+#define $use_typed_state(T, ...) \
+    _CR_USE_STATE_IMPL(T, $reflect(T), __VA_ARGS__)
 
 // ============================================================================
 // REF IMPLEMENTATION
@@ -603,19 +1305,58 @@ void _cr_run_effect(CR_EffectInternal *effect);
  *   }, $deps_once());
  */
 #define _CR_USE_EFFECT_1(effect_block) \
-    _cr_use_effect_impl((EffectBlock)effect_block, $deps_none(), false)
+    _cr_use_effect_impl((EffectBlock)effect_block, $deps_none(), CR_EFFECT_PASSIVE)
 #define _CR_USE_EFFECT_2(effect_block, deps) \
-    _cr_use_effect_impl((EffectBlock)effect_block, deps, false)
+    _cr_use_effect_impl((EffectBlock)effect_block, deps, CR_EFFECT_PASSIVE)
 #define $use_effect(...) \
     _CR_GET_MACRO(__VA_ARGS__, _CR_USE_EFFECT_2, _CR_USE_EFFECT_1)(__VA_ARGS__)
 
 #define _CR_USE_LAYOUT_EFFECT_1(effect_block) \
-    _cr_use_effect_impl((EffectBlock)effect_block, $deps_none(), true)
+    _cr_use_effect_impl((EffectBlock)effect_block, $deps_none(), CR_EFFECT_LAYOUT)
 #define _CR_USE_LAYOUT_EFFECT_2(effect_block, deps) \
-    _cr_use_effect_impl((EffectBlock)effect_block, deps, true)
+    _cr_use_effect_impl((EffectBlock)effect_block, deps, CR_EFFECT_LAYOUT)
 #define $use_layout_effect(...) \
     _CR_GET_MACRO(__VA_ARGS__, _CR_USE_LAYOUT_EFFECT_2, _CR_USE_LAYOUT_EFFECT_1)(__VA_ARGS__)
 
+/**
+ * $use_idle_effect - Effects that may wait for spare frame time
+ *
+ * Queued like $use_effect but only run by cr_run_idle_effects while the
+ * frame budget has headroom; the rest carry over to the next idle slot.
+ *
+ * Usage:
+ *   $use_idle_effect(^{
+ *       autosave(document);
+ *       return (CleanupBlock)NULL;
+ *   }, $deps(document->version));
+ */
+#define _CR_USE_IDLE_EFFECT_1(effect_block) \
+    _cr_use_effect_impl((EffectBlock)effect_block, $deps_none(), CR_EFFECT_IDLE)
+#define _CR_USE_IDLE_EFFECT_2(effect_block, deps) \
+    _cr_use_effect_impl((EffectBlock)effect_block, deps, CR_EFFECT_IDLE)
+#define $use_idle_effect(...) \
+    _CR_GET_MACRO(__VA_ARGS__, _CR_USE_IDLE_EFFECT_2, _CR_USE_IDLE_EFFECT_1)(__VA_ARGS__)
+
+// ============================================================================
+// TIMER IMPLEMENTATION
+// ============================================================================
+
+/**
+ * $use_timeout / $use_interval - Deadline-driven callbacks
+ *
+ * Deadlines live in a runtime min-heap and due timers fire at the start of
+ * cr_begin_frame, so the backend sleeps until the earliest one. The latest
+ * callback is always used; changing ms restarts the timer and a negative ms
+ * pauses it.
+ *
+ * Usage:
+ *   $use_interval(^{ refresh->set(refresh->get() + 1); }, 1000);
+ */
+#define $use_timeout(callback_block, ms) \
+    _cr_use_timer((VoidBlock)callback_block, (int64_t)(ms), false)
+#define $use_interval(callback_block, ms) \
+    _cr_use_timer((VoidBlock)callback_block, (int64_t)(ms), true)
+
 // ============================================================================
 // MEMO IMPLEMENTATION
 // ============================================================================
@@ -704,10 +1445,19 @@ void _cr_run_effect(CR_EffectInternal *effect);
         CR_Hook *_hook = _cr_use_hook(CR_HOOK_ID); \
         if (_hook) { \
             if (!_hook->uid.initialized) { \
+                CR_Id _hashed = cr_id_hashed(prefix); \
                 _hook->uid.id = _cr_next_uid(); \
+                _hook->uid.hash = _hashed.hash; \
+                _hook->uid.length = _hashed.length; \
                 _hook->uid.initialized = true; \
             } \
-            _result = cr_idi(prefix, _hook->uid.id); \
+            _result = (CR_Id){ \
+                .name = prefix, \
+                .index = _hook->uid.id, \
+                .indexed = true, \
+                .length = _hook->uid.length, \
+                .hash = _hook->uid.hash, \
+            }; \
         } \
         _result; \
     })
@@ -772,9 +1522,139 @@ bool _cr_signal_set_if_changed(CR_SignalInternal * $nullable signal, void * $nul
 // ============================================================================
 
 void _cr_register_click(uint32_t element_id, VoidBlock $nullable handler);
+void _cr_register_hover(uint32_t element_id, OnHoverBlock $nullable handler);
+void _cr_register_scroll(uint32_t element_id, OnScrollBlock $nullable handler);
+void _cr_register_key(uint32_t element_id, OnKeyBlock $nullable handler);
+void _cr_add_listener(uint32_t element_id, CR_EventType type, bool capture, OnEventBlock $nullable handler);
+void _cr_element_open(uint32_t element_id);
+void _cr_element_close(void);
 void _cr_dispatch_clicks(void);
+void _cr_update_hover(void);
+void _cr_step_scroll(void);
+void _cr_glide_scroll(float dt);
 void _cr_clear_handlers(void);
 
+/**
+ * cr_set_pointer_state - Forward pointer input to Clay and track movement
+ *
+ * Backends call this instead of Clay_SetPointerState so hover events can
+ * report deltas and a moving pointer wakes frames that have hover handlers.
+ * Pressing over a scroll container drags it; on release it coasts with the
+ * drag's speed, decaying with elapsed time rather than per frame.
+ */
+void cr_set_pointer_state(Clay_Vector2 position, bool pointer_down);
+
+/**
+ * cr_update_scroll - Route a wheel delta, then queue it for smooth scrolling
+ *
+ * The delta goes to the innermost element under the pointer that registered
+ * an OnScrollBlock. Clay's containers then glide over the next frames, using
+ * the real frame delta; delta_time is how long the input took to produce
+ * (the gap since the previous wheel event) and sets the glide length.
+ * Deltas are in Clay_UpdateScrollContainers' units: each moves 10 pixels.
+ */
+void cr_update_scroll(Clay_Vector2 delta, float delta_time);
+
+/**
+ * cr_is_hovered - O(1) pointer-over test against the set sampled at frame start
+ */
+bool cr_is_hovered(Clay_ElementId element_id);
+
+/**
+ * cr_paint_frame - Repaint the last frame without rendering or layout
+ *
+ * When the only pending change is the pointer-over set and every element
+ * that reacts to it does so through a background_hover style, the hover
+ * backgrounds are patched into the previous frame's render commands and
+ * hover listeners run as usual. Returns false (and changes nothing visible)
+ * when a full cr_begin_frame/cr_end_frame is needed: state changes, posts,
+ * timers, scrolling, drags, or renders that read $hovered()/cr_is_hovered
+ * themselves.
+ *
+ * Usage:
+ *   Clay_RenderCommandArray commands;
+ *   if (!cr_paint_frame(&commands)) {
+ *       cr_begin_frame();
+ *       App();
+ *       commands = cr_end_frame();
+ *   }
+ */
+bool cr_paint_frame(Clay_RenderCommandArray *commands);
+
+/**
+ * cr_last_frame - The last frame's commands, if nothing since needs a new one
+ *
+ * Returns false while cr_should_render() wants a frame (input, posts,
+ * timers, hover, animation) or before the first full frame. Backends use it
+ * to redraw without layout, e.g. stretched over a window whose new size is
+ * not laid out yet.
+ */
+bool cr_last_frame(Clay_RenderCommandArray *commands);
+bool _cr_bind_hover_paint(uint32_t element_id, Clay_Color background, Clay_Color background_hover);
+bool _cr_hovered(void);
+
+/**
+ * cr_scroll_frame - Advance a wheel glide by moving the last frame's commands
+ *
+ * When the only pending work is a wheel glide, the step is applied to the
+ * scroll container and the commands between its scissor pair are translated
+ * by the offset change. Falls back (returns false, after requesting a full
+ * frame) when the move would expose content the cached frame lacks: Clay
+ * culls against the window, and windowed components only lay out the rows
+ * they bound with cr_bind_scroll_window. Full frames laid out mid-glide keep
+ * half a window of content beyond each edge, so containers taller than the
+ * window keep gliding without layouts. Drags, release momentum, state
+ * changes, posts, timers and animations always take full frames; hover
+ * updates wait for the full frame that ends the glide.
+ *
+ * Usage:
+ *   Clay_RenderCommandArray commands;
+ *   if (!cr_paint_frame(&commands) && !cr_scroll_frame(&commands)) {
+ *       cr_begin_frame();
+ *       App();
+ *       commands = cr_end_frame();
+ *   }
+ */
+bool cr_scroll_frame(Clay_RenderCommandArray *commands);
+
+/**
+ * cr_layout_translated - Whether Clay's layout lags the commands on screen
+ *
+ * True after cr_scroll_frame until the next full frame. Clay still hit-tests
+ * against the untranslated layout, so backends lay out again before
+ * dispatching a press.
+ */
+bool cr_layout_translated(void);
+
+/**
+ * cr_bind_scroll_window - Declare the rows a windowed component laid out
+ *
+ * Call while rendering from components that only lay out what the viewport
+ * shows. [top, bottom) is measured from anchor_id's top edge, or from
+ * clip_id's content origin (its top edge at scroll offset 0) when anchor_id
+ * is zero; pass -INFINITY/INFINITY for an end that reaches the content edge.
+ * cr_scroll_frame only translates clip_id while its viewport stays inside
+ * the span. A zero clip_id means the window: any scroll container showing
+ * the anchor then takes full frames, and with no anchor either, all do.
+ */
+void cr_bind_scroll_window(Clay_ElementId clip_id, Clay_ElementId anchor_id, float top, float bottom);
+
+/**
+ * cr_dispatch_key - Route a key event from the focused element to the root
+ *
+ * Only listeners on the focused element and its ancestors run; with no
+ * focus, those on top-level elements do. Returns true if a listener stopped
+ * propagation or marked the key handled; otherwise the focused text input
+ * (if any) applies its default editing.
+ */
+bool cr_dispatch_key(KeyEvent event);
+
+/**
+ * cr_set_focus - Make an element the target of key events (0 id = root)
+ */
+void cr_set_focus(Clay_ElementId element_id);
+uint32_t cr_focused_element(void);
+
 /**
  * $on_click - Register click handler for an element
  *
@@ -788,9 +1668,49 @@ void _cr_clear_handlers(void);
     _cr_register_click((element_id).id, Block_copy(handler_block))
 
 /**
- * $on_hover - Check hover state (use in conditionals)
+ * $on_hover - Receive enter/exit/move events for an element
+ *
+ * Usage:
+ *   $on_hover(row_id, ^(HoverEvent *event) { set_highlight(event->entered); });
+ */
+#define $on_hover(element_id, handler_block) \
+    _cr_register_hover((element_id).id, Block_copy(handler_block))
+
+/**
+ * $on_scroll - Receive wheel deltas while the pointer is over an element
  */
-#define $hovered() Clay_Hovered()
+#define $on_scroll(element_id, handler_block) \
+    _cr_register_scroll((element_id).id, Block_copy(handler_block))
+
+/**
+ * $on_key - Handle keys while the element or a descendant has focus
+ *
+ * Set event->handled to keep the key from outer handlers and from text
+ * editing. Register on the root's element for window-wide shortcuts.
+ */
+#define $on_key(element_id, handler_block) \
+    _cr_register_key((element_id).id, Block_copy(handler_block))
+
+/**
+ * $on_event / $on_event_capture - Routed listener with phase control
+ *
+ * Usage:
+ *   $on_event_capture(list_id, CR_EVENT_KEY, ^(CR_Event *event) {
+ *       if (event->key.keycode == 27) { close_menu(); cr_stop_propagation(event); }
+ *   });
+ */
+#define $on_event(element_id, type, handler_block) \
+    _cr_add_listener((element_id).id, (type), false, Block_copy(handler_block))
+#define $on_event_capture(element_id, type, handler_block) \
+    _cr_add_listener((element_id).id, (type), true, Block_copy(handler_block))
+
+/**
+ * $hovered - Check hover state of the open element (use in conditionals)
+ *
+ * Frames that read it always render in full on hover changes; prefer
+ * background_hover where a color swap is all that changes.
+ */
+#define $hovered() _cr_hovered()
 
 /**
  * $hover_style - Conditional style based on hover
@@ -862,6 +1782,8 @@ typedef struct {
     VoidBlock $nullable on_click;
     ViewStyle style;
     TextConfig text;
+    CR_Str label_str;   // Takes precedence over label when set
+    const CR_Style * $nullable compiled;
 } ButtonParams;
 
 typedef struct {
@@ -870,6 +1792,8 @@ typedef struct {
     VoidBlock $nullable on_click;
     ViewStyle style;
     TextConfig text;
+    CR_Str icon_str;    // Takes precedence over icon when set
+    const CR_Style * $nullable compiled;
 } IconButtonParams;
 
 typedef struct {
@@ -886,8 +1810,19 @@ typedef struct {
     bool border_width_set;
     const char * $nullable checkmark;
     TextConfig checkmark_text;
+    CR_Str checkmark_str;
 } CheckboxParams;
 
+typedef struct {
+    CR_Id id;
+    CR_TextInputState * $nullable state;
+    ViewStyle style;
+    Clay_BorderElementConfig focus_border;
+    bool has_focus_border;
+    TextConfig text;                    // wrap_mode is ignored; lines never wrap
+    const CR_Style * $nullable compiled;
+} TextAreaParams;
+
 typedef struct {
     CR_Id id;
     CR_TextInputState * $nullable state;
@@ -897,6 +1832,8 @@ typedef struct {
     const char * $nullable placeholder;
     TextConfig text;
     TextConfig placeholder_text;
+    CR_Str placeholder_str;
+    const CR_Style * $nullable compiled;
 } TextInputParams;
 
 // ============================================================================
@@ -912,10 +1849,57 @@ static $always_inline Clay_String cr_string(const char * $nullable text) {
     };
 }
 
+static $always_inline Clay_String cr_clay_string(CR_Str str) {
+    if (!str.chars) return CLAY_STRING("");
+    return (Clay_String){
+        .isStaticallyAllocated = str.is_static,
+        .length = (int32_t)str.length,
+        .chars = str.chars,
+    };
+}
+
+// Prefer the CR_Str field of a params struct, falling back to its C string
+static $always_inline Clay_String _cr_params_string(CR_Str str, const char * $nullable text) {
+    return str.chars ? cr_clay_string(str) : cr_string(text);
+}
+
+/**
+ * cr_element_id - Clay element id for a CR_Id
+ *
+ * Finishes Clay's CLAY_SID/CLAY_SIDI hash from the precomputed accumulator,
+ * so hashed ids cost a handful of shifts instead of a pass over the name.
+ */
 static $always_inline Clay_ElementId cr_element_id(CR_Id id) {
     if (!id.name) return (Clay_ElementId){0};
-    Clay_String name = cr_string(id.name);
-    return id.indexed ? CLAY_SIDI(name, id.index) : CLAY_SID(name);
+    if (!cr_id_is_hashed(id)) {
+        CR_Id hashed = cr_id_hashed($cast_nonnull(id.name));
+        id.length = hashed.length;
+        id.hash = hashed.hash;
+    }
+    Clay_String name = {
+        .isStaticallyAllocated = false,
+        .length = (int32_t)id.length,
+        .chars = $cast_nonnull(id.name),
+    };
+
+    uint32_t base = id.hash;
+    if (!id.indexed) {
+        base += (base << 3);
+        base ^= (base >> 11);
+        base += (base << 15);
+        return (Clay_ElementId){ .id = base + 1, .offset = 0, .baseId = base + 1, .stringId = name };
+    }
+
+    uint32_t hash = base + id.index;
+    hash += (hash << 10);
+    hash ^= (hash >> 6);
+    hash += (hash << 3);
+    base += (base << 3);
+    hash ^= (hash >> 11);
+    base ^= (base >> 11);
+    hash += (hash << 15);
+    base += (base << 15);
+    return (Clay_ElementId){ .id = hash + 1, .offset = id.index, .baseId = base + 1, .stringId = name };
 }
 
 static $always_inline bool _cr_border_has_value(Clay_BorderElementConfig border) {
@@ -978,29 +1962,228 @@ static $always_inline void _cr_apply_view_style(Clay_ElementDeclaration *decl, V
     }
 }
 
+// ============================================================================
+// COMPILED STYLES
+// ============================================================================
+
 /**
- * Box - Generic container
+ * Which component's defaults a style is resolved against
  */
-static $always_inline void Box(BoxParams params, VoidBlock $nullable children) {
+typedef enum {
+    CR_STYLE_BOX = 0,
+    CR_STYLE_ROW,
+    CR_STYLE_COLUMN,
+    CR_STYLE_CARD,
+    CR_STYLE_BUTTON,
+    CR_STYLE_ICON_BUTTON,
+    CR_STYLE_TEXT_INPUT,
+    CR_STYLE_TEXT_AREA,
+} CR_StyleKind;
+
+/**
+ * CR_Style - ViewStyle plus component defaults resolved into a declaration
+ *
+ * Components copy the template and only patch the element id and the hover
+ * background, skipping default resolution entirely.
+ */
+struct CR_Style {
+    Clay_ElementDeclaration decl;
+    Clay_Color background_hover;
+    bool has_background_hover;
+};
+
+static $always_inline ViewStyle _cr_style_with_defaults(CR_StyleKind kind, ViewStyle style) {
+    switch (kind) {
+        case CR_STYLE_ROW:
+            style.layout.layoutDirection = CLAY_LEFT_TO_RIGHT;
+            break;
+        case CR_STYLE_COLUMN:
+            style.layout.layoutDirection = CLAY_TOP_TO_BOTTOM;
+            break;
+        case CR_STYLE_CARD:
+            if (_cr_layout_is_zero(style.layout)) {
+                style.layout.padding = $pad(16);
+            }
+            if (!_cr_style_has_corner(style)) {
+                style.corner_radius = $radius(12);
+                style.has_corner_radius = true;
+            }
+            if (!_cr_style_has_background(style)) {
+                style.background = $WHITE;
+                style.has_background = true;
+            }
+            break;
+        case CR_STYLE_BUTTON:
+            if (_cr_layout_is_zero(style.layout)) {
+                style.layout = (Clay_LayoutConfig){
+                    .padding = { 16, 16, 10, 10 },
+                    .childAlignment = { .x = CLAY_ALIGN_X_CENTER, .y = CLAY_ALIGN_Y_CENTER },
+                };
+            }
+            if (!_cr_style_has_corner(style)) {
+                style.corner_radius = CLAY_CORNER_RADIUS(6);
+                style.has_corner_radius = true;
+            }
+            if (!_cr_style_has_background(style)) {
+                style.background = $BLUE;
+                style.has_background = true;
+            }
+            break;
+        case CR_STYLE_ICON_BUTTON:
+            if (_cr_layout_is_zero(style.layout)) {
+                style.layout = (Clay_LayoutConfig){
+                    .sizing = { .width = CLAY_SIZING_FIXED(28), .height = CLAY_SIZING_FIXED(28) },
+                    .childAlignment = { .x = CLAY_ALIGN_X_CENTER, .y = CLAY_ALIGN_Y_CENTER },
+                };
+            }
+            if (!_cr_style_has_corner(style)) {
+                style.corner_radius = CLAY_CORNER_RADIUS(4);
+                style.has_corner_radius = true;
+            }
+            if (!_cr_style_has_background(style)) {
+                style.background = $BLUE;
+                style.has_background = true;
+            }
+            break;
+        case CR_STYLE_TEXT_INPUT:
+        case CR_STYLE_TEXT_AREA:
+            if (_cr_layout_is_zero(style.layout)) {
+                style.layout = kind == CR_STYLE_TEXT_AREA ?
+                    (Clay_LayoutConfig){
+                        .sizing = { .width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_GROW(.min = 120) },
+                        .padding = { 12, 12, 10, 10 },
+                    } :
+                    (Clay_LayoutConfig){
+                        .sizing = { .width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_FIT(.min = 40) },
+                        .padding = { 12, 12, 10, 10 },
+                        .childAlignment = { .y = CLAY_ALIGN_Y_CENTER },
+                    };
+            }
+            if (!_cr_style_has_background(style)) {
+                style.background = $WHITE;
+                style.has_background = true;
+            }
+            if (!_cr_style_has_corner(style)) {
+                style.corner_radius = CLAY_CORNER_RADIUS(6);
+                style.has_corner_radius = true;
+            }
+            if (!_cr_style_has_border(style)) {
+                style.border = (Clay_BorderElementConfig){ .width = CLAY_BORDER_OUTSIDE(1), .color = $gray(200) };
+                style.has_border = true;
+            }
+            break;
+        case CR_STYLE_BOX:
+        default:
+            break;
+    }
+    return style;
+}
+
+/**
+ * cr_style_compile - Resolve a ViewStyle against a component's defaults
+ *
+ * Use directly when the style depends on runtime values (e.g. inside
+ * $use_memo keyed on the theme); $style caches constant styles per call site.
+ */
+static $always_inline CR_Style cr_style_compile(CR_StyleKind kind, ViewStyle style) {
+    style = _cr_style_with_defaults(kind, style);
+    CR_Style compiled = {0};
+    _cr_apply_view_style(&compiled.decl, style, false);
+    compiled.has_background_hover = _cr_style_has_background_hover(style);
+    compiled.background_hover = style.background_hover;
+    return compiled;
+}
+
+// Per-instance declaration: template + id + hover background
+static $always_inline Clay_ElementDeclaration _cr_style_instance(const CR_Style *style, Clay_ElementId eid, bool hovered) {
+    Clay_ElementDeclaration decl = style->decl;
+    decl.id = eid;
+    if (style->has_background_hover && hovered) {
+        decl.backgroundColor = style->background_hover;
+    }
+    return decl;
+}
+
+// Binds the two backgrounds to the element so hover changes can repaint it
+static $always_inline bool _cr_style_pointer_over(const CR_Style *style, Clay_ElementId eid) {
+    if (!style->has_background_hover || eid.id == 0) return false;
+    return _cr_bind_hover_paint(eid.id, style->decl.backgroundColor, style->background_hover);
+}
+
+/**
+ * $style - Compile a constant style once per call site
+ *
+ * The arguments are ViewStyle designated initialisers and are evaluated only
+ * on first use, so they must not depend on per-frame values.
+ *
+ * Usage:
+ *   Button((ButtonParams){
+ *       .compiled = $style(CR_STYLE_BUTTON, .background = $GREEN, .background_hover = $gray(90)),
+ *       .label_str = $lit("Save"),
+ *   }, NULL);
+ */
+#define $style(kind, ...) \
+    ({ \
+        static _Thread_local CR_Style _cr_static_style; \
+        static _Thread_local bool _cr_static_style_ready = false; \
+        if (!_cr_static_style_ready) { \
+            _cr_static_style = cr_style_compile((kind), (ViewStyle){ __VA_ARGS__ }); \
+            _cr_static_style_ready = true; \
+        } \
+        (const CR_Style *)&_cr_static_style; \
+    })
+
+// Layout a wrapper (Row, Column, Center) forces on top of any style,
+// including a compiled one
+typedef struct {
+    bool set_direction;
+    Clay_LayoutDirection direction;
+    bool center;
+} CR_BoxLayout;
+
+static $always_inline void _cr_box(BoxParams params, VoidBlock $nullable children, CR_BoxLayout layout) {
     Clay_ElementId eid = cr_element_id(params.id);
     if (params.on_click && eid.id != 0) {
         _cr_register_click(eid.id, Block_copy(params.on_click));
     }
+    if (params.on_hover && eid.id != 0) {
+        _cr_register_hover(eid.id, Block_copy(params.on_hover));
+    }
+    if (params.on_scroll && eid.id != 0) {
+        _cr_register_scroll(eid.id, Block_copy(params.on_scroll));
+    }
+    if (params.on_key && eid.id != 0) {
+        _cr_register_key(eid.id, Block_copy(params.on_key));
+    }
+
+    CR_Style resolved;
+    const CR_Style *style = params.compiled;
+    if (!style) {
+        resolved = cr_style_compile(CR_STYLE_BOX, params.style);
+        style = &resolved;
+    }
 
-    bool wants_hover = _cr_style_has_background_hover(params.style);
+    bool wants_hover = style->has_background_hover;
     bool hovered = false;
     bool opened = false;
     if (wants_hover && eid.id == 0) {
         Clay__OpenElement();
         opened = true;
-        hovered = Clay_Hovered();
+        hovered = _cr_hovered();
     } else if (wants_hover && eid.id != 0) {
-        hovered = Clay_PointerOver(eid);
+        hovered = _cr_style_pointer_over(style, eid);
     }
 
-    Clay_ElementDeclaration decl = {0};
-    decl.id = eid;
-    _cr_apply_view_style(&decl, params.style, hovered);
+    Clay_ElementDeclaration decl = _cr_style_instance(style, eid, hovered);
+    if (layout.set_direction) {
+        decl.layout.layoutDirection = layout.direction;
+    }
+    if (layout.center) {
+        decl.layout.childAlignment = (Clay_ChildAlignment){
+            .x = CLAY_ALIGN_X_CENTER,
+            .y = CLAY_ALIGN_Y_CENTER,
+        };
+    }
     if (params.scroll_x || params.scroll_y) {
         decl.clip = (Clay_ClipElementConfig){
             .horizontal = params.scroll_x,
@@ -1013,35 +2196,38 @@ static $always_inline void Box(BoxParams params, VoidBlock $nullable children) {
         Clay__OpenElement();
     }
     Clay__ConfigureOpenElement(decl);
+    _cr_element_open(eid.id);
     if (children) children();
+    _cr_element_close();
     Clay__CloseElement();
 }
 
 /**
- * Row - Horizontal layout container
+ * Box - Generic container
+ */
+static $always_inline void Box(BoxParams params, VoidBlock $nullable children) {
+    _cr_box(params, children, (CR_BoxLayout){0});
+}
+
+/**
+ * Row - Horizontal layout container, whatever the style's direction
  */
 static $always_inline void Row(BoxParams params, VoidBlock $nullable children) {
-    params.style.layout.layoutDirection = CLAY_LEFT_TO_RIGHT;
-    Box(params, children);
+    _cr_box(params, children, (CR_BoxLayout){ .set_direction = true, .direction = CLAY_LEFT_TO_RIGHT });
 }
 
 /**
- * Column - Vertical layout container
+ * Column - Vertical layout container, whatever the style's direction
  */
 static $always_inline void Column(BoxParams params, VoidBlock $nullable children) {
-    params.style.layout.layoutDirection = CLAY_TOP_TO_BOTTOM;
-    Box(params, children);
+    _cr_box(params, children, (CR_BoxLayout){ .set_direction = true, .direction = CLAY_TOP_TO_BOTTOM });
 }
 
 /**
- * Center - Centered content container
+ * Center - Centered content container, whatever the style's alignment
  */
 static $always_inline void Center(BoxParams params, VoidBlock $nullable children) {
-    params.style.layout.childAlignment = (Clay_ChildAlignment){
-        .x = CLAY_ALIGN_X_CENTER,
-        .y = CLAY_ALIGN_Y_CENTER,
-    };
-    Box(params, children);
+    _cr_box(params, children, (CR_BoxLayout){ .center = true });
 }
 
 /**
@@ -1089,16 +2275,8 @@ static $always_inline void Flex(BoxParams params, VoidBlock $nullable children)
  * Card - Styled card container
  */
 static $always_inline void Card(BoxParams params, VoidBlock $nullable children) {
-    if (_cr_layout_is_zero(params.style.layout)) {
-        params.style.layout.padding = $pad(16);
-    }
-    if (!_cr_style_has_corner(params.style)) {
-        params.style.corner_radius = $radius(12);
-        params.style.has_corner_radius = true;
-    }
-    if (!_cr_style_has_background(params.style)) {
-        params.style.background = $WHITE;
-        params.style.has_background = true;
+    if (!params.compiled) {
+        params.style = _cr_style_with_defaults(CR_STYLE_CARD, params.style);
     }
     Box(params, children);
 }
@@ -1107,12 +2285,16 @@ static $always_inline void Card(BoxParams params, VoidBlock $nullable children)
  * Text - Render text
  */
 static $always_inline void Text(TextParams params) {
-    Clay_String text = cr_string(params.text);
+    Clay_String text = _cr_params_string(params.str, params.text);
     Clay__OpenTextElement(text, _cr_text_config(params.style, $TEXT_DEFAULT_COLOR, $TEXT_DEFAULT_SIZE));
 }
 
 /**
  * Textf - Render formatted text
+ *
+ * Formats once into the frame arena (see cr_format). With memo_id set, the
+ * text is kept per element and only reformatted when the argument values
+ * change; fmt must then be a string literal or otherwise stable pointer.
  */
 static $always_inline void Textf(TextParams params, const char * $nullable fmt, ...) {
     if (!fmt) {
@@ -1122,19 +2304,12 @@ static $always_inline void Textf(TextParams params, const char * $nullable fmt,
 
     va_list args;
     va_start(args, fmt);
-    int needed = vsnprintf(NULL, 0, fmt, args);
+    Clay_ElementId memo = params.memo_id.name ? cr_element_id(params.memo_id) : (Clay_ElementId){0};
+    params.str = memo.id ?
+        _cr_format_memo_v(memo.id, $cast_nonnull(fmt), args) :
+        _cr_format_v($cast_nonnull(fmt), args);
     va_end(args);
-    if (needed < 0) return;
 
-    size_t size = (size_t)needed + 1;
-    char *buffer = _cr_temp_string_alloc(size);
-    if (!buffer) return;
-
-    va_start(args, fmt);
-    vsnprintf(buffer, size, fmt, args);
-    va_end(args);
-
-    params.text = buffer;
     Text(params);
 }
 
@@ -1149,20 +2324,11 @@ static $always_inline void Clickable(ClickableParams params, VoidBlock $nullable
  * Button - Button with label and click handler
  */
 static $always_inline void Button(ButtonParams params, VoidBlock $nullable children) {
-    ViewStyle style = params.style;
-    if (_cr_layout_is_zero(style.layout)) {
-        style.layout = (Clay_LayoutConfig){
-            .padding = { 16, 16, 10, 10 },
-            .childAlignment = { .x = CLAY_ALIGN_X_CENTER, .y = CLAY_ALIGN_Y_CENTER },
-        };
-    }
-    if (!_cr_style_has_corner(style)) {
-        style.corner_radius = CLAY_CORNER_RADIUS(6);
-        style.has_corner_radius = true;
-    }
-    if (!_cr_style_has_background(style)) {
-        style.background = $BLUE;
-        style.has_background = true;
+    CR_Style resolved;
+    const CR_Style *style = params.compiled;
+    if (!style) {
+        resolved = cr_style_compile(CR_STYLE_BUTTON, params.style);
+        style = &resolved;
     }
 
     Clay_ElementId eid = cr_element_id(params.id);
@@ -1170,24 +2336,21 @@ static $always_inline void Button(ButtonParams params, VoidBlock $nullable child
         _cr_register_click(eid.id, Block_copy(params.on_click));
     }
 
-    Clay_ElementDeclaration decl = {0};
-    decl.id = eid;
-    bool hovered = _cr_style_has_background_hover(style) && eid.id != 0 && Clay_PointerOver(eid);
-    _cr_apply_view_style(&decl, style, hovered);
-
     Clay__OpenElement();
-    Clay__ConfigureOpenElement(decl);
+    Clay__ConfigureOpenElement(_cr_style_instance(style, eid, _cr_style_pointer_over(style, eid)));
+    _cr_element_open(eid.id);
 
     if (children) {
         children();
-    } else if (params.label) {
+    } else if (params.label_str.chars || params.label) {
         TextConfig text = params.text;
         if (!text.color.a) {
             text.color = (Clay_Color){255, 255, 255, 255};
         }
-        Clay__OpenTextElement(cr_string(params.label), _cr_text_config(text, (Clay_Color){255, 255, 255, 255}, 16));
+        Clay__OpenTextElement(_cr_params_string(params.label_str, params.label), _cr_text_config(text, (Clay_Color){255, 255, 255, 255}, 16));
     }
 
+    _cr_element_close();
     Clay__CloseElement();
 }
 
@@ -1195,20 +2358,11 @@ static $always_inline void Button(ButtonParams params, VoidBlock $nullable child
  * IconButton - Compact icon button
  */
 static $always_inline void IconButton(IconButtonParams params, VoidBlock $nullable children) {
-    ViewStyle style = params.style;
-    if (_cr_layout_is_zero(style.layout)) {
-        style.layout = (Clay_LayoutConfig){
-            .sizing = { .width = CLAY_SIZING_FIXED(28), .height = CLAY_SIZING_FIXED(28) },
-            .childAlignment = { .x = CLAY_ALIGN_X_CENTER, .y = CLAY_ALIGN_Y_CENTER },
-        };
-    }
-    if (!_cr_style_has_corner(style)) {
-        style.corner_radius = CLAY_CORNER_RADIUS(4);
-        style.has_corner_radius = true;
-    }
-    if (!_cr_style_has_background(style)) {
-        style.background = $BLUE;
-        style.has_background = true;
+    CR_Style resolved;
+    const CR_Style *style = params.compiled;
+    if (!style) {
+        resolved = cr_style_compile(CR_STYLE_ICON_BUTTON, params.style);
+        style = &resolved;
     }
 
     Clay_ElementId eid = cr_element_id(params.id);
@@ -1216,24 +2370,21 @@ static $always_inline void IconButton(IconButtonParams params, VoidBlock $nullab
         _cr_register_click(eid.id, Block_copy(params.on_click));
     }
 
-    Clay_ElementDeclaration decl = {0};
-    decl.id = eid;
-    bool hovered = _cr_style_has_background_hover(style) && eid.id != 0 && Clay_PointerOver(eid);
-    _cr_apply_view_style(&decl, style, hovered);
-
     Clay__OpenElement();
-    Clay__ConfigureOpenElement(decl);
+    Clay__ConfigureOpenElement(_cr_style_instance(style, eid, _cr_style_pointer_over(style, eid)));
+    _cr_element_open(eid.id);
 
     if (children) {
         children();
-    } else if (params.icon) {
+    } else if (params.icon_str.chars || params.icon) {
         TextConfig text = params.text;
         if (!text.color.a) {
             text.color = (Clay_Color){255, 255, 255, 255};
         }
-        Clay__OpenTextElement(cr_string(params.icon), _cr_text_config(text, (Clay_Color){255, 255, 255, 255}, 16));
+        Clay__OpenTextElement(_cr_params_string(params.icon_str, params.icon), _cr_text_config(text, (Clay_Color){255, 255, 255, 255}, 16));
     }
 
+    _cr_element_close();
     Clay__CloseElement();
 }
 
@@ -1265,19 +2416,42 @@ static $always_inline void Checkbox(CheckboxParams params) {
         .border = params.checked ? (Clay_BorderElementConfig){0} :
             (Clay_BorderElementConfig){ .width = CLAY_BORDER_OUTSIDE(border_width), .color = border_color },
     });
+    _cr_element_open(eid.id);
 
     if (params.checked) {
-        const char *mark = params.checkmark ? params.checkmark : "*";
+        Clay_String mark = params.checkmark_str.chars || params.checkmark ?
+            _cr_params_string(params.checkmark_str, params.checkmark) :
+            CLAY_STRING("*");
         TextConfig text = params.checkmark_text;
         if (!text.color.a) {
             text.color = $WHITE;
         }
-        Clay__OpenTextElement(cr_string(mark), _cr_text_config(text, $WHITE, 16));
+        Clay__OpenTextElement(mark, _cr_text_config(text, $WHITE, 16));
     }
 
+    _cr_element_close();
     Clay__CloseElement();
 }
 
+// Text elements for a gap buffer view. In a container that may space its
+// children, the two pieces share a flush row.
+static $always_inline void _cr_text_view_elements(CR_TextView view, Clay_TextElementConfig *config, bool flush_row) {
+    bool split = view.before_length > 0 && view.after_length > 0;
+    if (split && flush_row) {
+        Clay__OpenElement();
+        Clay__ConfigureOpenElement((Clay_ElementDeclaration){ .layout = { .layoutDirection = CLAY_LEFT_TO_RIGHT } });
+    }
+    if (view.before_length > 0) {
+        Clay__OpenTextElement((Clay_String){ .length = (int32_t)view.before_length, .chars = view.before }, config);
+    }
+    if (view.after_length > 0) {
+        Clay__OpenTextElement((Clay_String){ .length = (int32_t)view.after_length, .chars = view.after }, config);
+    }
+    if (split && flush_row) {
+        Clay__CloseElement();
+    }
+}
+
 /**
  * TextInput - Editable text input field
  */
@@ -1289,48 +2463,251 @@ static $always_inline void TextInput(TextInputParams params) {
         _cr_register_click(eid.id, Block_copy(^{ _cr_focus_input(params.state, eid.id); }));
     }
 
-    ViewStyle style = params.style;
-    if (_cr_layout_is_zero(style.layout)) {
-        style.layout = (Clay_LayoutConfig){
-            .sizing = { .width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_FIT(.min = 40) },
-            .padding = { 12, 12, 10, 10 },
-            .childAlignment = { .y = CLAY_ALIGN_Y_CENTER },
-        };
-    }
-    if (!_cr_style_has_background(style)) {
-        style.background = $WHITE;
-        style.has_background = true;
+    CR_Style resolved;
+    const CR_Style *style = params.compiled;
+    if (!style) {
+        resolved = cr_style_compile(CR_STYLE_TEXT_INPUT, params.style);
+        style = &resolved;
     }
-    if (!_cr_style_has_corner(style)) {
-        style.corner_radius = CLAY_CORNER_RADIUS(6);
-        style.has_corner_radius = true;
-    }
-
-    Clay_BorderElementConfig normal_border = _cr_style_has_border(style) ?
-        style.border :
-        (Clay_BorderElementConfig){ .width = CLAY_BORDER_OUTSIDE(1), .color = $gray(200) };
-    Clay_BorderElementConfig focus_border = params.has_focus_border || _cr_border_has_value(params.focus_border) ?
-        params.focus_border :
-        (Clay_BorderElementConfig){ .width = CLAY_BORDER_OUTSIDE(2), .color = $BLUE };
 
-    Clay_ElementDeclaration decl = {0};
-    decl.id = eid;
-    bool hovered = _cr_style_has_background_hover(style) && eid.id != 0 && Clay_PointerOver(eid);
-    _cr_apply_view_style(&decl, style, hovered);
+    Clay_ElementDeclaration decl = _cr_style_instance(style, eid, _cr_style_pointer_over(style, eid));
     bool is_focused = params.state->focused &&
         (params.state->element_id == 0 || params.state->element_id == eid.id);
-    decl.border = is_focused ? focus_border : normal_border;
+    if (is_focused) {
+        decl.border = params.has_focus_border || _cr_border_has_value(params.focus_border) ?
+            params.focus_border :
+            (Clay_BorderElementConfig){ .width = CLAY_BORDER_OUTSIDE(2), .color = $BLUE };
+    }
 
     Clay__OpenElement();
     Clay__ConfigureOpenElement(decl);
+    _cr_element_open(eid.id);
 
-    const char *text = params.state->length > 0 ? params.state->buffer : params.placeholder;
     TextConfig text_style = params.state->length > 0 ? params.text : params.placeholder_text;
     Clay_Color default_color = params.state->length > 0 ? $gray(30) : $gray(150);
     uint16_t default_size = params.text.font_size ? params.text.font_size : 16;
+    Clay_TextElementConfig *config = _cr_text_config(text_style, default_color, default_size);
+
+    if (params.state->length > 0) {
+        _cr_text_view_elements(_cr_text_input_view(params.state, 0, params.state->length), config, true);
+    } else {
+        Clay__OpenTextElement(_cr_params_string(params.placeholder_str, params.placeholder), config);
+    }
+
+    _cr_element_close();
+    Clay__CloseElement();
+}
+
+// Lines to lay out before the area has a measured viewport
+#define CR_TEXT_AREA_INITIAL_LINES 64
+
+// Per-line element id derived from the area's id, so lines can be measured
+// without hashing a name per line
+static $always_inline Clay_ElementId _cr_text_area_line_id(Clay_ElementId area, size_t line) {
+    uint32_t hash = area.id + (uint32_t)line;
+    hash += (hash << 10);
+    hash ^= (hash >> 6);
+    hash += (hash << 3);
+    hash ^= (hash >> 11);
+    hash += (hash << 15);
+    return (Clay_ElementId){ .id = hash + 1, .offset = (uint32_t)line, .baseId = area.id };
+}
+
+static $always_inline void _cr_line_spacer(float height) {
+    if (height <= 0.0f) return;
+    Clay__OpenElement();
+    Clay__ConfigureOpenElement((Clay_ElementDeclaration){
+        .layout = { .sizing = { .width = CLAY_SIZING_FIXED(0), .height = CLAY_SIZING_FIXED(height) } },
+    });
+    Clay__CloseElement();
+}
+
+/**
+ * TextArea - Multi-line editable text with viewport-only layout
+ *
+ * Lines come from the state's line index and never wrap. Only the lines
+ * inside the scrolled viewport get text elements; fixed-height spacers stand
+ * in for the rest, and line widths measured by earlier layouts size the
+ * horizontal scroll extent. Needs a non-zero id to find its viewport.
+ */
+static $always_inline void TextArea(TextAreaParams params) {
+    if (!_cr_text_input_enable_lines(params.state)) return;
+    CR_TextInputState *state = $cast_nonnull(params.state);
+
+    Clay_ElementId eid = cr_element_id(params.id);
+    if (eid.id != 0) {
+        _cr_register_click(eid.id, Block_copy(^{ _cr_focus_input(state, eid.id); }));
+    }
+
+    CR_Style resolved;
+    const CR_Style *style = params.compiled;
+    if (!style) {
+        resolved = cr_style_compile(CR_STYLE_TEXT_AREA, params.style);
+        style = &resolved;
+    }
+
+    Clay_ElementDeclaration decl = _cr_style_instance(style, eid, _cr_style_pointer_over(style, eid));
+    bool is_focused = state->focused && (state->element_id == 0 || state->element_id == eid.id);
+    if (is_focused) {
+        decl.border = params.has_focus_border || _cr_border_has_value(params.focus_border) ?
+            params.focus_border :
+            (Clay_BorderElementConfig){ .width = CLAY_BORDER_OUTSIDE(2), .color = $BLUE };
+    }
+
+    TextConfig text_style = params.text;
+    uint16_t font_size = text_style.font_size ? text_style.font_size : 16;
+    if (!text_style.line_height) {
+        text_style.line_height = (uint16_t)(font_size + font_size / 2);
+    }
+    text_style.wrap_mode = CLAY_TEXT_WRAP_NONE;
+    float line_height = (float)text_style.line_height;
+
+    Clay__OpenElement();
+    decl.clip = (Clay_ClipElementConfig){ .horizontal = true, .vertical = true, .childOffset = Clay_GetScrollOffset() };
+    Clay__ConfigureOpenElement(decl);
+    _cr_element_open(eid.id);
+
+    // Visible range from the viewport the previous layout produced
+    Clay_ElementData area = eid.id != 0 ? Clay_GetElementData(eid) : (Clay_ElementData){0};
+    float viewport = area.found ? area.boundingBox.height : CR_TEXT_AREA_INITIAL_LINES * line_height;
+    // Rows start below the top padding, so a line stays visible until the
+    // offset passes its bottom edge
+    float padding = (float)decl.layout.padding.top;
+    float scrolled = -decl.clip.childOffset.y - padding;
+    size_t first = scrolled > 0.0f ? (size_t)(scrolled / line_height) : 0;
+    size_t last = first + (size_t)(viewport / line_height) + 2;
+    if (first > state->line_count) first = state->line_count;
+    if (last > state->line_count) last = state->line_count;
+    if (first > 0 || last < state->line_count) {
+        cr_bind_scroll_window(eid, (Clay_ElementId){0},
+            first > 0 ? padding + (float)first * line_height : -INFINITY,
+            last < state->line_count ? padding + (float)last * line_height : INFINITY);
+    }
+
+    // Widths from the last layout only describe these lines if nothing was
+    // edited since
+    bool measurable = eid.id != 0 && state->laid_out_revision == state->revision;
+    float content_width = _cr_text_input_content_width(state);
+
+    Clay__OpenElement();
+    Clay__ConfigureOpenElement((Clay_ElementDeclaration){
+        .layout = {
+            .sizing = { .width = CLAY_SIZING_GROW(.min = content_width) },
+            .layoutDirection = CLAY_TOP_TO_BOTTOM,
+        },
+    });
+
+    _cr_line_spacer((float)first * line_height);
+
+    const size_t *starts = $cast_nonnull(state->line_starts);
+    const float *widths = $cast_nonnull(state->line_widths);
+    Clay_TextElementConfig *config = _cr_text_config(text_style, $gray(30), 16);
+    for (size_t line = first; line < last; line++) {
+        Clay_ElementId line_id = _cr_text_area_line_id(eid, line);
+        if (measurable && widths[line] < 0.0f) {
+            Clay_ElementData data = Clay_GetElementData(line_id);
+            if (data.found) {
+                _cr_text_input_set_line_width(state, line, data.boundingBox.width);
+            }
+        }
+
+        Clay__OpenElement();
+        Clay__ConfigureOpenElement((Clay_ElementDeclaration){
+            .id = line_id,
+            .layout = { .sizing = { .height = CLAY_SIZING_FIXED(line_height) } },
+        });
+        // A line the gap splits becomes two text runs in its row
+        size_t end = _cr_text_input_line_end(state, line);
+        _cr_text_view_elements(_cr_text_input_view(state, starts[line], end), config, false);
+        Clay__CloseElement();
+    }
+
+    _cr_line_spacer((float)(state->line_count - last) * line_height);
+
+    Clay__CloseElement();
+    _cr_element_close();
+    Clay__CloseElement();
+    state->laid_out_revision = state->revision;
+}
+
+/**
+ * Paragraph - Word-wrapped text that only lays out visible lines
+ *
+ * Line breaks are cached per element and reused while the width, font and
+ * text stay the same; appending to the text only rewraps the last line.
+ * Lines outside clip_id's box (or the window) become spacers. The first
+ * frame, or a backend without cr_set_measure_text, falls back to Text.
+ */
+static $always_inline void Paragraph(ParagraphParams params) {
+    Clay_String text = _cr_params_string(params.str, params.text);
+    TextConfig text_style = params.style;
+    uint16_t font_size = text_style.font_size ? text_style.font_size : $TEXT_DEFAULT_SIZE;
+    if (!text_style.line_height) {
+        text_style.line_height = (uint16_t)(font_size + font_size / 2);
+    }
+    // Lines already fit; wrapping stays on so a narrower layout can shrink
+    // them until the next frame rebreaks at the new width
+    text_style.wrap_mode = CLAY_TEXT_WRAP_WORDS;
+    Clay_TextElementConfig *config = _cr_text_config(text_style, $TEXT_DEFAULT_COLOR, $TEXT_DEFAULT_SIZE);
+    float line_height = (float)text_style.line_height;
 
-    Clay__OpenTextElement(cr_string(text ? text : ""), _cr_text_config(text_style, default_color, default_size));
+    Clay_ElementId eid = cr_element_id(params.id);
+    Clay_ElementData box = eid.id != 0 ? Clay_GetElementData(eid) : (Clay_ElementData){0};
+    const CR_ParagraphLines *lines = box.found ?
+        _cr_paragraph_lines(eid.id, text, config, box.boundingBox.width) : NULL;
 
+    Clay__OpenElement();
+    Clay__ConfigureOpenElement((Clay_ElementDeclaration){
+        .id = eid,
+        .layout = {
+            .sizing = { .width = CLAY_SIZING_GROW(0) },
+            .layoutDirection = CLAY_TOP_TO_BOTTOM,
+        },
+    });
+    _cr_element_open(eid.id);
+    if (!lines) {
+        Clay__OpenTextElement(text, config);
+        _cr_element_close();
+        Clay__CloseElement();
+        return;
+    }
+
+    // Visible range from where the previous layout put the paragraph
+    Clay_ElementId clip_id = params.clip_id.name ?
+        cr_element_id(params.clip_id) :
+        Clay_GetElementId(CLAY_STRING("Clay__RootContainer"));
+    Clay_ElementData clip = Clay_GetElementData(clip_id);
+    size_t first = 0;
+    size_t last = lines->line_count;
+    if (clip.found) {
+        float above = clip.boundingBox.y - box.boundingBox.y;
+        float below = above + clip.boundingBox.height;
+        first = above > line_height ? (size_t)(above / line_height) - 1 : 0;
+        last = below > 0.0f ? (size_t)(below / line_height) + 2 : 0;
+        if (last > lines->line_count) last = lines->line_count;
+        if (first > last) first = last;
+    }
+    if (first > 0 || last < lines->line_count) {
+        cr_bind_scroll_window(params.clip_id.name ? clip_id : (Clay_ElementId){0}, eid,
+            first > 0 ? (float)first * line_height : -INFINITY,
+            last < lines->line_count ? (float)last * line_height : INFINITY);
+    }
+
+    _cr_line_spacer((float)first * line_height);
+    for (size_t line = first; line < last; line++) {
+        CR_TextLine span = $cast_nonnull(lines->lines)[line];
+        Clay__OpenElement();
+        Clay__ConfigureOpenElement((Clay_ElementDeclaration){
+            .layout = { .sizing = { .width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_FIXED(line_height) } },
+        });
+        if (span.end > span.start) {
+            Clay__OpenTextElement((Clay_String){ .length = (int32_t)(span.end - span.start), .chars = text.chars + span.start }, config);
+        }
+        Clay__CloseElement();
+    }
+    _cr_line_spacer((float)(lines->line_count - last) * line_height);
+
+    _cr_element_close();
     Clay__CloseElement();
 }
 
@@ -1342,7 +2719,7 @@ static $always_inline void TextInput(TextInputParams params) {
  * $use_text_input - Create a persistent text input state
  *
  * Usage:
- *   auto input = $use_text_input(64);  // 64 byte buffer
+ *   auto input = $use_text_input(64);  // 64 bytes up front, grows as needed
  */
 #define $use_text_input(buffer_size) \
     ({ \
@@ -1404,6 +2781,44 @@ CR_Context * $nullable _cr_create_context_impl(const char *name, size_t size, vo
 CR_ContextProvider * $nullable _cr_push_context(CR_Context *context, void * $nullable value);
 void _cr_pop_context(CR_ContextProvider * $nullable provider);
 
+// ============================================================================
+// KEEP-ALIVE BOUNDARIES
+// ============================================================================
+
+/**
+ * $keep_alive - Keep a subtree mounted while it is hidden
+ *
+ * The body only renders while visible, but the components inside keep their
+ * hooks and state across hidden frames. cr_set_keep_alive_limit caps how many
+ * hidden subtrees are retained; the least recently shown one is unmounted
+ * first. The boundary closes when the body's scope does, so break, continue
+ * and return inside it are fine.
+ *
+ * Usage:
+ *   $keep_alive(cr_id("inbox"), tab == TAB_INBOX) {
+ *       InboxTab();
+ *   }
+ */
+#define $keep_alive(key, visible) \
+    for ($cleanup(_cr_keep_alive_leave) CR_KeepAliveScope _ka = { _cr_keep_alive_begin((key), (visible)), false }; \
+         !_ka.done; \
+         _ka.done = true) \
+        if (_ka.visible)
+
+typedef struct {
+    bool visible;
+    bool done;
+} CR_KeepAliveScope;
+
+bool _cr_keep_alive_begin(CR_Id key, bool visible);
+void _cr_keep_alive_end(void);
+
+static inline void _cr_keep_alive_leave(CR_KeepAliveScope *scope) {
+    (void)scope;
+    _cr_keep_alive_end();
+}
+void cr_set_keep_alive_limit(size_t limit);
+
 /**
  * $use_context - Access context value
  *
@@ -1493,10 +2908,12 @@ void * $nullable _cr_use_context_impl(CR_Context * $nullable context);
 // ID HELPERS
 // ============================================================================
 
-#define $id(name)       CLAY_ID(name)
-#define $idi(name, i)   CLAY_IDI(name, i)
-#define $key(name)      cr_key(cr_id(name))
-#define $keyi(name, i)  cr_key(cr_idi(name, i))
+#define $id(name)           cr_element_id($id_lit(name))
+#define $idi(name, i)       cr_element_id($id_liti(name, i))
+#define $key(name)          cr_key(cr_id(name))
+#define $keyi(name, i)      cr_key(cr_idi(name, i))
+#define $key_lit(name)      cr_key($id_lit(name))
+#define $keyi_lit(name, i)  cr_key($id_liti(name, i))
 
 // ============================================================================
 // ANIMATION HELPERS
@@ -1515,6 +2932,58 @@ static $always_inline Clay_Color lerp_colour(Clay_Color a, Clay_Color b, float t
     };
 }
 
+typedef float (*CR_EasingFn)(float t);
+
+static $always_inline float cr_ease_linear(float t) {
+    return t;
+}
+
+static $always_inline float cr_ease_out_cubic(float t) {
+    float inv = 1.0f - t;
+    return 1.0f - inv * inv * inv;
+}
+
+static $always_inline float cr_ease_in_out_cubic(float t) {
+    if (t < 0.5f) return 4.0f * t * t * t;
+    float inv = -2.0f * t + 2.0f;
+    return 1.0f - inv * inv * inv * 0.5f;
+}
+
+typedef struct {
+    float duration;                 // Seconds (default 0.2)
+    CR_EasingFn $nullable easing;   // Default cr_ease_out_cubic
+} CR_AnimationParams;
+
+typedef struct {
+    float stiffness;    // Default 170
+    float damping;      // Default 26
+    float mass;         // Default 1
+    float precision;    // Rest threshold (default 0.01)
+} CR_SpringParams;
+
+float _cr_use_animation(float target, CR_AnimationParams params);
+float _cr_use_spring(float target, CR_SpringParams params);
+
+/**
+ * $use_animation - Tween towards target whenever it changes
+ *
+ * Keeps the frame loop awake only while the tween is running.
+ *
+ * Usage:
+ *   float width = $use_animation(open ? 240 : 48, .duration = 0.15f);
+ */
+#define $use_animation(target, ...) \
+    _cr_use_animation((float)(target), (CR_AnimationParams){ __VA_ARGS__ })
+
+/**
+ * $use_spring - Spring physics towards target, driven by the frame delta
+ *
+ * Usage:
+ *   float x = $use_spring(selected_x, .stiffness = 300, .damping = 30);
+ */
+#define $use_spring(target, ...) \
+    _cr_use_spring((float)(target), (CR_SpringParams){ __VA_ARGS__ })
+
 // ============================================================================
 // INTERNAL IMPLEMENTATION
 // ============================================================================
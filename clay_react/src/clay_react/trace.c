@@ -0,0 +1,564 @@
+#include "clay_react/trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// File layout:
+//   header:  magic "CRTRACE\0", uint32 version, uint32 byte order mark
+//   records: uint8 kind, float viewport width/height, float background
+//            rgba, uint64 time_ns, then
+//            for CR_TRACE_RECORD_FRAME: uint32 count and the int32 length
+//            and bytes of each string the frame adds to the table, uint32
+//            command count, uint32 payload size and the encoded commands
+// Each command is uint8 type, uint32 id, float bounding box[4], int16 z
+// index and the render data its type uses (see cr_trace_encode_command).
+#define CR_TRACE_MAGIC "CRTRACE"
+#define CR_TRACE_VERSION 1u
+#define CR_TRACE_BYTE_ORDER 0x01020304u
+#define CR_TRACE_HEADER_SIZE (8 + 2 * sizeof(uint32_t))
+// Type, id, bounding box and z index: what a command takes at least
+#define CR_TRACE_COMMAND_MIN_SIZE (1 + 4 + 4 * 4 + 2)
+
+// Text references a string table both sides build in the same order, so
+// payloads of frames with the same text compare equal;
+// CR_TRACE_STRING_INLINE stores text in the payload once the table is full
+#define CR_TRACE_STRING_INLINE UINT32_MAX
+#define CR_TRACE_MAX_STRINGS (1u << 20)
+
+enum {
+    CR_TRACE_RECORD_FRAME = 1,
+    CR_TRACE_RECORD_REPEAT = 2,
+};
+
+typedef struct {
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+} CR_TraceBuffer;
+
+typedef struct {
+    uint64_t hash;                  // 0 = empty slot
+    uint32_t index;
+    int32_t length;
+    char *chars;
+} CR_TraceString;
+
+struct CR_TraceWriter {
+    FILE *file;
+    bool failed;
+    CR_TraceBuffer payload;
+    CR_TraceBuffer previous;        // Last written frame's payload
+    CR_TraceBuffer added;           // Strings this frame added to the table
+    uint32_t added_count;
+    bool has_previous;
+    CR_TraceString *strings;        // Open addressing on the content hash
+    size_t string_capacity;
+    uint32_t string_count;
+};
+
+struct CR_TraceReader {
+    uint8_t *data;
+    size_t length;
+    size_t offset;
+    uint32_t frame_index;
+    const char **strings;           // Into data, indexed like the writer's table
+    int32_t *string_lengths;
+    uint32_t string_count;
+    size_t string_capacity;
+    Clay_RenderCommand *commands;
+    int32_t command_count;
+    int32_t command_capacity;
+};
+
+// ============================================================================
+// WRITER
+// ============================================================================
+
+static bool cr_trace_buffer_put(CR_TraceBuffer *buffer, const void *data, size_t length) {
+    if (buffer->length + length > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+        while (capacity < buffer->length + length) {
+            capacity *= 2;
+        }
+        uint8_t *grown = realloc(buffer->data, capacity);
+        if (!grown) return false;
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    return true;
+}
+
+#define CR_TRACE_PUT(buffer, value) cr_trace_buffer_put((buffer), &(value), sizeof(value))
+
+static bool cr_trace_put_color(CR_TraceBuffer *buffer, Clay_Color color) {
+    float values[4] = { color.r, color.g, color.b, color.a };
+    return CR_TRACE_PUT(buffer, values);
+}
+
+static bool cr_trace_put_radius(CR_TraceBuffer *buffer, Clay_CornerRadius radius) {
+    float values[4] = { radius.topLeft, radius.topRight, radius.bottomLeft, radius.bottomRight };
+    return CR_TRACE_PUT(buffer, values);
+}
+
+static uint64_t cr_trace_hash(const char *chars, int32_t length) {
+    uint64_t hash = 14695981039346656037ull;
+    for (int32_t i = 0; i < length; i++) {
+        hash = (hash ^ (uint8_t)chars[i]) * 1099511628211ull;
+    }
+    return hash ? hash : 1;
+}
+
+static bool cr_trace_strings_grow(CR_TraceWriter *writer) {
+    size_t capacity = writer->string_capacity ? writer->string_capacity * 2 : 256;
+    CR_TraceString *strings = calloc(capacity, sizeof(*strings));
+    if (!strings) return false;
+    for (size_t i = 0; i < writer->string_capacity; i++) {
+        CR_TraceString entry = writer->strings[i];
+        if (entry.hash == 0) continue;
+        size_t slot = (size_t)entry.hash & (capacity - 1);
+        while (strings[slot].hash != 0) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        strings[slot] = entry;
+    }
+    free(writer->strings);
+    writer->strings = strings;
+    writer->string_capacity = capacity;
+    return true;
+}
+
+// Reference a table entry, adding one for text not seen before
+static bool cr_trace_put_string(CR_TraceWriter *writer, Clay_StringSlice text) {
+    CR_TraceBuffer *buffer = &writer->payload;
+    int32_t length = text.length > 0 ? text.length : 0;
+    const char *chars = length > 0 ? text.chars : "";
+    uint64_t hash = cr_trace_hash(chars, length);
+
+    size_t slot = 0;
+    if (writer->string_capacity > 0) {
+        slot = (size_t)hash & (writer->string_capacity - 1);
+        while (writer->strings[slot].hash != 0) {
+            CR_TraceString *entry = &writer->strings[slot];
+            if (entry->hash == hash && entry->length == length && memcmp(entry->chars, chars, (size_t)length) == 0) {
+                return CR_TRACE_PUT(buffer, entry->index);
+            }
+            slot = (slot + 1) & (writer->string_capacity - 1);
+        }
+    }
+
+    if (writer->string_count >= CR_TRACE_MAX_STRINGS) {
+        uint32_t index = CR_TRACE_STRING_INLINE;
+        return CR_TRACE_PUT(buffer, index) &&
+               CR_TRACE_PUT(buffer, length) &&
+               cr_trace_buffer_put(buffer, chars, (size_t)length);
+    }
+    if ((size_t)(writer->string_count + 1) * 2 > writer->string_capacity) {
+        if (!cr_trace_strings_grow(writer)) return false;
+        slot = (size_t)hash & (writer->string_capacity - 1);
+        while (writer->strings[slot].hash != 0) {
+            slot = (slot + 1) & (writer->string_capacity - 1);
+        }
+    }
+    if (!CR_TRACE_PUT(&writer->added, length) ||
+        !cr_trace_buffer_put(&writer->added, chars, (size_t)length)) {
+        return false;
+    }
+    char *copy = malloc((size_t)length + 1);
+    if (!copy) return false;
+    memcpy(copy, chars, (size_t)length);
+    copy[length] = '\0';
+    uint32_t index = writer->string_count++;
+    writer->strings[slot] = (CR_TraceString){ .hash = hash, .index = index, .length = length, .chars = copy };
+    writer->added_count++;
+    return CR_TRACE_PUT(buffer, index);
+}
+
+static bool cr_trace_encode_command(CR_TraceWriter *writer, const Clay_RenderCommand *command) {
+    CR_TraceBuffer *buffer = &writer->payload;
+    uint8_t type = (uint8_t)command->commandType;
+    float box[4] = {
+        command->boundingBox.x, command->boundingBox.y,
+        command->boundingBox.width, command->boundingBox.height,
+    };
+    int16_t z_index = command->zIndex;
+    if (!CR_TRACE_PUT(buffer, type) ||
+        !CR_TRACE_PUT(buffer, command->id) ||
+        !CR_TRACE_PUT(buffer, box) ||
+        !CR_TRACE_PUT(buffer, z_index)) {
+        return false;
+    }
+
+    const Clay_RenderData *data = &command->renderData;
+    switch (command->commandType) {
+        case CLAY_RENDER_COMMAND_TYPE_RECTANGLE:
+            return cr_trace_put_color(buffer, data->rectangle.backgroundColor) &&
+                   cr_trace_put_radius(buffer, data->rectangle.cornerRadius);
+        case CLAY_RENDER_COMMAND_TYPE_BORDER: {
+            uint16_t width[5] = {
+                data->border.width.left, data->border.width.right,
+                data->border.width.top, data->border.width.bottom,
+                data->border.width.betweenChildren,
+            };
+            return cr_trace_put_color(buffer, data->border.color) &&
+                   cr_trace_put_radius(buffer, data->border.cornerRadius) &&
+                   CR_TRACE_PUT(buffer, width);
+        }
+        case CLAY_RENDER_COMMAND_TYPE_TEXT: {
+            uint16_t font[4] = {
+                data->text.fontId, data->text.fontSize,
+                data->text.letterSpacing, data->text.lineHeight,
+            };
+            return cr_trace_put_string(writer, data->text.stringContents) &&
+                   cr_trace_put_color(buffer, data->text.textColor) &&
+                   CR_TRACE_PUT(buffer, font);
+        }
+        case CLAY_RENDER_COMMAND_TYPE_IMAGE:
+            return cr_trace_put_color(buffer, data->image.backgroundColor) &&
+                   cr_trace_put_radius(buffer, data->image.cornerRadius);
+        case CLAY_RENDER_COMMAND_TYPE_CUSTOM:
+            return cr_trace_put_color(buffer, data->custom.backgroundColor) &&
+                   cr_trace_put_radius(buffer, data->custom.cornerRadius);
+        case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START:
+        case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END: {
+            uint8_t axes[2] = { data->clip.horizontal, data->clip.vertical };
+            return CR_TRACE_PUT(buffer, axes);
+        }
+        case CLAY_RENDER_COMMAND_TYPE_NONE:
+        default:
+            return true;
+    }
+}
+
+CR_TraceWriter *cr_trace_writer_open(const char *path) {
+    if (!path) return NULL;
+    CR_TraceWriter *writer = calloc(1, sizeof(*writer));
+    if (!writer) return NULL;
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        free(writer);
+        return NULL;
+    }
+
+    char magic[8] = CR_TRACE_MAGIC;
+    uint32_t version = CR_TRACE_VERSION;
+    uint32_t byte_order = CR_TRACE_BYTE_ORDER;
+    if (fwrite(magic, sizeof(magic), 1, writer->file) != 1 ||
+        fwrite(&version, sizeof(version), 1, writer->file) != 1 ||
+        fwrite(&byte_order, sizeof(byte_order), 1, writer->file) != 1) {
+        writer->failed = true;
+    }
+    return writer;
+}
+
+bool cr_trace_write_frame(CR_TraceWriter *writer, Clay_Dimensions viewport, Clay_Color background,
+                          uint64_t time_ns, Clay_RenderCommandArray commands) {
+    if (!writer || writer->failed) return false;
+
+    writer->payload.length = 0;
+    writer->added.length = 0;
+    writer->added_count = 0;
+    for (int32_t i = 0; i < commands.length; i++) {
+        if (!cr_trace_encode_command(writer, Clay_RenderCommandArray_Get(&commands, i))) {
+            writer->failed = true;
+            return false;
+        }
+    }
+
+    // New text gets new indices, so a repeat never adds strings
+    bool repeat = writer->has_previous &&
+        writer->previous.length == writer->payload.length &&
+        memcmp(writer->previous.data, writer->payload.data, writer->payload.length) == 0;
+    uint8_t kind = repeat ? CR_TRACE_RECORD_REPEAT : CR_TRACE_RECORD_FRAME;
+    float size[2] = { viewport.width, viewport.height };
+    float clear[4] = { background.r, background.g, background.b, background.a };
+    bool ok = fwrite(&kind, sizeof(kind), 1, writer->file) == 1 &&
+              fwrite(size, sizeof(size), 1, writer->file) == 1 &&
+              fwrite(clear, sizeof(clear), 1, writer->file) == 1 &&
+              fwrite(&time_ns, sizeof(time_ns), 1, writer->file) == 1;
+    if (ok && !repeat) {
+        uint32_t count = (uint32_t)commands.length;
+        uint32_t payload_size = (uint32_t)writer->payload.length;
+        ok = fwrite(&writer->added_count, sizeof(writer->added_count), 1, writer->file) == 1 &&
+             (writer->added.length == 0 || fwrite(writer->added.data, writer->added.length, 1, writer->file) == 1) &&
+             fwrite(&count, sizeof(count), 1, writer->file) == 1 &&
+             fwrite(&payload_size, sizeof(payload_size), 1, writer->file) == 1 &&
+             (payload_size == 0 || fwrite(writer->payload.data, payload_size, 1, writer->file) == 1);
+
+        // Keep this payload for the next comparison by swapping buffers
+        CR_TraceBuffer previous = writer->previous;
+        writer->previous = writer->payload;
+        writer->payload = previous;
+        writer->has_previous = true;
+    }
+    if (!ok) {
+        writer->failed = true;
+    }
+    return ok;
+}
+
+void cr_trace_writer_close(CR_TraceWriter *writer) {
+    if (!writer) return;
+    if (writer->file) {
+        fclose(writer->file);
+    }
+    for (size_t i = 0; i < writer->string_capacity; i++) {
+        free(writer->strings[i].chars);
+    }
+    free(writer->strings);
+    free(writer->payload.data);
+    free(writer->previous.data);
+    free(writer->added.data);
+    free(writer);
+}
+
+// ============================================================================
+// READER
+// ============================================================================
+
+static bool cr_trace_take(CR_TraceReader *reader, void *out, size_t length) {
+    if (length > reader->length - reader->offset) return false;
+    memcpy(out, reader->data + reader->offset, length);
+    reader->offset += length;
+    return true;
+}
+
+#define CR_TRACE_TAKE(reader, value) cr_trace_take((reader), &(value), sizeof(value))
+
+static bool cr_trace_take_color(CR_TraceReader *reader, Clay_Color *color) {
+    float values[4];
+    if (!CR_TRACE_TAKE(reader, values)) return false;
+    *color = (Clay_Color){ values[0], values[1], values[2], values[3] };
+    return true;
+}
+
+static bool cr_trace_take_radius(CR_TraceReader *reader, Clay_CornerRadius *radius) {
+    float values[4];
+    if (!CR_TRACE_TAKE(reader, values)) return false;
+    *radius = (Clay_CornerRadius){ values[0], values[1], values[2], values[3] };
+    return true;
+}
+
+// int32 length and bytes, left in place in the loaded file
+static bool cr_trace_take_chars(CR_TraceReader *reader, Clay_StringSlice *text) {
+    int32_t length = 0;
+    if (!CR_TRACE_TAKE(reader, length) || length < 0 || (size_t)length > reader->length - reader->offset) {
+        return false;
+    }
+    const char *chars = (const char *)reader->data + reader->offset;
+    reader->offset += (size_t)length;
+    *text = (Clay_StringSlice){ .length = length, .chars = chars, .baseChars = chars };
+    return true;
+}
+
+static bool cr_trace_add_string(CR_TraceReader *reader) {
+    Clay_StringSlice text;
+    if (!cr_trace_take_chars(reader, &text) || reader->string_count >= CR_TRACE_MAX_STRINGS) return false;
+    if (reader->string_count == reader->string_capacity) {
+        size_t capacity = reader->string_capacity ? reader->string_capacity * 2 : 256;
+        const char **strings = realloc(reader->strings, capacity * sizeof(*strings));
+        if (!strings) return false;
+        reader->strings = strings;
+        int32_t *lengths = realloc(reader->string_lengths, capacity * sizeof(*lengths));
+        if (!lengths) return false;
+        reader->string_lengths = lengths;
+        reader->string_capacity = capacity;
+    }
+    reader->strings[reader->string_count] = text.chars;
+    reader->string_lengths[reader->string_count] = text.length;
+    reader->string_count++;
+    return true;
+}
+
+static bool cr_trace_take_string(CR_TraceReader *reader, Clay_StringSlice *text) {
+    uint32_t index = 0;
+    if (!CR_TRACE_TAKE(reader, index)) return false;
+    if (index == CR_TRACE_STRING_INLINE) {
+        return cr_trace_take_chars(reader, text);
+    }
+    if (index >= reader->string_count) return false;
+    const char *chars = reader->strings[index];
+    *text = (Clay_StringSlice){ .length = reader->string_lengths[index], .chars = chars, .baseChars = chars };
+    return true;
+}
+
+static bool cr_trace_decode_command(CR_TraceReader *reader, Clay_RenderCommand *command) {
+    uint8_t type = 0;
+    float box[4];
+    memset(command, 0, sizeof(*command));
+    if (!CR_TRACE_TAKE(reader, type) ||
+        !CR_TRACE_TAKE(reader, command->id) ||
+        !CR_TRACE_TAKE(reader, box) ||
+        !CR_TRACE_TAKE(reader, command->zIndex)) {
+        return false;
+    }
+    command->boundingBox = (Clay_BoundingBox){ box[0], box[1], box[2], box[3] };
+    command->commandType = (Clay_RenderCommandType)type;
+
+    Clay_RenderData *data = &command->renderData;
+    switch (type) {
+        case CLAY_RENDER_COMMAND_TYPE_RECTANGLE:
+            return cr_trace_take_color(reader, &data->rectangle.backgroundColor) &&
+                   cr_trace_take_radius(reader, &data->rectangle.cornerRadius);
+        case CLAY_RENDER_COMMAND_TYPE_BORDER: {
+            uint16_t width[5];
+            if (!cr_trace_take_color(reader, &data->border.color) ||
+                !cr_trace_take_radius(reader, &data->border.cornerRadius) ||
+                !CR_TRACE_TAKE(reader, width)) {
+                return false;
+            }
+            data->border.width = (Clay_BorderWidth){ width[0], width[1], width[2], width[3], width[4] };
+            return true;
+        }
+        case CLAY_RENDER_COMMAND_TYPE_TEXT: {
+            uint16_t font[4];
+            if (!cr_trace_take_string(reader, &data->text.stringContents) ||
+                !cr_trace_take_color(reader, &data->text.textColor) ||
+                !CR_TRACE_TAKE(reader, font)) {
+                return false;
+            }
+            data->text.fontId = font[0];
+            data->text.fontSize = font[1];
+            data->text.letterSpacing = font[2];
+            data->text.lineHeight = font[3];
+            return true;
+        }
+        case CLAY_RENDER_COMMAND_TYPE_IMAGE:
+        case CLAY_RENDER_COMMAND_TYPE_CUSTOM: {
+            // The recorded pointers are gone; draw the placeholder they sit on
+            Clay_RectangleRenderData rectangle = {0};
+            if (!cr_trace_take_color(reader, &rectangle.backgroundColor) ||
+                !cr_trace_take_radius(reader, &rectangle.cornerRadius)) {
+                return false;
+            }
+            command->commandType = CLAY_RENDER_COMMAND_TYPE_RECTANGLE;
+            data->rectangle = rectangle;
+            return true;
+        }
+        case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START:
+        case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END: {
+            uint8_t axes[2];
+            if (!CR_TRACE_TAKE(reader, axes)) return false;
+            data->clip.horizontal = axes[0] != 0;
+            data->clip.vertical = axes[1] != 0;
+            return true;
+        }
+        case CLAY_RENDER_COMMAND_TYPE_NONE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+CR_TraceReader *cr_trace_reader_open(const char *path) {
+    FILE *file = path ? fopen(path, "rb") : NULL;
+    if (!file) {
+        fprintf(stderr, "Failed to open trace %s\n", path ? path : "(null)");
+        return NULL;
+    }
+    CR_TraceReader *reader = calloc(1, sizeof(*reader));
+    long size = -1;
+    if (reader && fseek(file, 0, SEEK_END) == 0) {
+        size = ftell(file);
+    }
+    if (!reader || size < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        fprintf(stderr, "Failed to read trace %s\n", path);
+        fclose(file);
+        free(reader);
+        return NULL;
+    }
+    reader->length = (size_t)size;
+    reader->data = malloc(reader->length ? reader->length : 1);
+    bool loaded = reader->data && (reader->length == 0 || fread(reader->data, reader->length, 1, file) == 1);
+    fclose(file);
+
+    char magic[8];
+    uint32_t version = 0;
+    uint32_t byte_order = 0;
+    if (!loaded ||
+        !CR_TRACE_TAKE(reader, magic) ||
+        !CR_TRACE_TAKE(reader, version) ||
+        !CR_TRACE_TAKE(reader, byte_order) ||
+        memcmp(magic, CR_TRACE_MAGIC, sizeof(magic)) != 0 ||
+        version != CR_TRACE_VERSION ||
+        byte_order != CR_TRACE_BYTE_ORDER) {
+        fprintf(stderr, "%s is not a version %u trace from a machine of this byte order\n", path, CR_TRACE_VERSION);
+        cr_trace_reader_close(reader);
+        return NULL;
+    }
+    return reader;
+}
+
+bool cr_trace_read_frame(CR_TraceReader *reader, CR_TraceFrame *frame) {
+    if (!reader || !frame || reader->offset >= reader->length) return false;
+
+    uint8_t kind = 0;
+    float size[2];
+    Clay_Color background;
+    uint64_t time_ns = 0;
+    if (!CR_TRACE_TAKE(reader, kind) || !CR_TRACE_TAKE(reader, size) ||
+        !cr_trace_take_color(reader, &background) || !CR_TRACE_TAKE(reader, time_ns)) {
+        return false;
+    }
+    if (kind == CR_TRACE_RECORD_FRAME) {
+        uint32_t added = 0;
+        if (!CR_TRACE_TAKE(reader, added)) return false;
+        for (uint32_t i = 0; i < added; i++) {
+            if (!cr_trace_add_string(reader)) return false;
+        }
+
+        uint32_t count = 0;
+        uint32_t payload_size = 0;
+        if (!CR_TRACE_TAKE(reader, count) || !CR_TRACE_TAKE(reader, payload_size) ||
+            payload_size > reader->length - reader->offset || count > payload_size / CR_TRACE_COMMAND_MIN_SIZE) {
+            return false;
+        }
+        if ((int32_t)count > reader->command_capacity) {
+            Clay_RenderCommand *commands = realloc(reader->commands, (size_t)count * sizeof(*commands));
+            if (!commands) return false;
+            reader->commands = commands;
+            reader->command_capacity = (int32_t)count;
+        }
+        size_t end = reader->offset + payload_size;
+        for (uint32_t i = 0; i < count; i++) {
+            if (!cr_trace_decode_command(reader, &reader->commands[i])) return false;
+        }
+        if (reader->offset != end) return false;
+        reader->command_count = (int32_t)count;
+    } else if (kind != CR_TRACE_RECORD_REPEAT || reader->frame_index == 0) {
+        return false;
+    }
+
+    *frame = (CR_TraceFrame){
+        .index = reader->frame_index++,
+        .viewport = { size[0], size[1] },
+        .background = background,
+        .time_ns = time_ns,
+        .repeat = kind == CR_TRACE_RECORD_REPEAT,
+        .commands = {
+            .capacity = reader->command_capacity,
+            .length = reader->command_count,
+            .internalArray = reader->commands,
+        },
+    };
+    return true;
+}
+
+void cr_trace_reader_rewind(CR_TraceReader *reader) {
+    if (!reader) return;
+    reader->offset = CR_TRACE_HEADER_SIZE;
+    reader->frame_index = 0;
+    reader->string_count = 0;
+    reader->command_count = 0;
+}
+
+void cr_trace_reader_close(CR_TraceReader *reader) {
+    if (!reader) return;
+    free(reader->data);
+    free(reader->strings);
+    free(reader->string_lengths);
+    free(reader->commands);
+    free(reader);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <clay.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Frame traces: the render commands of every frame an app built, in a
+ * compact binary file a renderer can replay without the app.
+ *
+ * Commands keep their type, id, bounding box, z index and render data;
+ * text contents are stored once per trace and referenced afterwards, and a
+ * frame identical to the one before it is stored as a repeat. Image and
+ * custom commands carry pointers that mean nothing outside the recording
+ * process, so they replay as rectangles in their background color.
+ *
+ * Values are written in the recording machine's byte order; readers reject
+ * traces from a machine of the other order.
+ */
+typedef struct CR_TraceWriter CR_TraceWriter;
+typedef struct CR_TraceReader CR_TraceReader;
+
+typedef struct CR_TraceFrame {
+    uint32_t index;                     // 0-based position in the trace
+    Clay_Dimensions viewport;           // Layout dimensions of the frame
+    Clay_Color background;              // Color the app cleared to first
+    uint64_t time_ns;                   // Recorder clock when it was built
+    bool repeat;                        // Same commands as the frame before
+    Clay_RenderCommandArray commands;   // Owned by the reader, valid until its next read
+} CR_TraceFrame;
+
+/**
+ * cr_trace_writer_open - Start a trace file (NULL if it cannot be created)
+ */
+CR_TraceWriter *cr_trace_writer_open(const char *path);
+
+/**
+ * cr_trace_write_frame - Append one frame; false once a write failed
+ */
+bool cr_trace_write_frame(CR_TraceWriter *writer, Clay_Dimensions viewport, Clay_Color background,
+                          uint64_t time_ns, Clay_RenderCommandArray commands);
+
+/**
+ * cr_trace_writer_close - Flush and close the file; NULL is ignored
+ */
+void cr_trace_writer_close(CR_TraceWriter *writer);
+
+/**
+ * cr_trace_reader_open - Load a whole trace into memory
+ *
+ * Returns NULL (with a message on stderr) for missing, foreign or corrupt
+ * files.
+ */
+CR_TraceReader *cr_trace_reader_open(const char *path);
+
+/**
+ * cr_trace_read_frame - Decode the next frame; false at the end of the trace
+ *
+ * Text in the decoded commands points into the reader's copy of the file.
+ */
+bool cr_trace_read_frame(CR_TraceReader *reader, CR_TraceFrame *frame);
+
+/**
+ * cr_trace_reader_rewind - Start reading from the first frame again
+ */
+void cr_trace_reader_rewind(CR_TraceReader *reader);
+
+void cr_trace_reader_close(CR_TraceReader *reader);
+
+#ifdef __cplusplus
+}
+#endif
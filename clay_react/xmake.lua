@@ -9,6 +9,9 @@ target("clay_react")
     add_deps("reflect")
     add_packages("clay", {public = true})
     add_links("BlocksRuntime")
+    if is_plat("linux") then
+        add_syslinks("m")
+    end
 
     if renderer == "sdl3" then
         add_defines("CLAY_RENDERER_SDL3")
@@ -44,6 +47,9 @@ target("clay_react")
     elseif renderer == "terminal" then
         add_defines("CLAY_RENDERER_TERMINAL")
         add_files("src/clay.c")
+    elseif renderer == "headless" then
+        add_defines("CLAY_RENDERER_HEADLESS")
+        add_files("src/clay.c")
     elseif renderer == "web" then
         add_defines("CLAY_RENDERER_WEB")
         add_files("src/clay.c")
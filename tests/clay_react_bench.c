@@ -0,0 +1,393 @@
+/**
+ * Clay React benchmarks - runtime cost of synthetic workloads
+ *
+ * Every workload renders through cr_begin_frame/cr_end_frame with the same
+ * zero-size measure function the tests use, so the numbers cover the
+ * runtime and Clay layout but no text shaping. Build in release mode; debug
+ * builds enable sanitizers, which skew timings and hide heap counts.
+ *
+ * Usage: clay_react_bench [filter] [frames]
+ */
+#define CLAY_IMPLEMENTATION
+#include <clay.h>
+#include "clay_react/clay_react.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// ============================================================================
+// HEAP COUNTING
+// ============================================================================
+
+#ifndef __has_feature
+#define __has_feature(x) 0
+#endif
+
+// glibc lets the binary wrap its allocator, which also catches Block_copy
+// and plain malloc/realloc traffic that the runtime's own counters miss
+#if defined(__GLIBC__) && !__has_feature(address_sanitizer) && !defined(__SANITIZE_ADDRESS__)
+#define BENCH_COUNT_HEAP 1
+
+#include <malloc.h>
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static uint64_t g_heap_allocs = 0;
+static int64_t g_heap_live = 0;
+static int64_t g_heap_peak = 0;
+
+static void bench_heap_add(void *ptr) {
+    if (!ptr) return;
+    g_heap_allocs++;
+    g_heap_live += (int64_t)malloc_usable_size(ptr);
+    if (g_heap_live > g_heap_peak) {
+        g_heap_peak = g_heap_live;
+    }
+}
+
+void *malloc(size_t size) {
+    void *ptr = __libc_malloc(size);
+    bench_heap_add(ptr);
+    return ptr;
+}
+
+void *calloc(size_t count, size_t size) {
+    void *ptr = __libc_calloc(count, size);
+    bench_heap_add(ptr);
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size) {
+    if (ptr) {
+        g_heap_live -= (int64_t)malloc_usable_size(ptr);
+    }
+    void *fresh = __libc_realloc(ptr, size);
+    if (!fresh && ptr && size) {
+        // Failed: the old block is still live
+        g_heap_live += (int64_t)malloc_usable_size(ptr);
+        return NULL;
+    }
+    bench_heap_add(fresh);
+    return fresh;
+}
+
+void free(void *ptr) {
+    if (ptr) {
+        g_heap_live -= (int64_t)malloc_usable_size(ptr);
+    }
+    __libc_free(ptr);
+}
+#else
+#define BENCH_COUNT_HEAP 0
+#endif
+
+// ============================================================================
+// HARNESS
+// ============================================================================
+
+typedef struct {
+    const char *name;
+    void (*setup)(void);
+    void (*render)(void);
+} BenchCase;
+
+static Clay_Dimensions bench_measure_text(Clay_StringSlice text,
+        Clay_TextElementConfig *config, void *userData) {
+    (void)text;
+    (void)config;
+    (void)userData;
+    return (Clay_Dimensions){0};
+}
+
+static void bench_error_handler(Clay_ErrorData error) {
+    fprintf(stderr, "Clay error: %.*s\n",
+        (int)error.errorText.length, error.errorText.chars);
+}
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int g_bench_frame = 0;
+
+enum { BENCH_WARMUP_FRAMES = 10 };
+
+static void bench_frame(const BenchCase *bench) {
+    cr_begin_frame();
+    bench->render();
+    cr_end_frame();
+    g_bench_frame++;
+}
+
+static void bench_run(const BenchCase *bench, int frames) {
+    // Fresh runtime per workload so peaks are not inherited
+    cr_shutdown();
+    cr_init();
+    g_bench_frame = 0;
+    if (bench->setup) {
+        bench->setup();
+    }
+
+    for (int i = 0; i < BENCH_WARMUP_FRAMES; i++) {
+        bench_frame(bench);
+    }
+
+#if BENCH_COUNT_HEAP
+    uint64_t allocs_before = g_heap_allocs;
+    g_heap_peak = g_heap_live;
+#endif
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < frames; i++) {
+        bench_frame(bench);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    printf("%-16s %12.0f", bench->name, (double)elapsed / frames);
+#if BENCH_COUNT_HEAP
+    printf(" %12.1f %12lld",
+        (double)(g_heap_allocs - allocs_before) / frames,
+        (long long)g_heap_peak);
+#else
+    printf(" %12s %12s", "n/a", "n/a");
+#endif
+    printf(" %12zu\n", cr_runtime ? cr_runtime->peak_allocated : (size_t)0);
+}
+
+// ============================================================================
+// WORKLOADS
+// ============================================================================
+
+// Deep: one long chain of nested components
+enum { BENCH_DEEP_DEPTH = 256 };
+
+typedef struct {
+    int depth;
+} DepthProps;
+
+$component(DeepNode, DepthProps) {
+    Box((BoxParams){0}, ^{
+        if (props->depth > 0) {
+            DeepNode((DepthProps){ .depth = props->depth - 1 });
+        }
+    });
+}
+
+static void bench_deep(void) {
+    DeepNode((DepthProps){ .depth = BENCH_DEEP_DEPTH });
+}
+
+// Wide: many siblings under one parent
+enum { BENCH_WIDE_COUNT = 2000 };
+
+typedef struct {
+    int index;
+} ItemProps;
+
+$component(WideItem, ItemProps) {
+    Box((BoxParams){0}, ^{
+        Text((TextParams){ .text = props->index & 1 ? "odd item" : "even item" });
+    });
+}
+
+static void bench_wide(void) {
+    for (int i = 0; i < BENCH_WIDE_COUNT; i++) {
+        WideItem((ItemProps){ .index = i });
+    }
+}
+
+// Keyed: a keyed list reshuffled every frame
+enum { BENCH_KEYED_COUNT = 500 };
+
+static int g_keyed_order[BENCH_KEYED_COUNT];
+static uint32_t g_keyed_seed = 1;
+
+$component(KeyedItem, ItemProps) {
+    auto value = $use_state(props->index);
+    Text((TextParams){ .text = value->get() & 1 ? "odd" : "even" });
+}
+
+static void bench_keyed_setup(void) {
+    for (int i = 0; i < BENCH_KEYED_COUNT; i++) {
+        g_keyed_order[i] = i;
+    }
+    g_keyed_seed = 1;
+}
+
+static void bench_keyed(void) {
+    // Fisher-Yates with a fixed LCG so every run shuffles the same way
+    for (int i = BENCH_KEYED_COUNT - 1; i > 0; i--) {
+        g_keyed_seed = g_keyed_seed * 1664525u + 1013904223u;
+        int j = (int)(g_keyed_seed % (uint32_t)(i + 1));
+        int swap = g_keyed_order[i];
+        g_keyed_order[i] = g_keyed_order[j];
+        g_keyed_order[j] = swap;
+    }
+    for (int i = 0; i < BENCH_KEYED_COUNT; i++) {
+        $keyi_lit("KeyedItem", g_keyed_order[i]);
+        KeyedItem((ItemProps){ .index = g_keyed_order[i] });
+    }
+}
+
+// Hooks: components dominated by hook bookkeeping
+enum { BENCH_HOOK_COUNT = 300 };
+
+static int g_hook_sink = 0;
+
+$component(HookItem, ItemProps) {
+    auto a = $use_state(props->index);
+    auto b = $use_state(1);
+    auto c = $use_state(2);
+    auto d = $use_state(3);
+    auto ref = $use_ref(int, 0);
+    int sum = $use_memo(int, ^{
+        return a->get() + b->get() + c->get() + d->get();
+    }, $deps(a->get(), b->get(), c->get(), d->get()));
+    int frame = g_bench_frame;
+    int per_frame = $use_memo(int, ^{ return frame * 2; }, $deps(frame));
+    auto on_click = $use_callback(^{ g_hook_sink++; }, $deps(sum));
+    auto on_frame = $use_callback(^{ g_hook_sink += per_frame; }, $deps(per_frame));
+    if (ref) {
+        (*ref)++;
+    }
+    (void)on_click;
+    (void)on_frame;
+}
+
+static void bench_hooks(void) {
+    for (int i = 0; i < BENCH_HOOK_COUNT; i++) {
+        HookItem((ItemProps){ .index = i });
+    }
+}
+
+// Effects: every component re-runs an effect and its cleanup each frame
+enum { BENCH_EFFECT_COUNT = 500 };
+
+static int g_effect_sink = 0;
+
+$component(EffectItem, ItemProps) {
+    int frame = g_bench_frame;
+    int index = props->index;
+    $use_effect(^{
+        g_effect_sink += frame + index;
+        return (CleanupBlock)^{ g_effect_sink--; };
+    }, $deps(frame));
+    $use_layout_effect(^{
+        g_effect_sink++;
+        return (CleanupBlock)NULL;
+    }, $deps(frame));
+}
+
+static void bench_effects(void) {
+    for (int i = 0; i < BENCH_EFFECT_COUNT; i++) {
+        EffectItem((ItemProps){ .index = i });
+    }
+}
+
+// Context: consumers under a deep stack of providers
+enum {
+    BENCH_CONTEXT_DEPTH = 32,
+    BENCH_CONTEXT_CONSUMERS = 500,
+};
+
+typedef struct {
+    $field(int, value);
+} BenchTheme;
+
+static CR_Context *g_bench_theme = NULL;
+static int g_context_sink = 0;
+
+$component(ContextConsumer, ItemProps) {
+    BenchTheme *theme = $use_context(g_bench_theme);
+    g_context_sink += theme ? theme->value + (props->index & 1) : 0;
+}
+
+$component(ContextLevel, DepthProps) {
+    BenchTheme local = { .value = props->depth };
+    $provide(g_bench_theme, &local) {
+        if (props->depth > 0) {
+            ContextLevel((DepthProps){ .depth = props->depth - 1 });
+        } else {
+            for (int i = 0; i < BENCH_CONTEXT_CONSUMERS; i++) {
+                ContextConsumer((ItemProps){ .index = i });
+            }
+        }
+    }
+}
+
+static void bench_context_setup(void) {
+    BenchTheme fallback = { .value = 0 };
+    if (!g_bench_theme) {
+        g_bench_theme = $create_context(BenchTheme, &fallback);
+    }
+}
+
+static void bench_context(void) {
+    ContextLevel((DepthProps){ .depth = BENCH_CONTEXT_DEPTH });
+}
+
+// Textf: a flood of formatted labels, plain and memoized
+enum { BENCH_TEXTF_COUNT = 2000 };
+
+static void bench_textf(void) {
+    for (int i = 0; i < BENCH_TEXTF_COUNT; i++) {
+        Textf((TextParams){0}, "Row %d: %.2f (%s)", i, i * 0.5, i & 1 ? "odd" : "even");
+    }
+}
+
+static void bench_textf_memo(void) {
+    for (int i = 0; i < BENCH_TEXTF_COUNT; i++) {
+        Textf((TextParams){ .memo_id = $id_liti("BenchRow", i) },
+            "Row %d: %.2f (%s)", i, i * 0.5, i & 1 ? "odd" : "even");
+    }
+}
+
+static const BenchCase g_bench_cases[] = {
+    { "deep_tree", NULL, bench_deep },
+    { "wide_tree", NULL, bench_wide },
+    { "keyed_shuffle", bench_keyed_setup, bench_keyed },
+    { "hook_heavy", NULL, bench_hooks },
+    { "effect_storm", NULL, bench_effects },
+    { "context_heavy", bench_context_setup, bench_context },
+    { "textf_flood", NULL, bench_textf },
+    { "textf_memo", NULL, bench_textf_memo },
+};
+
+int main(int argc, char **argv) {
+    const char *filter = argc > 1 ? argv[1] : NULL;
+    int frames = argc > 2 ? atoi(argv[2]) : 200;
+    if (frames <= 0) {
+        frames = 200;
+    }
+
+    Clay_SetMaxElementCount(65536);
+    size_t memory_size = Clay_MinMemorySize();
+    Clay_Arena arena = {
+        .memory = calloc(1, memory_size),
+        .capacity = memory_size,
+    };
+    Clay_Initialize(arena, (Clay_Dimensions){ 1280.0f, 800.0f },
+        (Clay_ErrorHandler){ .errorHandlerFunction = bench_error_handler });
+    Clay_SetMeasureTextFunction(bench_measure_text, NULL);
+
+    printf("%-16s %12s %12s %12s %12s\n",
+        "workload", "ns/frame", "allocs/frame", "peak heap", "peak runtime");
+    for (size_t i = 0; i < sizeof(g_bench_cases) / sizeof(g_bench_cases[0]); i++) {
+        const BenchCase *bench = &g_bench_cases[i];
+        if (filter && strcmp(filter, "all") != 0 && strcmp(filter, bench->name) != 0) {
+            continue;
+        }
+        bench_run(bench, frames);
+    }
+
+    cr_shutdown();
+    free(arena.memory);
+    return 0;
+}
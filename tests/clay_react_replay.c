@@ -0,0 +1,379 @@
+/**
+ * Clay React replay - renderer cost of recorded frames
+ *
+ * Plays a trace recorded with CR_AppConfig.trace_path (or CR_APP_TRACE)
+ * through the renderer of the configured backend as fast as it will go:
+ * no app, no layout and no vsync, so the numbers cover drawing and
+ * presenting only. XCB and SDL3 draw into a window sized to each frame's
+ * viewport; other backends only decode the trace. Build in release mode;
+ * debug builds enable sanitizers, which skew timings.
+ *
+ * Usage: clay_react_replay <trace> [loops] [font]
+ */
+#include <clay.h>
+#include "clay_react/trace.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    uint64_t frames;
+    uint64_t repeats;
+    uint64_t commands;
+    uint64_t decode_ns;
+    uint64_t render_ns;
+    uint64_t present_ns;
+    uint64_t render_max_ns;
+    uint64_t present_max_ns;
+} ReplayStats;
+
+static uint64_t replay_now_ns(void) {
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void replay_add(uint64_t *total, uint64_t *max, uint64_t value) {
+    *total += value;
+    if (max && value > *max) {
+        *max = value;
+    }
+}
+
+// Apps load one font; traces keep the ids they were laid out with
+static void replay_single_font(Clay_RenderCommandArray commands) {
+    for (int32_t i = 0; i < commands.length; i++) {
+        Clay_RenderCommand *command = &commands.internalArray[i];
+        if (command->commandType == CLAY_RENDER_COMMAND_TYPE_TEXT) {
+            command->renderData.text.fontId = 0;
+        }
+    }
+}
+
+// ============================================================================
+// BACKENDS
+// ============================================================================
+
+#if defined(CLAY_RENDERER_XCB)
+
+#include <xcb/xcb.h>
+
+#include <clay/renderers/xcb/clay_renderer_xcb.c>
+
+typedef struct {
+    xcb_connection_t *connection;
+    xcb_window_t window;
+    Clay_XCB_Renderer renderer;
+    Clay_XCB_FontCollection *fonts;
+    bool ready;
+} ReplayTarget;
+
+static xcb_visualtype_t *replay_find_visual(xcb_screen_t *screen, xcb_visualid_t visual_id) {
+    xcb_depth_iterator_t depth_iter = xcb_screen_allowed_depths_iterator(screen);
+    for (; depth_iter.rem; xcb_depth_next(&depth_iter)) {
+        xcb_visualtype_iterator_t visual_iter = xcb_depth_visuals_iterator(depth_iter.data);
+        for (; visual_iter.rem; xcb_visualtype_next(&visual_iter)) {
+            if (visual_iter.data->visual_id == visual_id) {
+                return visual_iter.data;
+            }
+        }
+    }
+    return NULL;
+}
+
+// Replays at scale 1; CLAY_XCB_SCALE matches a HiDPI recording
+static float replay_scale(void) {
+    const char *value = getenv("CLAY_XCB_SCALE");
+    float scale = value ? strtof(value, NULL) : 0.0f;
+    return scale > 0.0f ? scale : 1.0f;
+}
+
+static bool replay_open(ReplayTarget *target, Clay_Dimensions viewport, const char *font_path) {
+    float scale = replay_scale();
+    int width = (int)(viewport.width * scale + 0.5f);
+    int height = (int)(viewport.height * scale + 0.5f);
+    if (width <= 0) width = 1;
+    if (height <= 0) height = 1;
+
+    target->connection = xcb_connect(NULL, NULL);
+    if (!target->connection || xcb_connection_has_error(target->connection)) {
+        fprintf(stderr, "Failed to connect to X server\n");
+        return false;
+    }
+    xcb_screen_t *screen = xcb_setup_roots_iterator(xcb_get_setup(target->connection)).data;
+    xcb_visualtype_t *visual = replay_find_visual(screen, screen->root_visual);
+    if (!visual) {
+        fprintf(stderr, "Failed to find visual for X screen\n");
+        return false;
+    }
+
+    target->window = xcb_generate_id(target->connection);
+    uint32_t values[] = { screen->black_pixel, XCB_EVENT_MASK_EXPOSURE };
+    xcb_create_window(target->connection, XCB_COPY_FROM_PARENT, target->window, screen->root,
+        0, 0, (uint16_t)width, (uint16_t)height, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+        screen->root_visual, XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK, values);
+    xcb_map_window(target->connection, target->window);
+    xcb_flush(target->connection);
+
+    if (!Clay_XCB_Init(&target->renderer, target->connection, screen, visual, target->window, width, height)) {
+        fprintf(stderr, "Failed to init XCB renderer\n");
+        return false;
+    }
+    target->renderer.scale = scale;
+    target->ready = true;
+
+    const char *font_paths[] = { font_path };
+    target->fonts = Clay_XCB_LoadFonts(font_paths, 1);
+    if (!target->fonts) {
+        fprintf(stderr, "Failed to load font %s\n", font_path);
+        return false;
+    }
+    target->renderer.fonts = target->fonts;
+    return true;
+}
+
+static void replay_resize(ReplayTarget *target, Clay_Dimensions viewport) {
+    int width = (int)(viewport.width * target->renderer.scale + 0.5f);
+    int height = (int)(viewport.height * target->renderer.scale + 0.5f);
+    if (width == target->renderer.width && height == target->renderer.height) return;
+    if (!Clay_XCB_Resize(&target->renderer, width, height)) return;
+    uint32_t size[] = { (uint32_t)width, (uint32_t)height };
+    xcb_configure_window(target->connection, target->window,
+        XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, size);
+}
+
+static bool replay_render(ReplayTarget *target, const CR_TraceFrame *frame) {
+    xcb_generic_event_t *event = NULL;
+    while ((event = xcb_poll_for_event(target->connection)) != NULL) {
+        free(event);
+    }
+    replay_resize(target, frame->viewport);
+    Clay_XCB_Clear(&target->renderer, frame->background);
+    Clay_XCB_Render(&target->renderer, frame->commands);
+    return true;
+}
+
+static void replay_present(ReplayTarget *target) {
+    Clay_XCB_Present(&target->renderer);
+}
+
+// Present only queues the image; wait for the server before timing ends
+static void replay_finish(ReplayTarget *target) {
+    free(xcb_get_input_focus_reply(target->connection, xcb_get_input_focus(target->connection), NULL));
+}
+
+static void replay_close(ReplayTarget *target) {
+    if (target->fonts) Clay_XCB_FreeFonts(target->fonts);
+    if (target->ready) Clay_XCB_Shutdown(&target->renderer);
+    if (target->connection) xcb_disconnect(target->connection);
+}
+
+#elif defined(CLAY_RENDERER_SDL3)
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <clay/renderers/SDL3/clay_renderer_SDL3.c>
+
+typedef struct {
+    SDL_Window *window;
+    Clay_SDL3RendererData data;
+    bool sdl_ready;
+    bool ttf_ready;
+} ReplayTarget;
+
+static bool replay_open(ReplayTarget *target, Clay_Dimensions viewport, const char *font_path) {
+    if (!SDL_Init(SDL_INIT_VIDEO)) {
+        fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError());
+        return false;
+    }
+    target->sdl_ready = true;
+    if (!TTF_Init()) {
+        fprintf(stderr, "Failed to init TTF: %s\n", SDL_GetError());
+        return false;
+    }
+    target->ttf_ready = true;
+
+    int width = viewport.width > 1.0f ? (int)viewport.width : 1;
+    int height = viewport.height > 1.0f ? (int)viewport.height : 1;
+    if (!SDL_CreateWindowAndRenderer("clay_react_replay", width, height, 0,
+            &target->window, &target->data.renderer)) {
+        fprintf(stderr, "Failed to create window: %s\n", SDL_GetError());
+        return false;
+    }
+    SDL_SetRenderVSync(target->data.renderer, 0);
+
+    target->data.textEngine = TTF_CreateRendererTextEngine(target->data.renderer);
+    target->data.fonts = SDL_calloc(1, sizeof(TTF_Font *));
+    if (!target->data.textEngine || !target->data.fonts) {
+        fprintf(stderr, "Failed to create text engine: %s\n", SDL_GetError());
+        return false;
+    }
+    target->data.fonts[0] = TTF_OpenFont(font_path, 16);
+    if (!target->data.fonts[0]) {
+        fprintf(stderr, "Failed to load font %s: %s\n", font_path, SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+static bool replay_render(ReplayTarget *target, const CR_TraceFrame *frame) {
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        if (event.type == SDL_EVENT_QUIT) return false;
+    }
+    int width = 0;
+    int height = 0;
+    SDL_GetWindowSize(target->window, &width, &height);
+    if (width != (int)frame->viewport.width || height != (int)frame->viewport.height) {
+        SDL_SetWindowSize(target->window, (int)frame->viewport.width, (int)frame->viewport.height);
+    }
+
+    Clay_Color background = frame->background;
+    SDL_SetRenderDrawColor(target->data.renderer,
+        (Uint8)background.r, (Uint8)background.g, (Uint8)background.b, (Uint8)background.a);
+    SDL_RenderClear(target->data.renderer);
+    Clay_RenderCommandArray commands = frame->commands;
+    SDL_Clay_RenderClayCommands(&target->data, &commands);
+    return true;
+}
+
+static void replay_present(ReplayTarget *target) {
+    SDL_RenderPresent(target->data.renderer);
+}
+
+static void replay_finish(ReplayTarget *target) {
+    (void)target;
+}
+
+static void replay_close(ReplayTarget *target) {
+    if (target->data.fonts) {
+        if (target->data.fonts[0]) TTF_CloseFont(target->data.fonts[0]);
+        SDL_free(target->data.fonts);
+    }
+    if (target->data.textEngine) TTF_DestroyRendererTextEngine(target->data.textEngine);
+    if (target->data.renderer) SDL_DestroyRenderer(target->data.renderer);
+    if (target->window) SDL_DestroyWindow(target->window);
+    if (target->ttf_ready) TTF_Quit();
+    if (target->sdl_ready) SDL_Quit();
+}
+
+#else
+
+// Decode-only: measures the trace reader, which every replay pays too
+typedef struct {
+    int unused;
+} ReplayTarget;
+
+static bool replay_open(ReplayTarget *target, Clay_Dimensions viewport, const char *font_path) {
+    (void)target;
+    (void)viewport;
+    (void)font_path;
+    fprintf(stderr, "No replay renderer for this backend; decoding only\n");
+    return true;
+}
+
+static bool replay_render(ReplayTarget *target, const CR_TraceFrame *frame) {
+    (void)target;
+    (void)frame;
+    return true;
+}
+
+static void replay_present(ReplayTarget *target) {
+    (void)target;
+}
+
+static void replay_finish(ReplayTarget *target) {
+    (void)target;
+}
+
+static void replay_close(ReplayTarget *target) {
+    (void)target;
+}
+
+#endif
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <trace> [loops] [font]\n", argv[0]);
+        return 2;
+    }
+    int loops = argc > 2 ? atoi(argv[2]) : 1;
+    if (loops <= 0) {
+        loops = 1;
+    }
+    const char *font_path = argc > 3 ? argv[3] : "resources/Roboto-Regular.ttf";
+
+    CR_TraceReader *reader = cr_trace_reader_open(argv[1]);
+    if (!reader) return 1;
+
+    CR_TraceFrame frame = {0};
+    if (!cr_trace_read_frame(reader, &frame)) {
+        fprintf(stderr, "%s has no frames\n", argv[1]);
+        cr_trace_reader_close(reader);
+        return 1;
+    }
+    cr_trace_reader_rewind(reader);
+
+    ReplayTarget target = {0};
+    if (!replay_open(&target, frame.viewport, font_path)) {
+        replay_close(&target);
+        cr_trace_reader_close(reader);
+        return 1;
+    }
+
+    ReplayStats stats = {0};
+    bool running = true;
+    uint64_t started = replay_now_ns();
+    for (int loop = 0; loop < loops && running; loop++) {
+        cr_trace_reader_rewind(reader);
+        for (;;) {
+            uint64_t t0 = replay_now_ns();
+            if (!cr_trace_read_frame(reader, &frame)) break;
+            replay_single_font(frame.commands);
+            uint64_t t1 = replay_now_ns();
+            if (!replay_render(&target, &frame)) {
+                running = false;
+                break;
+            }
+            uint64_t t2 = replay_now_ns();
+            replay_present(&target);
+            uint64_t t3 = replay_now_ns();
+
+            stats.frames++;
+            stats.repeats += frame.repeat ? 1 : 0;
+            stats.commands += (uint64_t)frame.commands.length;
+            replay_add(&stats.decode_ns, NULL, t1 - t0);
+            replay_add(&stats.render_ns, &stats.render_max_ns, t2 - t1);
+            replay_add(&stats.present_ns, &stats.present_max_ns, t3 - t2);
+        }
+    }
+    replay_finish(&target);
+    uint64_t elapsed = replay_now_ns() - started;
+
+    if (stats.frames == 0) {
+        fprintf(stderr, "No frames replayed\n");
+    } else {
+        double frames = (double)stats.frames;
+        printf("%llu frames (%llu repeats), %.1f commands/frame, %.1f frames/s\n",
+            (unsigned long long)stats.frames, (unsigned long long)stats.repeats,
+            (double)stats.commands / frames, frames * 1e9 / (double)(elapsed ? elapsed : 1));
+        printf("%-8s %12s %12s\n", "stage", "ns/frame", "max ns");
+        printf("%-8s %12.0f %12s\n", "decode", (double)stats.decode_ns / frames, "-");
+        printf("%-8s %12.0f %12llu\n", "render", (double)stats.render_ns / frames,
+            (unsigned long long)stats.render_max_ns);
+        printf("%-8s %12.0f %12llu\n", "present", (double)stats.present_ns / frames,
+            (unsigned long long)stats.present_max_ns);
+    }
+
+    replay_close(&target);
+    cr_trace_reader_close(reader);
+    return stats.frames > 0 ? 0 : 1;
+}
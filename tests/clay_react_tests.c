@@ -4,7 +4,9 @@
 #define CLAY_IMPLEMENTATION
 #include <clay.h>
 #include "clay_react/clay_react.h"
+#include "clay_react/trace.h"
 
+#include <pthread.h>
 #include <setjmp.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -667,6 +669,1099 @@ TEST_CASE(test_use_id) {
     EXPECT_TRUE(id_equal(first_b, g_id_b));
 }
 
+static bool element_id_equal(Clay_ElementId a, Clay_ElementId b) {
+    return a.id == b.id && a.offset == b.offset && a.baseId == b.baseId &&
+        a.stringId.length == b.stringId.length;
+}
+
+TEST_CASE(test_id_hash) {
+    // Precomputed hashes finish into the same ids Clay derives from the string
+    EXPECT_TRUE(element_id_equal($id("HashedBox"), CLAY_ID("HashedBox")));
+    EXPECT_TRUE(element_id_equal($idi("HashedRow", 7), CLAY_IDI("HashedRow", 7)));
+    EXPECT_TRUE(element_id_equal(cr_element_id(cr_id("HashedBox")), CLAY_ID("HashedBox")));
+    EXPECT_TRUE(element_id_equal(cr_element_id(cr_idi("HashedRow", 7)), CLAY_IDI("HashedRow", 7)));
+    EXPECT_FALSE(element_id_equal($idi("HashedRow", 7), $idi("HashedRow", 8)));
+
+    // Bytes past ASCII hash the way Clay adds them
+    Clay_ElementId clay_utf8 = Clay_GetElementId(CLAY_STRING("Gr\xc3\xb6\xc3\x9f" "e"));
+    EXPECT_TRUE(element_id_equal(cr_element_id($id_lit("Gr\xc3\xb6\xc3\x9f" "e")), clay_utf8));
+    EXPECT_TRUE(element_id_equal(cr_element_id(cr_id("Gr\xc3\xb6\xc3\x9f" "e")), clay_utf8));
+
+    CR_Id lit = $id_lit("HashedBox");
+    EXPECT_TRUE(cr_id_is_hashed(lit));
+    EXPECT_EQ(lit.length, (uint32_t)9);
+    EXPECT_EQ(lit.hash, cr_id_hashed("HashedBox").hash);
+
+    // $use_id carries its hash so element ids skip the name scan
+    cr_begin_frame();
+    IdRoot();
+    cr_end_frame();
+    EXPECT_TRUE(cr_id_is_hashed(g_id_a));
+    EXPECT_TRUE(element_id_equal(cr_element_id(g_id_a), CLAY_IDI("TestId", g_id_a.index)));
+}
+
+TEST_CASE(test_str) {
+    CR_Str lit = $lit("Help pane");
+    EXPECT_EQ(lit.length, (uint32_t)9);
+    EXPECT_TRUE(lit.is_static);
+    EXPECT_FALSE(cr_str("Help pane").is_static);
+    EXPECT_TRUE(cr_str_equal(lit, cr_str("Help pane")));
+    EXPECT_FALSE(cr_str_equal(lit, cr_str("Help")));
+
+    // Equal contents intern to one runtime-owned copy
+    char scratch[16];
+    snprintf(scratch, sizeof(scratch), "%s", "Settings");
+    CR_Str a = cr_intern(scratch);
+    snprintf(scratch, sizeof(scratch), "%s", "Profile");
+    CR_Str b = cr_intern(scratch);
+    CR_Str c = cr_intern("Settings");
+    EXPECT_TRUE(a.is_static);
+    EXPECT_TRUE(a.chars == c.chars);
+    EXPECT_TRUE(a.chars != b.chars);
+    EXPECT_TRUE(a.chars != scratch);
+    EXPECT_EQ(a.hash, cr_hash_bytes("Settings", 8));
+    EXPECT_STREQ(a.chars, "Settings");
+
+    // Survives table growth
+    for (int i = 0; i < 200; i++) {
+        snprintf(scratch, sizeof(scratch), "label-%d", i);
+        cr_intern(scratch);
+    }
+    EXPECT_TRUE(cr_intern("Settings").chars == a.chars);
+
+    Clay_String clay = cr_clay_string(lit);
+    EXPECT_TRUE(clay.isStaticallyAllocated);
+    EXPECT_EQ(clay.length, (int32_t)9);
+}
+
+static const CR_Style *compiled_button_style(void) {
+    return $style(CR_STYLE_BUTTON, .background_hover = { 10, 20, 30, 255 });
+}
+
+TEST_CASE(test_compiled_style) {
+    // Component defaults are folded into the template
+    CR_Style button = cr_style_compile(CR_STYLE_BUTTON, (ViewStyle){0});
+    EXPECT_EQ(button.decl.backgroundColor.b, $BLUE.b);
+    EXPECT_EQ(button.decl.cornerRadius.topLeft, 6.0f);
+    EXPECT_EQ(button.decl.layout.padding.left, (uint16_t)16);
+    EXPECT_FALSE(button.has_background_hover);
+
+    CR_Style input = cr_style_compile(CR_STYLE_TEXT_INPUT, (ViewStyle){0});
+    EXPECT_EQ(input.decl.border.width.left, (uint16_t)1);
+
+    CR_Style column = cr_style_compile(CR_STYLE_COLUMN, (ViewStyle){0});
+    EXPECT_EQ((int)column.decl.layout.layoutDirection, (int)CLAY_TOP_TO_BOTTOM);
+
+    // $style resolves once per call site
+    const CR_Style *first = compiled_button_style();
+    const CR_Style *second = compiled_button_style();
+    EXPECT_TRUE(first == second);
+    EXPECT_TRUE(first->has_background_hover);
+
+    // Only id and hover background are patched per instance
+    Clay_ElementId eid = CLAY_ID("CompiledButton");
+    Clay_ElementDeclaration decl = _cr_style_instance(first, eid, true);
+    EXPECT_EQ(decl.id.id, eid.id);
+    EXPECT_EQ(decl.backgroundColor.r, 10.0f);
+    decl = _cr_style_instance(first, eid, false);
+    EXPECT_EQ(decl.backgroundColor.b, $BLUE.b);
+
+    cr_begin_frame();
+    Button((ButtonParams){ .id = $id_lit("CompiledButton"), .compiled = first, .label_str = $lit("Go") }, NULL);
+    cr_end_frame();
+
+    // Column stacks its children even when a compiled style says otherwise
+    init_clay_once();
+    cr_begin_frame();
+    Column((BoxParams){ .compiled = $style(CR_STYLE_BOX, .layout = { .padding = { 0 } }) }, ^{
+        Box((BoxParams){
+            .id = $id_lit("CompiledTop"),
+            .style = { .layout = { .sizing = { CLAY_SIZING_FIXED(50), CLAY_SIZING_FIXED(50) } } },
+        }, NULL);
+        Box((BoxParams){
+            .id = $id_lit("CompiledBottom"),
+            .style = { .layout = { .sizing = { CLAY_SIZING_FIXED(50), CLAY_SIZING_FIXED(50) } } },
+        }, NULL);
+    });
+    cr_end_frame();
+    Clay_ElementData top = Clay_GetElementData($id("CompiledTop"));
+    Clay_ElementData bottom = Clay_GetElementData($id("CompiledBottom"));
+    ASSERT_TRUE(top.found && bottom.found);
+    EXPECT_EQ(bottom.boundingBox.x, top.boundingBox.x);
+    EXPECT_EQ(bottom.boundingBox.y, top.boundingBox.y + 50.0f);
+}
+
+static int g_hover_entered = 0;
+static int g_hover_exited = 0;
+static int g_inner_scrolls = 0;
+static int g_outer_scrolls = 0;
+static float g_scroll_dy = 0.0f;
+
+static void render_hover_tree(void) {
+    cr_begin_frame();
+    Box((BoxParams){
+        .id = $id_lit("HoverOuter"),
+        .style = { .layout = { .sizing = { CLAY_SIZING_FIXED(200), CLAY_SIZING_FIXED(200) } } },
+        .on_scroll = ^(ScrollEvent *event) { (void)event; g_outer_scrolls++; },
+    }, ^{
+        Box((BoxParams){
+            .id = $id_lit("HoverInner"),
+            .style = { .layout = { .sizing = { CLAY_SIZING_FIXED(100), CLAY_SIZING_FIXED(100) } } },
+            .on_hover = ^(HoverEvent *event) {
+                if (event->entered) g_hover_entered++;
+                if (event->exited) g_hover_exited++;
+            },
+            .on_scroll = ^(ScrollEvent *event) { g_inner_scrolls++; g_scroll_dy = event->dy; },
+        }, NULL);
+    });
+    cr_end_frame();
+}
+
+TEST_CASE(test_hover_scroll_events) {
+    g_hover_entered = g_hover_exited = 0;
+    g_inner_scrolls = g_outer_scrolls = 0;
+
+    cr_set_pointer_state((Clay_Vector2){ 500, 500 }, false);
+    render_hover_tree();
+
+    // Entering fires once, staying put fires nothing
+    cr_set_pointer_state((Clay_Vector2){ 50, 50 }, false);
+    render_hover_tree();
+    EXPECT_EQ(g_hover_entered, 1);
+    EXPECT_TRUE(cr_is_hovered(CLAY_ID("HoverInner")));
+    EXPECT_TRUE(cr_is_hovered(CLAY_ID("HoverOuter")));
+    render_hover_tree();
+    EXPECT_EQ(g_hover_entered, 1);
+    EXPECT_EQ(g_hover_exited, 0);
+
+    // Wheel goes to the innermost handler only
+    cr_update_scroll((Clay_Vector2){ 0, -30 }, 0.016f);
+    EXPECT_EQ(g_inner_scrolls, 1);
+    EXPECT_EQ(g_outer_scrolls, 0);
+    EXPECT_EQ(g_scroll_dy, -30.0f);
+
+    cr_set_pointer_state((Clay_Vector2){ 150, 150 }, false);
+    EXPECT_TRUE(cr_should_render());
+    render_hover_tree();
+    EXPECT_EQ(g_hover_exited, 1);
+    EXPECT_FALSE(cr_is_hovered(CLAY_ID("HoverInner")));
+
+    cr_update_scroll((Clay_Vector2){ 0, -30 }, 0.016f);
+    EXPECT_EQ(g_inner_scrolls, 1);
+    EXPECT_EQ(g_outer_scrolls, 1);
+}
+
+static bool g_paint_reads_hover = false;
+
+static void render_paint_tree(void) {
+    cr_begin_frame();
+    Row((BoxParams){ .id = $id_lit("PaintRow") }, ^{
+        for (uint32_t i = 0; i < 2; i++) {
+            Box((BoxParams){
+                .id = $id_liti("PaintCell", i),
+                .style = {
+                    .layout = { .sizing = { CLAY_SIZING_FIXED(100), CLAY_SIZING_FIXED(100) } },
+                    .background = $rgb(10, 10, 10),
+                    .background_hover = $rgb(200, 200, 200),
+                },
+            }, NULL);
+        }
+        if (g_paint_reads_hover) {
+            (void)cr_is_hovered(CLAY_ID("PaintRow"));
+        }
+    });
+    cr_end_frame();
+}
+
+static float paint_cell_red(Clay_RenderCommandArray commands, uint32_t index) {
+    Clay_ElementId eid = cr_element_id($id_liti("PaintCell", index));
+    for (int32_t i = 0; i < commands.length; i++) {
+        Clay_RenderCommand *command = Clay_RenderCommandArray_Get(&commands, i);
+        if (command->id == eid.id && command->commandType == CLAY_RENDER_COMMAND_TYPE_RECTANGLE) {
+            return command->renderData.rectangle.backgroundColor.r;
+        }
+    }
+    return -1.0f;
+}
+
+TEST_CASE(test_paint_frame) {
+    CR_Runtime *main_runtime = cr_runtime;
+    CR_Runtime *runtime = cr_runtime_create((Clay_Dimensions){ 800.0f, 600.0f },
+        (Clay_ErrorHandler){ .errorHandlerFunction = test_error_handler });
+    ASSERT_NOT_NULL(runtime);
+    cr_runtime_make_current(runtime);
+    g_paint_reads_hover = false;
+
+    Clay_RenderCommandArray commands = {0};
+    cr_set_pointer_state((Clay_Vector2){ 500, 500 }, false);
+    render_paint_tree();
+    EXPECT_FALSE(cr_paint_frame(&commands));
+
+    // Entering a cell recolors it in place
+    cr_set_pointer_state((Clay_Vector2){ 50, 50 }, false);
+    EXPECT_TRUE(cr_should_render());
+    EXPECT_TRUE(cr_paint_frame(&commands));
+    EXPECT_EQ(paint_cell_red(commands, 0), 200.0f);
+    EXPECT_EQ(paint_cell_red(commands, 1), 10.0f);
+    EXPECT_FALSE(cr_should_render());
+
+    cr_set_pointer_state((Clay_Vector2){ 150, 50 }, false);
+    EXPECT_TRUE(cr_paint_frame(&commands));
+    EXPECT_EQ(paint_cell_red(commands, 0), 10.0f);
+    EXPECT_EQ(paint_cell_red(commands, 1), 200.0f);
+    EXPECT_EQ(runtime->paint_frames, (uint64_t)2);
+
+    // A full frame agrees with the patched one
+    render_paint_tree();
+    EXPECT_EQ(paint_cell_red(runtime->paint_commands, 1), 200.0f);
+
+    // State changes and renders that read hover themselves need full frames
+    cr_set_pointer_state((Clay_Vector2){ 50, 50 }, false);
+    cr_request_render();
+    EXPECT_FALSE(cr_paint_frame(&commands));
+    g_paint_reads_hover = true;
+    render_paint_tree();
+    cr_set_pointer_state((Clay_Vector2){ 150, 50 }, false);
+    EXPECT_FALSE(cr_paint_frame(&commands));
+    EXPECT_EQ(runtime->paint_frames, (uint64_t)2);
+
+    // The last frame is reused as is only while nothing wants a new one
+    render_paint_tree();
+    EXPECT_TRUE(cr_last_frame(&commands));
+    EXPECT_EQ(commands.length, runtime->paint_commands.length);
+    cr_request_render();
+    EXPECT_FALSE(cr_last_frame(&commands));
+
+    cr_runtime_make_current(main_runtime);
+    cr_runtime_destroy(runtime);
+}
+
+static char g_route_log[128];
+static bool g_route_stop_capture = false;
+static bool g_route_handle_key = false;
+
+static void route_log(const char *entry) {
+    strncat(g_route_log, entry, sizeof(g_route_log) - strlen(g_route_log) - 1);
+}
+
+$component(RouteChild) {
+    Clay_ElementId child_id = $id("RouteInner");
+    $on_event_capture(child_id, CR_EVENT_KEY, ^(CR_Event *event) {
+        route_log(event->phase == CR_PHASE_TARGET ? "child-target-capture;" : "child-capture;");
+    });
+    $on_event(child_id, CR_EVENT_KEY, ^(CR_Event *event) {
+        route_log(event->phase == CR_PHASE_TARGET ? "child-target;" : "child-bubble;");
+    });
+    $on_key(child_id, ^(KeyEvent *key) {
+        route_log("child-key;");
+        key->handled = g_route_handle_key;
+    });
+    Box((BoxParams){
+        .id = $id_lit("RouteInner"),
+        .style = { .layout = { .sizing = { CLAY_SIZING_FIXED(50), CLAY_SIZING_FIXED(50) } } },
+        .on_click = ^{ route_log("inner-click;"); },
+    }, NULL);
+}
+
+$component(RouteRoot) {
+    Clay_ElementId root_id = $id("RouteRoot");
+    $on_event_capture(root_id, CR_EVENT_KEY, ^(CR_Event *event) {
+        route_log("root-capture;");
+        if (g_route_stop_capture) cr_stop_propagation(event);
+    });
+    $on_event(root_id, CR_EVENT_KEY, ^(CR_Event *event) {
+        (void)event;
+        route_log("root-bubble;");
+    });
+    $on_event_capture(root_id, CR_EVENT_CLICK, ^(CR_Event *event) {
+        (void)event;
+        route_log("outer-capture;");
+    });
+    Box((BoxParams){
+        .id = $id_lit("RouteRoot"),
+        .style = { .layout = { .sizing = { CLAY_SIZING_FIXED(200), CLAY_SIZING_FIXED(200) } } },
+        .on_click = ^{ route_log("outer-click;"); },
+    }, ^{
+        RouteChild();
+        Box((BoxParams){
+            .id = $id_lit("RouteSibling"),
+            .style = { .layout = { .sizing = { CLAY_SIZING_FIXED(50), CLAY_SIZING_FIXED(50) } } },
+            .on_key = ^(KeyEvent *key) { (void)key; route_log("sibling-key;"); },
+        }, NULL);
+    });
+}
+
+TEST_CASE(test_event_routing) {
+    g_route_stop_capture = false;
+    g_route_handle_key = false;
+    g_route_log[0] = '\0';
+
+    cr_set_pointer_state((Clay_Vector2){ 10, 10 }, false);
+    cr_begin_frame();
+    RouteRoot();
+    cr_end_frame();
+
+    // Keys travel the focused element's ancestors; the sibling never sees
+    // them, and a typed handler only stops them by marking them handled
+    cr_set_focus($id("RouteInner"));
+    EXPECT_EQ(cr_focused_element(), $id("RouteInner").id);
+    EXPECT_FALSE(cr_dispatch_key((KeyEvent){ .keycode = 'k', .is_press = true }));
+    EXPECT_STREQ(g_route_log, "root-capture;child-target-capture;child-target;child-key;root-bubble;");
+
+    g_route_log[0] = '\0';
+    g_route_handle_key = true;
+    EXPECT_TRUE(cr_dispatch_key((KeyEvent){ .keycode = 'k', .is_press = true }));
+    EXPECT_STREQ(g_route_log, "root-capture;child-target-capture;child-target;child-key;");
+
+    // Focus on the sibling reaches it and the root, not the child
+    g_route_log[0] = '\0';
+    cr_set_focus($id("RouteSibling"));
+    EXPECT_FALSE(cr_dispatch_key((KeyEvent){ .keycode = 'k', .is_press = true }));
+    EXPECT_STREQ(g_route_log, "root-capture;sibling-key;root-bubble;");
+
+    g_route_log[0] = '\0';
+    g_route_stop_capture = true;
+    EXPECT_TRUE(cr_dispatch_key((KeyEvent){ .keycode = 'k', .is_press = true }));
+    EXPECT_STREQ(g_route_log, "root-capture;");
+
+    // An untracked target reaches only the top-level key listeners, which
+    // the frame listed per event type
+    g_route_log[0] = '\0';
+    g_route_stop_capture = false;
+    cr_set_focus(CLAY_ID("RouteNowhere"));
+    EXPECT_FALSE(cr_dispatch_key((KeyEvent){ .keycode = 'k', .is_press = true }));
+    EXPECT_STREQ(g_route_log, "root-capture;root-bubble;");
+    EXPECT_EQ(cr_runtime->top_listeners[CR_EVENT_KEY].count, (size_t)2);
+    cr_set_focus((Clay_ElementId){0});
+
+    // Clicks capture from the outside in, then the innermost handler wins
+    cr_set_pointer_state((Clay_Vector2){ 10, 10 }, false);
+    cr_begin_frame();
+    RouteRoot();
+    cr_end_frame();
+    cr_set_pointer_state((Clay_Vector2){ 10, 10 }, true);
+    g_route_log[0] = '\0';
+    _cr_dispatch_clicks();
+    EXPECT_STREQ(g_route_log, "outer-capture;inner-click;");
+
+    // Outside the inner box the outer handler is the target
+    cr_set_pointer_state((Clay_Vector2){ 150, 150 }, true);
+    g_route_log[0] = '\0';
+    _cr_dispatch_clicks();
+    EXPECT_STREQ(g_route_log, "outer-capture;outer-click;");
+}
+
+static CR_TextInputState *g_key_edit_input = NULL;
+static int g_key_edit_shortcuts = 0;
+
+$component(KeyEditForm) {
+    auto input = $use_text_input(16);
+    if (!g_key_edit_input && input) {
+        g_key_edit_input = input;
+        _cr_text_input_set_text(input, "abc");
+    }
+    Box((BoxParams){
+        .id = $id_lit("KeyEditRoot"),
+        .on_key = ^(KeyEvent *key) { (void)key; g_key_edit_shortcuts++; },
+    }, ^{
+        TextInput((TextInputParams){ .id = $id_lit("KeyEditField"), .state = input });
+    });
+}
+
+TEST_CASE(test_key_shortcut_keeps_editing) {
+    g_key_edit_input = NULL;
+    g_key_edit_shortcuts = 0;
+
+    cr_begin_frame();
+    KeyEditForm();
+    cr_end_frame();
+    ASSERT_NOT_NULL(g_key_edit_input);
+
+    // A window-wide handler that leaves the key unhandled doesn't swallow
+    // the field's editing
+    _cr_focus_input(g_key_edit_input, $id("KeyEditField").id);
+    _cr_handle_key((KeyEvent){ .keycode = CR_KEY_BACKSPACE, .is_press = true });
+    EXPECT_EQ(g_key_edit_shortcuts, 1);
+    EXPECT_STREQ(_cr_text_input_text(g_key_edit_input), "ab");
+    _cr_focus_input(NULL, 0);
+}
+
+static uint64_t g_scroll_clock_ns = 0;
+
+static uint64_t test_scroll_clock(void *user_data) {
+    (void)user_data;
+    return g_scroll_clock_ns;
+}
+
+static void test_scroll_frame(uint64_t advance_ns) {
+    g_scroll_clock_ns += advance_ns;
+    cr_begin_frame();
+    cr_end_frame();
+}
+
+TEST_CASE(test_scroll_momentum) {
+    g_scroll_clock_ns = 1000000000ull;
+    cr_set_clock(test_scroll_clock, NULL);
+    test_scroll_frame(0);
+
+    // A wheel step glides over several frames instead of jumping
+    cr_update_scroll((Clay_Vector2){ 0, -6 }, 0.1f);
+    EXPECT_TRUE(cr_should_render());
+    test_scroll_frame(16666667ull);
+    EXPECT_TRUE(cr_runtime->scroll_remaining.y < 0.0f);
+    EXPECT_TRUE(cr_runtime->scroll_remaining.y > -60.0f);
+    EXPECT_TRUE(cr_is_animating());
+    for (int i = 0; i < 120 && cr_is_animating(); i++) {
+        test_scroll_frame(16666667ull);
+    }
+    EXPECT_TRUE(cr_runtime->scroll_remaining.y == 0.0f);
+    test_scroll_frame(16666667ull);
+    EXPECT_FALSE(cr_is_animating());
+
+    // Progress depends on elapsed time, not on how many frames drew it
+    cr_update_scroll((Clay_Vector2){ 0, -6 }, 0.1f);
+    for (int i = 0; i < 3; i++) {
+        test_scroll_frame(16666667ull);
+    }
+    float at_60hz = cr_runtime->scroll_remaining.y;
+    cr_runtime->scroll_remaining = (Clay_Vector2){0};
+    cr_update_scroll((Clay_Vector2){ 0, -6 }, 0.1f);
+    for (int i = 0; i < 6; i++) {
+        test_scroll_frame(8333333ull);
+    }
+    float at_120hz = cr_runtime->scroll_remaining.y;
+    EXPECT_TRUE(at_60hz - at_120hz < 0.01f && at_120hz - at_60hz < 0.01f);
+    cr_runtime->scroll_remaining = (Clay_Vector2){0};
+
+    // Dragging where nothing scrolls never coasts
+    cr_set_pointer_state((Clay_Vector2){ 10, 10 }, false);
+    cr_set_pointer_state((Clay_Vector2){ 10, 10 }, true);
+    test_scroll_frame(16666667ull);
+    cr_set_pointer_state((Clay_Vector2){ 10, 40 }, true);
+    test_scroll_frame(16666667ull);
+    cr_set_pointer_state((Clay_Vector2){ 10, 40 }, false);
+    EXPECT_FALSE(cr_runtime->scroll_coasting);
+
+    // A plain click never coasts
+    cr_set_pointer_state((Clay_Vector2){ 10, 40 }, true);
+    cr_set_pointer_state((Clay_Vector2){ 10, 40 }, false);
+    EXPECT_FALSE(cr_runtime->scroll_coasting);
+
+    cr_set_clock(NULL, NULL);
+}
+
+static float g_scroll_list_top = 0.0f;
+static uint32_t g_scroll_rows = 10;
+
+static void render_scroll_tree(void) {
+    cr_begin_frame();
+    Column((BoxParams){ .id = $id_lit("ScrollPage") }, ^{
+        Box((BoxParams){
+            .style = { .layout = { .sizing = { CLAY_SIZING_FIXED(10), CLAY_SIZING_FIXED(g_scroll_list_top) } } },
+        }, NULL);
+        Column((BoxParams){
+            .id = $id_lit("ScrollList"),
+            .scroll_y = true,
+            .style = { .layout = { .sizing = { CLAY_SIZING_FIXED(200), CLAY_SIZING_FIXED(100) } } },
+        }, ^{
+            for (uint32_t i = 0; i < g_scroll_rows; i++) {
+                Box((BoxParams){
+                    .id = $id_liti("ScrollRow", i),
+                    .style = {
+                        .layout = { .sizing = { CLAY_SIZING_FIXED(200), CLAY_SIZING_FIXED(20) } },
+                        .background = $rgb(10, 10, 10),
+                    },
+                }, NULL);
+            }
+        });
+    });
+    cr_end_frame();
+}
+
+static float scroll_row_y(Clay_RenderCommandArray commands, uint32_t index) {
+    Clay_ElementId eid = cr_element_id($id_liti("ScrollRow", index));
+    for (int32_t i = 0; i < commands.length; i++) {
+        Clay_RenderCommand *command = Clay_RenderCommandArray_Get(&commands, i);
+        if (command->id == eid.id && command->commandType == CLAY_RENDER_COMMAND_TYPE_RECTANGLE) {
+            return command->boundingBox.y;
+        }
+    }
+    return -1000.0f;
+}
+
+TEST_CASE(test_scroll_translation) {
+    CR_Runtime *main_runtime = cr_runtime;
+    CR_Runtime *runtime = cr_runtime_create((Clay_Dimensions){ 800.0f, 600.0f },
+        (Clay_ErrorHandler){ .errorHandlerFunction = test_error_handler });
+    ASSERT_NOT_NULL(runtime);
+    cr_runtime_make_current(runtime);
+    g_scroll_clock_ns = 1000000000ull;
+    cr_set_clock(test_scroll_clock, NULL);
+    g_scroll_list_top = 0.0f;
+
+    Clay_RenderCommandArray commands = {0};
+    render_scroll_tree();
+    cr_set_pointer_state((Clay_Vector2){ 50, 50 }, false);
+    EXPECT_FALSE(cr_scroll_frame(&commands));
+
+    // A wheel glide moves the cached rows without another layout
+    cr_update_scroll((Clay_Vector2){ 0, -4 }, 0.1f);
+    g_scroll_clock_ns += 16666667ull;
+    EXPECT_TRUE(cr_scroll_frame(&commands));
+    EXPECT_TRUE(scroll_row_y(commands, 3) < 60.0f);
+    EXPECT_TRUE(cr_layout_translated());
+    for (int i = 0; i < 120 && runtime->scroll_remaining.y != 0.0f; i++) {
+        g_scroll_clock_ns += 16666667ull;
+        EXPECT_TRUE(cr_scroll_frame(&commands));
+    }
+    float translated = scroll_row_y(commands, 3);
+    EXPECT_TRUE(translated > 19.99f && translated < 20.01f);
+
+    // The glide's end asks for a full frame, which agrees
+    EXPECT_TRUE(runtime->needs_render);
+    EXPECT_FALSE(cr_scroll_frame(&commands));
+    g_scroll_clock_ns += 16666667ull;
+    render_scroll_tree();
+    float laid_out = scroll_row_y(runtime->paint_commands, 3);
+    EXPECT_TRUE(laid_out - translated < 0.01f && translated - laid_out < 0.01f);
+    EXPECT_FALSE(cr_layout_translated());
+
+    // Rows Clay culled below the window need a layout to appear
+    g_scroll_list_top = 500.0f;
+    render_scroll_tree();
+    render_scroll_tree();
+    cr_set_pointer_state((Clay_Vector2){ 50, 550 }, false);
+    uint64_t served = runtime->scroll_frames;
+    cr_update_scroll((Clay_Vector2){ 0, -4 }, 0.1f);
+    g_scroll_clock_ns += 16666667ull;
+    EXPECT_FALSE(cr_scroll_frame(&commands));
+    EXPECT_TRUE(runtime->needs_render);
+    EXPECT_EQ(runtime->scroll_frames, served);
+
+    // The frame laid out mid-glide keeps them, and the glide goes on
+    g_scroll_clock_ns += 16666667ull;
+    render_scroll_tree();
+    EXPECT_TRUE(runtime->scroll_overscan);
+    EXPECT_TRUE(scroll_row_y(runtime->paint_commands, 6) > 600.0f);
+    g_scroll_clock_ns += 16666667ull;
+    EXPECT_TRUE(cr_scroll_frame(&commands));
+
+    cr_set_clock(NULL, NULL);
+    cr_runtime_make_current(main_runtime);
+    cr_runtime_destroy(runtime);
+}
+
+// Drags ScrollList up 30 px over one 60 Hz frame, releases it, then coasts
+// at the given frame interval. Returns the distance coasted after half a
+// second; *duration is how long coasting lasted.
+static float drag_coast(uint64_t frame_ns, float *duration) {
+    Clay_ScrollContainerData data = Clay_GetScrollContainerData(cr_element_id($id_lit("ScrollList")));
+    if (!data.found) return 0.0f;
+    $cast_nonnull(data.scrollPosition)->y = 0.0f;
+
+    cr_set_pointer_state((Clay_Vector2){ 50, 80 }, true);
+    g_scroll_clock_ns += 16666667ull;
+    render_scroll_tree();
+    cr_set_pointer_state((Clay_Vector2){ 50, 50 }, true);
+    g_scroll_clock_ns += 16666667ull;
+    render_scroll_tree();
+    cr_set_pointer_state((Clay_Vector2){ 50, 50 }, false);
+
+    float released = $cast_nonnull(data.scrollPosition)->y;
+    float coasted = 0.0f;
+    int frames = 0;
+    while (cr_runtime->scroll_coasting && frames < 10000) {
+        g_scroll_clock_ns += frame_ns;
+        render_scroll_tree();
+        frames++;
+        if ((uint64_t)frames == (500000000ull + frame_ns / 2) / frame_ns) {
+            coasted = $cast_nonnull(data.scrollPosition)->y - released;
+        }
+    }
+    *duration = (float)((double)frames * (double)frame_ns / 1e9);
+    return coasted;
+}
+
+TEST_CASE(test_scroll_drag_coast) {
+    CR_Runtime *main_runtime = cr_runtime;
+    CR_Runtime *runtime = cr_runtime_create((Clay_Dimensions){ 800.0f, 600.0f },
+        (Clay_ErrorHandler){ .errorHandlerFunction = test_error_handler });
+    ASSERT_NOT_NULL(runtime);
+    cr_runtime_make_current(runtime);
+    g_scroll_clock_ns = 1000000000ull;
+    cr_set_clock(test_scroll_clock, NULL);
+    g_scroll_list_top = 0.0f;
+    g_scroll_rows = 40;
+
+    cr_set_pointer_state((Clay_Vector2){ 50, 80 }, false);
+    render_scroll_tree();
+    render_scroll_tree();
+
+    // The content follows the pointer, then keeps going after the release
+    float duration_60 = 0.0f;
+    float coasted_60 = drag_coast(16666667ull, &duration_60);
+    EXPECT_TRUE(coasted_60 < -100.0f);
+    EXPECT_TRUE(duration_60 > 0.5f);
+
+    // Distance and duration follow elapsed time, not the frame rate
+    float duration_144 = 0.0f;
+    float coasted_144 = drag_coast(6944444ull, &duration_144);
+    EXPECT_TRUE(coasted_60 - coasted_144 < 0.5f && coasted_144 - coasted_60 < 0.5f);
+    EXPECT_TRUE(duration_60 - duration_144 < 0.02f && duration_144 - duration_60 < 0.02f);
+
+    g_scroll_rows = 10;
+    cr_set_clock(NULL, NULL);
+    cr_runtime_make_current(main_runtime);
+    cr_runtime_destroy(runtime);
+}
+
+TEST_CASE(test_scroll_wheel_distance) {
+    CR_Runtime *main_runtime = cr_runtime;
+    CR_Runtime *runtime = cr_runtime_create((Clay_Dimensions){ 800.0f, 600.0f },
+        (Clay_ErrorHandler){ .errorHandlerFunction = test_error_handler });
+    ASSERT_NOT_NULL(runtime);
+    cr_runtime_make_current(runtime);
+    g_scroll_clock_ns = 1000000000ull;
+    cr_set_clock(test_scroll_clock, NULL);
+    g_scroll_list_top = 0.0f;
+    g_scroll_rows = 40;
+
+    render_scroll_tree();
+    cr_set_pointer_state((Clay_Vector2){ 50, 50 }, false);
+    render_scroll_tree();
+
+    // One notch moves as far as Clay_UpdateScrollContainers would: 10 px
+    // per unit of the backends' 30-unit delta
+    cr_update_scroll((Clay_Vector2){ 0, -30 }, 0.1f);
+    for (int i = 0; i < 120 && runtime->scroll_remaining.y != 0.0f; i++) {
+        g_scroll_clock_ns += 16666667ull;
+        render_scroll_tree();
+    }
+    Clay_ScrollContainerData data = Clay_GetScrollContainerData(cr_element_id($id_lit("ScrollList")));
+    ASSERT_TRUE(data.found);
+    float moved = $cast_nonnull(data.scrollPosition)->y;
+    EXPECT_TRUE(moved > -300.01f && moved < -299.99f);
+
+    g_scroll_rows = 10;
+    cr_set_clock(NULL, NULL);
+    cr_runtime_make_current(main_runtime);
+    cr_runtime_destroy(runtime);
+}
+
+TEST_CASE(test_scroll_taller_than_window) {
+    CR_Runtime *main_runtime = cr_runtime;
+    CR_Runtime *runtime = cr_runtime_create((Clay_Dimensions){ 800.0f, 100.0f },
+        (Clay_ErrorHandler){ .errorHandlerFunction = test_error_handler });
+    ASSERT_NOT_NULL(runtime);
+    cr_runtime_make_current(runtime);
+    g_scroll_clock_ns = 1000000000ull;
+    cr_set_clock(test_scroll_clock, NULL);
+    g_scroll_list_top = 0.0f;
+
+    // The list fills the window and its rows run past the bottom edge
+    Clay_RenderCommandArray commands = {0};
+    render_scroll_tree();
+    cr_set_pointer_state((Clay_Vector2){ 50, 50 }, false);
+    render_scroll_tree();
+    EXPECT_FALSE(runtime->scroll_overscan);
+    EXPECT_TRUE(scroll_row_y(runtime->paint_commands, 6) < -999.0f);
+
+    // The idle frame was culled to the window, so the first step lays out
+    cr_update_scroll((Clay_Vector2){ 0, -4 }, 0.1f);
+    g_scroll_clock_ns += 16666667ull;
+    EXPECT_FALSE(cr_scroll_frame(&commands));
+    EXPECT_TRUE(runtime->needs_render);
+    g_scroll_clock_ns += 16666667ull;
+    render_scroll_tree();
+    EXPECT_TRUE(runtime->scroll_overscan);
+    EXPECT_TRUE(scroll_row_y(runtime->paint_commands, 6) > 100.0f);
+
+    // The rest of the glide runs on that frame
+    uint64_t served = runtime->scroll_frames;
+    for (int i = 0; i < 120 && runtime->scroll_remaining.y != 0.0f; i++) {
+        g_scroll_clock_ns += 16666667ull;
+        EXPECT_TRUE(cr_scroll_frame(&commands));
+    }
+    EXPECT_TRUE(runtime->scroll_frames > served);
+    float translated = scroll_row_y(commands, 3);
+    EXPECT_TRUE(translated > 19.99f && translated < 20.01f);
+
+    // Once settled, frames cull to the window again
+    EXPECT_TRUE(runtime->needs_render);
+    g_scroll_clock_ns += 16666667ull;
+    render_scroll_tree();
+    EXPECT_FALSE(runtime->scroll_overscan);
+    EXPECT_TRUE(scroll_row_y(runtime->paint_commands, 8) < -999.0f);
+
+    cr_set_clock(NULL, NULL);
+    cr_runtime_make_current(main_runtime);
+    cr_runtime_destroy(runtime);
+}
+
+static CR_Str test_memo_format(uint32_t key, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    CR_Str str = _cr_format_memo_v(key, fmt, args);
+    va_end(args);
+    return str;
+}
+
+TEST_CASE(test_formatted_text) {
+    cr_begin_frame();
+
+    // Built-in formatters agree with printf
+    char expected[128];
+    CR_Str str = cr_format("Count: %d %i %u %x %X %c %s %%", -42, 7, 4000000000u, 255u, 255u, 'z', "ok");
+    snprintf(expected, sizeof(expected), "Count: %d %i %u %x %X %c %s %%", -42, 7, 4000000000u, 255u, 255u, 'z', "ok");
+    EXPECT_STREQ(str.chars, expected);
+    EXPECT_EQ((size_t)str.length, strlen(expected));
+
+    str = cr_format("%.2f|%f|%.0f|%.3s|%lld|%zu", 3.14159, -0.5, 2.5, "abcdef", -9000000000000ll, (size_t)12);
+    EXPECT_STREQ(str.chars, "3.14|-0.500000|2|abc|-9000000000000|12");
+
+    // Fixed-point rounding follows the exact binary value, not the scaled one
+    static const double rounding[] = { 0.015, 2.675, 1.005, 0.125, 0.375, 1.45, -8.345, 123.4565, 1e-7, 0.999999 };
+    for (size_t i = 0; i < sizeof(rounding) / sizeof(rounding[0]); i++) {
+        for (int precision = 0; precision <= 6; precision++) {
+            // A literal precision, since %.*f always takes snprintf
+            char spec[8];
+            snprintf(spec, sizeof(spec), "%%.%df", precision);
+            str = cr_format(spec, rounding[i]);
+            snprintf(expected, sizeof(expected), spec, rounding[i]);
+            EXPECT_STREQ(str.chars, expected);
+        }
+    }
+    str = cr_format("%.2f|%.2f", 0.015, 2.675);
+    EXPECT_STREQ(str.chars, "0.01|2.67");
+
+    // Flags, widths and %e take the snprintf path
+    str = cr_format("[%5d|%-4s|%08.3f|%e|%*d]", 42, "ab", 3.14159, 1500.0, 3, 7);
+    snprintf(expected, sizeof(expected), "[%5d|%-4s|%08.3f|%e|%*d]", 42, "ab", 3.14159, 1500.0, 3, 7);
+    EXPECT_STREQ(str.chars, expected);
+
+    // Earlier strings survive the arena growing past a chunk
+    CR_Str first = cr_format("first %d", 1);
+    for (int i = 0; i < 4000; i++) {
+        cr_format("filler %d", i);
+    }
+    EXPECT_STREQ(first.chars, "first 1");
+    cr_end_frame();
+
+    // Memoized text is reused until an argument changes
+    static const char *memo_fmt = "Value: %d (%s)";
+    cr_begin_frame();
+    CR_Str a = test_memo_format(77, memo_fmt, 5, "five");
+    cr_end_frame();
+    cr_begin_frame();
+    CR_Str b = test_memo_format(77, memo_fmt, 5, "five");
+    EXPECT_TRUE(a.chars == b.chars);
+    EXPECT_STREQ(b.chars, "Value: 5 (five)");
+
+    // A second, different use in the same frame must not clobber the first
+    CR_Str c = test_memo_format(77, memo_fmt, 6, "six");
+    EXPECT_STREQ(b.chars, "Value: 5 (five)");
+    EXPECT_STREQ(c.chars, "Value: 6 (six)");
+    cr_end_frame();
+
+    cr_begin_frame();
+    CR_Str d = test_memo_format(77, memo_fmt, 6, "six");
+    EXPECT_STREQ(d.chars, "Value: 6 (six)");
+    cr_end_frame();
+
+    // Long doubles differing only in exponent are different arguments
+    cr_begin_frame();
+    CR_Str one = test_memo_format(78, "%Lf", 1.0L);
+    EXPECT_STREQ(one.chars, "1.000000");
+    cr_end_frame();
+    cr_begin_frame();
+    CR_Str two = test_memo_format(78, "%Lf", 2.0L);
+    EXPECT_STREQ(two.chars, "2.000000");
+    cr_end_frame();
+}
+
+static int g_mono_measures = 0;
+
+// 10px per byte, so line breaks are easy to predict
+static Clay_Dimensions test_mono_measure_text(Clay_StringSlice text,
+        Clay_TextElementConfig *config, void *userData) {
+    (void)config;
+    (void)userData;
+    g_mono_measures++;
+    return (Clay_Dimensions){ (float)text.length * 10.0f, 20.0f };
+}
+
+static char g_log_text[16384];
+
+$component(ParagraphTestComponent) {
+    Box((BoxParams){
+        .id = $id_lit("LogView"),
+        .style = { .layout = { .sizing = { CLAY_SIZING_FIXED(400), CLAY_SIZING_FIXED(200) } } },
+        .scroll_y = true,
+    }, ^{
+        Paragraph((ParagraphParams){
+            .id = $id_lit("LogText"),
+            .text = g_log_text,
+            .clip_id = $id_lit("LogView"),
+        });
+    });
+}
+
+TEST_CASE(test_paragraph) {
+    init_clay_once();
+    cr_set_measure_text(test_mono_measure_text, NULL);
+    Clay_TextElementConfig config = { .fontSize = 16, .lineHeight = 24 };
+
+    // Greedy breaks at spaces, hard breaks at newlines
+    const char *text = "aaa bbb ccc\ndd";
+    const CR_ParagraphLines *lines = _cr_paragraph_lines(901, cr_string(text), &config, 75.0f);
+    ASSERT_NOT_NULL(lines);
+    ASSERT_EQ(lines->line_count, (size_t)3);
+    EXPECT_EQ(lines->lines[0].start, 0u);
+    EXPECT_EQ(lines->lines[0].end, 7u);
+    EXPECT_EQ(lines->lines[1].start, 8u);
+    EXPECT_EQ(lines->lines[1].end, 11u);
+    EXPECT_EQ(lines->lines[2].start, 12u);
+
+    // Unchanged text is not measured again
+    g_mono_measures = 0;
+    lines = _cr_paragraph_lines(901, cr_string(text), &config, 75.0f);
+    EXPECT_EQ(g_mono_measures, 0);
+
+    // Appending rewraps only the last line: a space and its four words
+    lines = _cr_paragraph_lines(901, cr_string("aaa bbb ccc\ndd ee ff gg"), &config, 75.0f);
+    ASSERT_EQ(lines->line_count, (size_t)4);
+    EXPECT_EQ(g_mono_measures, 5);
+    EXPECT_EQ(lines->lines[2].end, 17u);
+    EXPECT_EQ(lines->lines[3].start, 18u);
+    EXPECT_EQ(lines->lines[3].end, 23u);
+
+    // A new width rebreaks everything
+    lines = _cr_paragraph_lines(901, cr_string("aaa bbb ccc\ndd ee ff gg"), &config, 1000.0f);
+    EXPECT_EQ(lines->line_count, (size_t)2);
+
+    // Only lines inside the scroll clip get text elements
+    size_t used = 0;
+    for (int i = 0; i < 500; i++) {
+        used += (size_t)snprintf(g_log_text + used, sizeof(g_log_text) - used, "line %d\n", i);
+    }
+    for (int frame = 0; frame < 2; frame++) {
+        cr_begin_frame();
+        ParagraphTestComponent();
+        Clay_RenderCommandArray commands = cr_end_frame();
+        if (frame == 0) continue;
+
+        int text_commands = 0;
+        for (int32_t i = 0; i < commands.length; i++) {
+            if (Clay_RenderCommandArray_Get(&commands, i)->commandType == CLAY_RENDER_COMMAND_TYPE_TEXT) {
+                text_commands++;
+            }
+        }
+        EXPECT_TRUE(text_commands > 0);
+        EXPECT_TRUE(text_commands < 20);
+    }
+
+    cr_set_measure_text(test_measure_text, NULL);
+}
+
+// ============================================================================
+// SNAPSHOT TESTS
+// ============================================================================
+
+typedef struct {
+    int volume;
+    float brightness;
+} SnapPrefs;
+
+typedef struct {
+    const char *label;
+} SnapLabel;
+
+typedef struct {
+    int row;
+} SnapRowProps;
+
+static int g_snap_counts[2] = {0, 0};
+static SnapPrefs g_snap_prefs[2];
+static const char *g_snap_labels[2] = {NULL, NULL};
+static void (^g_snap_set_count[2])(int) = {NULL, NULL};
+static void (^g_snap_set_prefs[2])(SnapPrefs) = {NULL, NULL};
+static void (^g_snap_set_label[2])(SnapLabel) = {NULL, NULL};
+static bool g_snap_swap = false;
+
+$component(SnapRow, SnapRowProps) {
+    auto count = $use_state(0);
+    auto prefs = $use_typed_state(SnapPrefs, ((SnapPrefs){ .volume = 1, .brightness = 0.5f }));
+    auto label = $use_typed_state(SnapLabel, ((SnapLabel){ .label = "initial" }));
+    g_snap_counts[props->row] = count->get();
+    g_snap_prefs[props->row] = prefs->get();
+    g_snap_labels[props->row] = label->get().label;
+    g_snap_set_count[props->row] = count->set;
+    g_snap_set_prefs[props->row] = prefs->set;
+    g_snap_set_label[props->row] = label->set;
+}
+
+$component(SnapRoot) {
+    for (int i = 0; i < 2; i++) {
+        int row = g_snap_swap ? 1 - i : i;
+        $keyi_lit("SnapRow", row);
+        SnapRow((SnapRowProps){ .row = row });
+    }
+}
+
+$component(SnapOther) {
+}
+
+TEST_CASE(test_state_snapshot) {
+    const char *path = "clay_react_snapshot_test.bin";
+    g_snap_swap = false;
+
+    cr_begin_frame();
+    SnapRoot();
+    cr_end_frame();
+    ASSERT_NOT_NULL(g_snap_set_count[1]);
+    g_snap_set_count[0](10);
+    g_snap_set_count[1](20);
+    g_snap_set_prefs[1]((SnapPrefs){ .volume = 7, .brightness = 0.25f });
+    g_snap_set_label[0]((SnapLabel){ .label = "changed" });
+    cr_begin_frame();
+    SnapRoot();
+    cr_end_frame();
+    EXPECT_EQ(g_snap_counts[1], 20);
+    ASSERT_TRUE(cr_snapshot_write(path));
+
+    // Unmount everything, then remount from the snapshot in another order
+    cr_begin_frame();
+    SnapOther();
+    cr_end_frame();
+    ASSERT_TRUE(cr_snapshot_restore(path));
+    g_snap_swap = true;
+    cr_begin_frame();
+    SnapRoot();
+    cr_end_frame();
+
+    // Untyped state is left out; typed state follows its key
+    EXPECT_EQ(g_snap_counts[0], 0);
+    EXPECT_EQ(g_snap_counts[1], 0);
+    EXPECT_EQ(g_snap_prefs[0].volume, 1);
+    EXPECT_EQ(g_snap_prefs[1].volume, 7);
+    EXPECT_TRUE(g_snap_prefs[1].brightness == 0.25f);
+    // Pointer-holding state is never saved
+    EXPECT_STREQ(g_snap_labels[0], "initial");
+
+    // Anything that is not a snapshot is rejected
+    FILE *file = fopen(path, "wb");
+    ASSERT_NOT_NULL(file);
+    fputs("not a snapshot", file);
+    fclose(file);
+    EXPECT_FALSE(cr_snapshot_restore(path));
+    remove(path);
+}
+
+// ============================================================================
+// FRAME TRACE TESTS
+// ============================================================================
+
+TEST_CASE(test_frame_trace) {
+    const char *path = "clay_react_trace_test.bin";
+    Clay_RenderCommand commands[5] = {
+        {
+            .boundingBox = { 0, 0, 200, 100 },
+            .renderData.clip = { .horizontal = false, .vertical = true },
+            .id = 1,
+            .commandType = CLAY_RENDER_COMMAND_TYPE_SCISSOR_START,
+        },
+        {
+            .boundingBox = { 4, 8, 60, 20 },
+            .renderData.rectangle = { .backgroundColor = { 10, 20, 30, 255 }, .cornerRadius = { 3, 3, 3, 3 } },
+            .id = 2,
+            .zIndex = 2,
+            .commandType = CLAY_RENDER_COMMAND_TYPE_RECTANGLE,
+        },
+        {
+            .boundingBox = { 4, 8, 60, 20 },
+            .renderData.border = { .color = { 1, 2, 3, 4 }, .width = { 1, 2, 3, 4, 5 } },
+            .id = 3,
+            .commandType = CLAY_RENDER_COMMAND_TYPE_BORDER,
+        },
+        {
+            .boundingBox = { 6, 10, 40, 16 },
+            .renderData.text = {
+                .stringContents = { .length = 5, .chars = "hello world", .baseChars = "hello world" },
+                .textColor = { 255, 255, 255, 255 },
+                .fontId = 0,
+                .fontSize = 14,
+            },
+            .id = 4,
+            .commandType = CLAY_RENDER_COMMAND_TYPE_TEXT,
+        },
+        {
+            .boundingBox = { 0, 0, 200, 100 },
+            .id = 1,
+            .commandType = CLAY_RENDER_COMMAND_TYPE_SCISSOR_END,
+        },
+    };
+    Clay_RenderCommandArray array = { .capacity = 5, .length = 5, .internalArray = commands };
+    Clay_Dimensions viewport = { 200, 100 };
+    Clay_Color background = { 9, 9, 9, 255 };
+
+    CR_TraceWriter *writer = cr_trace_writer_open(path);
+    ASSERT_NOT_NULL(writer);
+    EXPECT_TRUE(cr_trace_write_frame(writer, viewport, background, 100, array));
+    EXPECT_TRUE(cr_trace_write_frame(writer, viewport, background, 200, array));
+    commands[1].renderData.rectangle.backgroundColor.r = 99;
+    EXPECT_TRUE(cr_trace_write_frame(writer, viewport, background, 300, array));
+    cr_trace_writer_close(writer);
+
+    CR_TraceReader *reader = cr_trace_reader_open(path);
+    ASSERT_NOT_NULL(reader);
+    CR_TraceFrame frame = {0};
+    for (int pass = 0; pass < 2; pass++) {
+        ASSERT_TRUE(cr_trace_read_frame(reader, &frame));
+        EXPECT_EQ(frame.index, 0u);
+        EXPECT_FALSE(frame.repeat);
+        EXPECT_TRUE(frame.viewport.width == 200 && frame.viewport.height == 100);
+        EXPECT_TRUE(frame.background.r == 9);
+        EXPECT_EQ(frame.time_ns, (uint64_t)100);
+        ASSERT_EQ(frame.commands.length, 5);
+        Clay_RenderCommand *decoded = frame.commands.internalArray;
+        EXPECT_TRUE(decoded[0].commandType == CLAY_RENDER_COMMAND_TYPE_SCISSOR_START);
+        EXPECT_TRUE(decoded[0].renderData.clip.vertical && !decoded[0].renderData.clip.horizontal);
+        EXPECT_EQ(decoded[1].zIndex, 2);
+        EXPECT_TRUE(decoded[1].renderData.rectangle.backgroundColor.r == 10);
+        EXPECT_TRUE(decoded[1].renderData.rectangle.cornerRadius.bottomRight == 3);
+        EXPECT_EQ(decoded[2].renderData.border.width.betweenChildren, 5);
+        EXPECT_EQ(decoded[3].id, 4u);
+        EXPECT_EQ(decoded[3].renderData.text.fontSize, 14);
+        EXPECT_EQ(decoded[3].renderData.text.stringContents.length, 5);
+        EXPECT_TRUE(memcmp(decoded[3].renderData.text.stringContents.chars, "hello", 5) == 0);
+        EXPECT_TRUE(decoded[4].commandType == CLAY_RENDER_COMMAND_TYPE_SCISSOR_END);
+
+        // The unchanged frame is stored as a repeat of the first
+        ASSERT_TRUE(cr_trace_read_frame(reader, &frame));
+        EXPECT_TRUE(frame.repeat);
+        EXPECT_EQ(frame.time_ns, (uint64_t)200);
+        EXPECT_EQ(frame.commands.length, 5);
+
+        // Text seen before is referenced rather than stored again
+        ASSERT_TRUE(cr_trace_read_frame(reader, &frame));
+        EXPECT_FALSE(frame.repeat);
+        EXPECT_EQ(frame.index, 2u);
+        EXPECT_TRUE(frame.commands.internalArray[1].renderData.rectangle.backgroundColor.r == 99);
+        EXPECT_TRUE(memcmp(frame.commands.internalArray[3].renderData.text.stringContents.chars, "hello", 5) == 0);
+        EXPECT_FALSE(cr_trace_read_frame(reader, &frame));
+        cr_trace_reader_rewind(reader);
+    }
+    cr_trace_reader_close(reader);
+
+    // Anything that is not a trace is rejected
+    FILE *file = fopen(path, "wb");
+    ASSERT_NOT_NULL(file);
+    fputs("not a trace", file);
+    fclose(file);
+    EXPECT_TRUE(cr_trace_reader_open(path) == NULL);
+    remove(path);
+}
+
 // ============================================================================
 // TEXT INPUT TESTS
 // ============================================================================
@@ -683,9 +1778,7 @@ $component(TextInputTestComponent) {
     }
     if (input) {
         g_input_len = input->length;
-        if (input->buffer) {
-            snprintf(g_input_buf, sizeof(g_input_buf), "%s", input->buffer);
-        }
+        snprintf(g_input_buf, sizeof(g_input_buf), "%s", _cr_text_input_text(input));
     }
 }
 
@@ -710,6 +1803,193 @@ TEST_CASE(test_text_input) {
     EXPECT_STREQ(g_input_buf, "hi");
 }
 
+TEST_CASE(test_text_input_editing) {
+    CR_TextInputState *input = _cr_alloc_text_input(0);
+    ASSERT_NOT_NULL(input);
+
+    // Cursor steps whole code points: "h\u00e9llo w\u00f6rld"
+    _cr_text_input_set_text(input, "h\xc3\xa9llo w\xc3\xb6rld");
+    EXPECT_EQ(input->length, (size_t)13);
+    _cr_text_input_move(input, CR_TEXT_MOVE_LINE, -1, false);
+    _cr_text_input_move_cursor(input, 2);
+    EXPECT_EQ(input->cursor_pos, (size_t)3);
+    _cr_text_input_backspace(input);
+    EXPECT_STREQ(_cr_text_input_text(input), "hllo w\xc3\xb6rld");
+
+    // Word-wise movement and deletion
+    _cr_text_input_move(input, CR_TEXT_MOVE_WORD, 1, false);
+    EXPECT_EQ(input->cursor_pos, (size_t)4);
+    _cr_text_input_move(input, CR_TEXT_MOVE_WORD, 1, false);
+    EXPECT_EQ(input->cursor_pos, (size_t)11);
+    _cr_text_input_erase(input, CR_TEXT_MOVE_WORD, -1);
+    EXPECT_STREQ(_cr_text_input_text(input), "hllo ");
+
+    // Typing replaces the selection
+    _cr_text_input_move(input, CR_TEXT_MOVE_WORD, -1, true);
+    size_t start = 0;
+    size_t end = 0;
+    EXPECT_TRUE(_cr_text_input_selection(input, &start, &end));
+    EXPECT_EQ(start, (size_t)0);
+    EXPECT_EQ(end, (size_t)5);
+    _cr_text_input_insert(input, "hey");
+    EXPECT_STREQ(_cr_text_input_text(input), "hey");
+    EXPECT_FALSE(_cr_text_input_selection(input, &start, &end));
+
+    // Large inserts grow the buffer instead of truncating
+    size_t big = 1 << 16;
+    char *chunk = malloc(big + 1);
+    ASSERT_NOT_NULL(chunk);
+    memset(chunk, 'x', big);
+    chunk[big] = '\0';
+    _cr_text_input_move_cursor(input, -1);
+    _cr_text_input_insert(input, chunk);
+    EXPECT_EQ(input->length, big + 3);
+    EXPECT_EQ(input->cursor_pos, big + 2);
+    const char *text = _cr_text_input_text(input);
+    EXPECT_TRUE(text[1] == 'e');
+    EXPECT_TRUE(text[big + 2] == 'y');
+    free(chunk);
+
+    _cr_text_input_select_all(input);
+    _cr_text_input_delete(input);
+    EXPECT_EQ(input->length, (size_t)0);
+    EXPECT_STREQ(_cr_text_input_text(input), "");
+
+    _cr_free_text_input(input);
+}
+
+static size_t g_view_before = 0;
+static size_t g_view_after = 0;
+
+TEST_CASE(test_text_input_view) {
+    CR_TextInputState *input = _cr_alloc_text_input(0);
+    ASSERT_NOT_NULL(input);
+    _cr_text_input_set_text(input, "hello world");
+    _cr_text_input_move_cursor(input, -6);
+
+    // on_change sees the two pieces around the edit; the gap stays put
+    g_view_before = 0;
+    g_view_after = 0;
+    input->on_change = ^(CR_TextView text) {
+        g_view_before = text.before_length;
+        g_view_after = text.after_length;
+    };
+    _cr_text_input_insert(input, "X");
+    EXPECT_EQ(g_view_before, (size_t)6);
+    EXPECT_EQ(g_view_after, (size_t)6);
+    EXPECT_EQ(input->gap_start, (size_t)6);
+
+    CR_TextView middle = _cr_text_input_view(input, 4, 8);
+    EXPECT_EQ(middle.before_length, (size_t)2);
+    EXPECT_TRUE(memcmp(middle.before, "oX", 2) == 0);
+    EXPECT_EQ(middle.after_length, (size_t)2);
+    EXPECT_TRUE(memcmp(middle.after, " w", 2) == 0);
+
+    char small[8];
+    EXPECT_EQ(_cr_text_input_copy(input, small, sizeof(small)), (size_t)12);
+    EXPECT_STREQ(small, "helloX ");
+    char full[32];
+    _cr_text_input_copy(input, full, sizeof(full));
+    EXPECT_STREQ(full, "helloX world");
+
+    // Rendering lays out both pieces without closing the gap
+    cr_begin_frame();
+    TextInput((TextInputParams){ .id = $id_lit("GapField"), .state = input });
+    cr_end_frame();
+    EXPECT_EQ(input->gap_start, (size_t)6);
+
+    input->on_change = NULL;
+    _cr_free_text_input(input);
+}
+
+static CR_TextInputState *g_area_input = NULL;
+
+$component(TextAreaTestComponent) {
+    auto input = $use_text_input(0);
+    if (!g_area_input && input) {
+        g_area_input = input;
+        char *text = malloc(1000 * 5 + 1);
+        for (int i = 0; i < 1000; i++) {
+            memcpy(text + i * 5, "line\n", 5);
+        }
+        text[1000 * 5 - 1] = '\0';
+        _cr_text_input_set_text(input, text);
+        free(text);
+    }
+    TextArea((TextAreaParams){
+        .id = $id_lit("TestArea"),
+        .state = input,
+        .style = { .layout = { .sizing = { .width = CLAY_SIZING_FIXED(400), .height = CLAY_SIZING_FIXED(300) } } },
+    });
+}
+
+TEST_CASE(test_text_area) {
+    // The line index follows edits without a rescan
+    CR_TextInputState *input = _cr_alloc_text_input(0);
+    ASSERT_NOT_NULL(input);
+    _cr_text_input_set_text(input, "ab\ncd\nef");
+    ASSERT_TRUE(_cr_text_input_enable_lines(input));
+    EXPECT_EQ(input->line_count, (size_t)3);
+
+    _cr_text_input_move_cursor(input, -4);
+    _cr_text_input_insert(input, "X\nY");
+    EXPECT_STREQ(_cr_text_input_text(input), "ab\ncX\nYd\nef");
+    ASSERT_EQ(input->line_count, (size_t)4);
+    EXPECT_EQ(input->line_starts[1], (size_t)3);
+    EXPECT_EQ(input->line_starts[2], (size_t)6);
+    EXPECT_EQ(input->line_starts[3], (size_t)9);
+
+    input->selection_start = 1;
+    input->cursor_pos = input->selection_end = 7;
+    _cr_text_input_delete(input);
+    EXPECT_STREQ(_cr_text_input_text(input), "ad\nef");
+    ASSERT_EQ(input->line_count, (size_t)2);
+    EXPECT_EQ(input->line_starts[1], (size_t)3);
+    EXPECT_EQ(_cr_text_input_line_at(input, 4), (size_t)1);
+
+    // Up/down keep the column
+    _cr_text_input_move_vertical(input, 1, false);
+    EXPECT_EQ(input->cursor_pos, (size_t)4);
+    _cr_free_text_input(input);
+
+    // Only the viewport's lines are laid out
+    g_area_input = NULL;
+    for (int frame = 0; frame < 2; frame++) {
+        cr_begin_frame();
+        TextAreaTestComponent();
+        cr_end_frame();
+    }
+    ASSERT_NOT_NULL(g_area_input);
+    EXPECT_EQ(g_area_input->line_count, (size_t)1000);
+    Clay_ElementId area = $id("TestArea");
+    EXPECT_TRUE(Clay_GetElementData(_cr_text_area_line_id(area, 3)).found);
+    EXPECT_FALSE(Clay_GetElementData(_cr_text_area_line_id(area, 500)).found);
+
+    // A line split by the gap renders from both pieces and the gap stays
+    g_area_input->cursor_pos = g_area_input->selection_start = g_area_input->selection_end = 12;
+    _cr_text_input_insert(g_area_input, "Z");
+    EXPECT_EQ(g_area_input->gap_start, (size_t)13);
+    cr_begin_frame();
+    TextAreaTestComponent();
+    cr_end_frame();
+    EXPECT_EQ(g_area_input->gap_start, (size_t)13);
+    EXPECT_TRUE(Clay_GetElementData(_cr_text_area_line_id(area, 2)).found);
+
+    // Scrolled just under the top padding past line 10, line 9's bottom
+    // still shows and it is laid out there, not left to the spacer
+    Clay_ElementData area_data = Clay_GetElementData(area);
+    float line_height = Clay_GetElementData(_cr_text_area_line_id(area, 3)).boundingBox.height;
+    Clay_ScrollContainerData scroll = Clay_GetScrollContainerData(area);
+    ASSERT_TRUE(area_data.found && scroll.found && line_height > 0.0f);
+    $cast_nonnull(scroll.scrollPosition)->y = -(10.0f * line_height + 5.0f);
+    cr_begin_frame();
+    TextAreaTestComponent();
+    cr_end_frame();
+    Clay_BoundingBox line_9 = Clay_GetElementData(_cr_text_area_line_id(area, 9)).boundingBox;
+    EXPECT_TRUE(line_9.y < area_data.boundingBox.y);
+    EXPECT_TRUE(line_9.y + line_9.height > area_data.boundingBox.y);
+}
+
 // ============================================================================
 // CLICK HANDLER PROPS TEST
 // ============================================================================
@@ -862,6 +2142,622 @@ TEST_CASE(test_signal) {
     EXPECT_EQ(g_signal_value, 5);
 }
 
+// ============================================================================
+// CROSS-THREAD POST TESTS
+// ============================================================================
+
+static int g_post_wakes = 0;
+static int g_post_order[3] = {0, 0, 0};
+static int g_post_count = 0;
+static int g_post_seen = -1;
+static void (^g_post_set)(int) = NULL;
+
+static void test_post_wake(void *user_data) {
+    (void)user_data;
+    g_post_wakes++;
+}
+
+$component(PostTestComponent) {
+    auto value = $use_state(0);
+    if (!g_post_set) g_post_set = value->set;
+    g_post_seen = value->get();
+}
+
+TEST_CASE(test_post) {
+    g_post_wakes = 0;
+    g_post_count = 0;
+    g_post_seen = -1;
+    g_post_set = NULL;
+
+    cr_begin_frame();
+    PostTestComponent();
+    cr_end_frame();
+    ASSERT_NOT_NULL(g_post_set);
+
+    cr_set_wake_handler(test_post_wake, NULL);
+    for (int i = 0; i < 3; i++) {
+        int tag = i + 1;
+        EXPECT_TRUE(cr_post(^{ g_post_order[g_post_count++] = tag; }));
+    }
+    EXPECT_TRUE(cr_post(^{ g_post_set(9); }));
+
+    // Wakeups are coalesced until the queue is drained
+    EXPECT_EQ(g_post_wakes, 1);
+    EXPECT_TRUE(cr_should_render());
+    EXPECT_EQ(g_post_count, 0);
+
+    cr_begin_frame();
+    PostTestComponent();
+    cr_end_frame();
+
+    EXPECT_EQ(g_post_count, 3);
+    EXPECT_EQ(g_post_order[0], 1);
+    EXPECT_EQ(g_post_order[1], 2);
+    EXPECT_EQ(g_post_order[2], 3);
+    EXPECT_EQ(g_post_seen, 9);
+
+    cr_post(^{ });
+    EXPECT_EQ(g_post_wakes, 2);
+    cr_set_wake_handler(NULL, NULL);
+}
+
+static bool g_post_worker_plain = true;
+static bool g_post_worker_targeted = false;
+
+static void *test_post_worker(void *runtime) {
+    // Worker threads have no current runtime, so only cr_post_to reaches one
+    g_post_worker_plain = cr_post(^{ g_post_set(-1); });
+    g_post_worker_targeted = cr_post_to(runtime, ^{ g_post_set(11); });
+    return NULL;
+}
+
+TEST_CASE(test_post_from_thread) {
+    g_post_seen = -1;
+    g_post_set = NULL;
+
+    cr_begin_frame();
+    PostTestComponent();
+    cr_end_frame();
+    ASSERT_NOT_NULL(g_post_set);
+
+    pthread_t worker;
+    ASSERT_EQ(pthread_create(&worker, NULL, test_post_worker, cr_runtime_current()), 0);
+    pthread_join(worker, NULL);
+    EXPECT_FALSE(g_post_worker_plain);
+    EXPECT_TRUE(g_post_worker_targeted);
+    EXPECT_TRUE(cr_should_render());
+
+    cr_begin_frame();
+    PostTestComponent();
+    cr_end_frame();
+    EXPECT_EQ(g_post_seen, 11);
+}
+
+// ============================================================================
+// RUNTIME INSTANCE TESTS
+// ============================================================================
+
+static int g_instance_seen = -1;
+static void (^g_instance_set)(int) = NULL;
+
+$component(InstanceTestComponent) {
+    auto value = $use_state(0);
+    g_instance_set = value->set;
+    g_instance_seen = value->get();
+}
+
+static void test_instance_frame(void) {
+    cr_begin_frame();
+    InstanceTestComponent();
+    cr_end_frame();
+}
+
+TEST_CASE(test_runtime_instances) {
+    CR_Runtime *main_runtime = cr_runtime;
+    Clay_Context *main_context = Clay_GetCurrentContext();
+    Clay_ErrorHandler errors = { .errorHandlerFunction = test_error_handler };
+
+    CR_Runtime *a = cr_runtime_create((Clay_Dimensions){ 320.0f, 240.0f }, errors);
+    CR_Runtime *b = cr_runtime_create((Clay_Dimensions){ 640.0f, 480.0f }, errors);
+    ASSERT_NOT_NULL(a);
+    ASSERT_NOT_NULL(b);
+
+    // Creating a runtime leaves the caller's runtime and Clay context current
+    EXPECT_TRUE(cr_runtime_current() == main_runtime);
+    EXPECT_TRUE(Clay_GetCurrentContext() == main_context);
+
+    EXPECT_TRUE(cr_runtime_make_current(a) == main_runtime);
+    EXPECT_TRUE(Clay_GetCurrentContext() == a->clay_context);
+    test_instance_frame();
+    g_instance_set(7);
+    test_instance_frame();
+    EXPECT_EQ(g_instance_seen, 7);
+    void (^set_a)(int) = g_instance_set;
+
+    // b mounts its own tree with fresh state
+    EXPECT_TRUE(cr_runtime_make_current(b) == a);
+    EXPECT_TRUE(Clay_GetCurrentContext() == b->clay_context);
+    test_instance_frame();
+    EXPECT_EQ(g_instance_seen, 0);
+    EXPECT_EQ(b->component_count, (size_t)1);
+    EXPECT_FALSE(cr_should_render());
+
+    // A state set while b is current schedules a, not b
+    set_a(9);
+    EXPECT_FALSE(b->needs_render);
+    EXPECT_TRUE(a->needs_render);
+
+    cr_runtime_make_current(a);
+    test_instance_frame();
+    EXPECT_EQ(g_instance_seen, 9);
+
+    cr_runtime_make_current(main_runtime);
+    EXPECT_TRUE(Clay_GetCurrentContext() == main_context);
+    cr_runtime_destroy(a);
+    cr_runtime_destroy(b);
+    EXPECT_TRUE(cr_runtime == main_runtime);
+    EXPECT_TRUE(Clay_GetCurrentContext() == main_context);
+    g_instance_set = NULL;
+}
+
+static pthread_mutex_t g_layout_lock = PTHREAD_MUTEX_INITIALIZER;
+
+typedef struct {
+    CR_Runtime *runtime;
+    float width;
+    int matched;
+} TestThreadLayout;
+
+static void *test_layout_worker(void *arg) {
+    TestThreadLayout *job = arg;
+    for (int i = 0; i < 50; i++) {
+        // Clay's current context is process-wide: take the lock, then point
+        // it back at this thread's runtime
+        pthread_mutex_lock(&g_layout_lock);
+        cr_runtime_make_current(job->runtime);
+        cr_begin_frame();
+        Box((BoxParams){
+            .id = $id_lit("ThreadPanel"),
+            .style = {
+                .layout = { .sizing = { CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED(10) } },
+                .background = $rgb(10, 10, 10),
+            },
+        }, NULL);
+        Clay_RenderCommandArray commands = cr_end_frame();
+        for (int32_t j = 0; j < commands.length; j++) {
+            Clay_RenderCommand *command = Clay_RenderCommandArray_Get(&commands, j);
+            if (command->commandType == CLAY_RENDER_COMMAND_TYPE_RECTANGLE &&
+                command->boundingBox.width == job->width) {
+                job->matched++;
+                break;
+            }
+        }
+        pthread_mutex_unlock(&g_layout_lock);
+    }
+    cr_runtime_make_current(NULL);
+    return NULL;
+}
+
+TEST_CASE(test_runtime_threads) {
+    // Parks the main runtime, adopting its Clay context so it can come back
+    CR_Runtime *main_runtime = cr_runtime_make_current(NULL);
+    Clay_ErrorHandler errors = { .errorHandlerFunction = test_error_handler };
+    TestThreadLayout jobs[2] = {
+        { .runtime = cr_runtime_create((Clay_Dimensions){ 300.0f, 200.0f }, errors), .width = 300.0f },
+        { .runtime = cr_runtime_create((Clay_Dimensions){ 500.0f, 200.0f }, errors), .width = 500.0f },
+    };
+    ASSERT_NOT_NULL(jobs[0].runtime);
+    ASSERT_NOT_NULL(jobs[1].runtime);
+
+    // Two threads lay out their own runtimes, one frame at a time
+    pthread_t workers[2];
+    ASSERT_EQ(pthread_create(&workers[0], NULL, test_layout_worker, &jobs[0]), 0);
+    ASSERT_EQ(pthread_create(&workers[1], NULL, test_layout_worker, &jobs[1]), 0);
+    pthread_join(workers[0], NULL);
+    pthread_join(workers[1], NULL);
+    EXPECT_EQ(jobs[0].matched, 50);
+    EXPECT_EQ(jobs[1].matched, 50);
+
+    cr_runtime_make_current(main_runtime);
+    cr_runtime_destroy(jobs[0].runtime);
+    cr_runtime_destroy(jobs[1].runtime);
+    EXPECT_TRUE(cr_runtime == main_runtime);
+}
+
+// ============================================================================
+// ANIMATION TESTS
+// ============================================================================
+
+static uint64_t g_anim_clock_ns = 0;
+static float g_anim_target = 0.0f;
+static float g_anim_tween = -1.0f;
+static float g_anim_spring = -1.0f;
+
+static uint64_t test_anim_clock(void *user_data) {
+    (void)user_data;
+    return g_anim_clock_ns;
+}
+
+$component(AnimationTestComponent) {
+    g_anim_tween = $use_animation(g_anim_target, .duration = 1.0f, .easing = cr_ease_linear);
+    g_anim_spring = $use_spring(g_anim_target);
+}
+
+static void test_anim_frame(uint64_t advance_ns) {
+    g_anim_clock_ns += advance_ns;
+    cr_begin_frame();
+    AnimationTestComponent();
+    cr_end_frame();
+}
+
+TEST_CASE(test_animation) {
+    g_anim_clock_ns = 1000000000ull;
+    g_anim_target = 0.0f;
+    cr_set_clock(test_anim_clock, NULL);
+
+    test_anim_frame(0);
+    EXPECT_TRUE(g_anim_tween == 0.0f);
+    EXPECT_FALSE(cr_should_render());
+    EXPECT_EQ(cr_wait_timeout_ms(), -1);
+
+    // Idle frames never request more frames
+    test_anim_frame(500000000ull);
+    EXPECT_FALSE(cr_is_animating());
+    EXPECT_FALSE(cr_should_render());
+
+    g_anim_target = 10.0f;
+    test_anim_frame(16000000ull);
+    EXPECT_TRUE(g_anim_tween == 0.0f);
+    EXPECT_TRUE(cr_is_animating());
+    EXPECT_TRUE(cr_should_render());
+    EXPECT_EQ(cr_wait_timeout_ms(), 0);
+
+    test_anim_frame(500000000ull);
+    EXPECT_TRUE(g_anim_tween > 4.99f && g_anim_tween < 5.01f);
+    EXPECT_TRUE(cr_frame_delta() > 0.099f && cr_frame_delta() <= 0.1f);
+
+    test_anim_frame(500000000ull);
+    EXPECT_TRUE(g_anim_tween == 10.0f);
+
+    // The spring settles on its own at 60fps and then lets the loop sleep
+    int frames = 0;
+    while (cr_should_render() && frames < 600) {
+        test_anim_frame(16666666ull);
+        frames++;
+    }
+    EXPECT_TRUE(frames < 600);
+    EXPECT_TRUE(g_anim_spring == 10.0f);
+    EXPECT_FALSE(cr_is_animating());
+    EXPECT_EQ(cr_wait_timeout_ms(), -1);
+
+    // A future request survives frames that run before it and then clears
+    cr_request_frame_at(g_anim_clock_ns + 100000000ull);
+    test_anim_frame(16000000ull);
+    EXPECT_EQ(cr_wait_timeout_ms(), 84);
+    test_anim_frame(84000000ull);
+    EXPECT_EQ(cr_wait_timeout_ms(), -1);
+
+    cr_set_clock(NULL, NULL);
+}
+
+// ============================================================================
+// TIMER TESTS
+// ============================================================================
+
+static uint64_t g_timer_clock_ns = 0;
+static int g_timer_ticks = 0;
+static int g_timer_timeouts = 0;
+static int64_t g_timer_interval_ms = 1000;
+
+static uint64_t test_timer_clock(void *user_data) {
+    (void)user_data;
+    return g_timer_clock_ns;
+}
+
+$component(TimerTestComponent) {
+    $use_interval(^{ g_timer_ticks++; }, g_timer_interval_ms);
+    $use_timeout(^{ g_timer_timeouts++; }, 500);
+}
+
+$component(TimerEmptyComponent) {
+}
+
+static void test_timer_frame(uint64_t advance_ns) {
+    g_timer_clock_ns += advance_ns;
+    cr_begin_frame();
+    TimerTestComponent();
+    cr_end_frame();
+}
+
+TEST_CASE(test_timers) {
+    g_timer_clock_ns = 1000000000ull;
+    g_timer_ticks = 0;
+    g_timer_timeouts = 0;
+    g_timer_interval_ms = 1000;
+    cr_set_clock(test_timer_clock, NULL);
+
+    test_timer_frame(0);
+    EXPECT_EQ(cr_runtime->timer_count, (size_t)2);
+    EXPECT_FALSE(cr_should_render());
+    EXPECT_EQ(cr_wait_timeout_ms(), 500);
+
+    g_timer_clock_ns += 499000000ull;
+    EXPECT_EQ(cr_wait_timeout_ms(), 1);
+    g_timer_clock_ns += 1000000ull;
+    EXPECT_TRUE(cr_should_render());
+
+    test_timer_frame(0);
+    EXPECT_EQ(g_timer_timeouts, 1);
+    EXPECT_EQ(g_timer_ticks, 0);
+    EXPECT_EQ(cr_wait_timeout_ms(), 500);
+
+    test_timer_frame(500000000ull);
+    EXPECT_EQ(g_timer_ticks, 1);
+    EXPECT_EQ(g_timer_timeouts, 1);
+
+    // A long stall fires the interval once and skips ahead
+    test_timer_frame(3500000000ull);
+    EXPECT_EQ(g_timer_ticks, 2);
+    EXPECT_EQ(cr_wait_timeout_ms(), 1000);
+
+    // Negative delay pauses; nothing left to wait for
+    g_timer_interval_ms = -1;
+    test_timer_frame(0);
+    EXPECT_EQ(cr_runtime->timer_count, (size_t)0);
+    EXPECT_EQ(cr_wait_timeout_ms(), -1);
+
+    g_timer_interval_ms = 250;
+    test_timer_frame(0);
+    EXPECT_EQ(cr_wait_timeout_ms(), 250);
+
+    // Unmounting removes the timer from the heap
+    cr_begin_frame();
+    TimerEmptyComponent();
+    cr_end_frame();
+    EXPECT_EQ(cr_runtime->timer_count, (size_t)0);
+
+    cr_set_clock(NULL, NULL);
+}
+
+// ============================================================================
+// DEFERRED & IDLE EFFECT TESTS
+// ============================================================================
+
+static int g_deferred_passive_runs = 0;
+static int g_deferred_layout_runs = 0;
+static int g_deferred_idle_runs = 0;
+
+$component(DeferredEffectComponent) {
+    $use_effect(^{
+        g_deferred_passive_runs++;
+        return (CleanupBlock)NULL;
+    });
+    $use_layout_effect(^{
+        g_deferred_layout_runs++;
+        return (CleanupBlock)NULL;
+    });
+    $use_idle_effect(^{
+        g_deferred_idle_runs++;
+        return (CleanupBlock)NULL;
+    });
+}
+
+TEST_CASE(test_idle_effects) {
+    g_deferred_passive_runs = 0;
+    g_deferred_layout_runs = 0;
+    g_deferred_idle_runs = 0;
+    cr_set_effect_deferral(true);
+
+    cr_begin_frame();
+    DeferredEffectComponent();
+    cr_end_frame();
+
+    // Only layout effects run before the frame is handed to the backend
+    EXPECT_EQ(g_deferred_layout_runs, 1);
+    EXPECT_EQ(g_deferred_passive_runs, 0);
+    EXPECT_EQ(g_deferred_idle_runs, 0);
+
+    cr_flush_effects();
+    EXPECT_EQ(g_deferred_passive_runs, 1);
+
+    // No headroom: idle work stays queued and keeps the loop from sleeping
+    EXPECT_TRUE(cr_has_idle_work());
+    EXPECT_TRUE(cr_run_idle_effects(0));
+    EXPECT_EQ(g_deferred_idle_runs, 0);
+    EXPECT_EQ(cr_wait_timeout_ms(), 0);
+
+    // A second render before the idle slot does not queue the effect twice
+    cr_begin_frame();
+    DeferredEffectComponent();
+    cr_end_frame();
+    EXPECT_EQ(g_deferred_layout_runs, 2);
+
+    // Unflushed passive effects run at the start of the next frame
+    cr_begin_frame();
+    EXPECT_EQ(g_deferred_passive_runs, 2);
+    DeferredEffectComponent();
+    cr_end_frame();
+
+    EXPECT_FALSE(cr_run_idle_effects(1000000000ull));
+    EXPECT_EQ(g_deferred_idle_runs, 1);
+    EXPECT_FALSE(cr_has_idle_work());
+
+    cr_set_effect_deferral(false);
+    EXPECT_EQ(g_deferred_passive_runs, 3);
+}
+
+// ============================================================================
+// KEEP-ALIVE TESTS
+// ============================================================================
+
+static int g_keep_alive_tab = 0;
+static int g_keep_alive_mounts = 0;
+static int g_keep_alive_unmounts = 0;
+static int g_keep_alive_seen = -1;
+static void (^g_keep_alive_set)(int) = NULL;
+
+$component(KeepAliveTab) {
+    auto value = $use_state(0);
+    g_keep_alive_set = value->set;
+    g_keep_alive_seen = value->get();
+    $use_effect(^{
+        g_keep_alive_mounts++;
+        return ^{ g_keep_alive_unmounts++; };
+    }, $deps_once());
+}
+
+$component(KeepAliveTestComponent) {
+    $keep_alive(cr_id("tab0"), g_keep_alive_tab == 0) {
+        KeepAliveTab();
+    }
+    $keep_alive(cr_id("tab1"), g_keep_alive_tab == 1) {
+        KeepAliveTab();
+    }
+    $keep_alive(cr_id("tab2"), g_keep_alive_tab == 2) {
+        KeepAliveTab();
+    }
+}
+
+static bool g_keep_alive_bail = false;
+
+$component(KeepAliveBailComponent) {
+    $keep_alive(cr_id("bail"), true) {
+        KeepAliveTab();
+        if (g_keep_alive_bail) break;
+        KeepAliveTab();
+    }
+}
+
+static void test_keep_alive_frame(int tab) {
+    g_keep_alive_tab = tab;
+    cr_begin_frame();
+    KeepAliveTestComponent();
+    cr_end_frame();
+}
+
+TEST_CASE(test_keep_alive) {
+    g_keep_alive_mounts = 0;
+    g_keep_alive_unmounts = 0;
+    g_keep_alive_set = NULL;
+
+    test_keep_alive_frame(0);
+    EXPECT_EQ(g_keep_alive_mounts, 1);
+    ASSERT_NOT_NULL(g_keep_alive_set);
+    g_keep_alive_set(7);
+
+    // Hiding tab 0 keeps its state; showing it again does not remount
+    test_keep_alive_frame(1);
+    EXPECT_EQ(g_keep_alive_mounts, 2);
+    EXPECT_EQ(g_keep_alive_unmounts, 0);
+    EXPECT_EQ(g_keep_alive_seen, 0);
+
+    test_keep_alive_frame(0);
+    EXPECT_EQ(g_keep_alive_mounts, 2);
+    EXPECT_EQ(g_keep_alive_unmounts, 0);
+    EXPECT_EQ(g_keep_alive_seen, 7);
+
+    // With a cap of one hidden subtree, the least recently shown is dropped
+    cr_set_keep_alive_limit(1);
+    test_keep_alive_frame(2);
+    EXPECT_EQ(g_keep_alive_mounts, 3);
+    EXPECT_EQ(g_keep_alive_unmounts, 1);
+
+    test_keep_alive_frame(0);
+    EXPECT_EQ(g_keep_alive_mounts, 3);
+    EXPECT_EQ(g_keep_alive_seen, 7);
+
+    test_keep_alive_frame(1);
+    EXPECT_EQ(g_keep_alive_mounts, 4);
+    EXPECT_EQ(g_keep_alive_seen, 0);
+
+    cr_set_keep_alive_limit(0);
+
+    // Leaving the body early still closes the boundary
+    g_keep_alive_bail = true;
+    cr_begin_frame();
+    size_t depth = cr_runtime->component_stack_count;
+    KeepAliveBailComponent();
+    EXPECT_EQ(cr_runtime->component_stack_count, depth);
+    cr_end_frame();
+    g_keep_alive_bail = false;
+}
+
+// ============================================================================
+// GARBAGE COLLECTION TESTS
+// ============================================================================
+
+static int g_gc_rows = 0;
+static bool g_gc_swap_head = false;
+static int g_gc_unmounts = 0;
+static int g_gc_head_mounts = 0;
+
+$component(GcRow) {
+    $use_effect(^{
+        return ^{ g_gc_unmounts++; };
+    }, $deps_once());
+}
+
+$component(GcHeadA) {
+    $use_effect(^{
+        g_gc_head_mounts++;
+        return (CleanupBlock)NULL;
+    }, $deps_once());
+}
+
+$component(GcHeadB) {
+    $use_effect(^{
+        g_gc_head_mounts++;
+        return (CleanupBlock)NULL;
+    }, $deps_once());
+}
+
+$component(GcList) {
+    if (g_gc_swap_head) {
+        GcHeadB();
+    } else {
+        GcHeadA();
+    }
+    for (int i = 0; i < g_gc_rows; i++) {
+        $keyi("GcRow", (uint32_t)i);
+        GcRow();
+    }
+}
+
+static void test_gc_frame(void) {
+    cr_begin_frame();
+    GcList();
+    cr_end_frame();
+}
+
+TEST_CASE(test_incremental_gc) {
+    g_gc_rows = 10000;
+    g_gc_swap_head = false;
+    g_gc_unmounts = 0;
+    g_gc_head_mounts = 0;
+
+    test_gc_frame();
+    size_t baseline = cr_runtime->component_count;
+    EXPECT_EQ(baseline, (size_t)10002);
+
+    // Dropping half the rows unmounts exactly the unvisited tail
+    g_gc_rows = 5000;
+    test_gc_frame();
+    EXPECT_EQ(g_gc_unmounts, 5000);
+    EXPECT_EQ(cr_runtime->component_count, (size_t)5002);
+
+    // A positional type change replaces the slot without disturbing the rows
+    g_gc_swap_head = true;
+    test_gc_frame();
+    EXPECT_EQ(g_gc_head_mounts, 2);
+    EXPECT_EQ(g_gc_unmounts, 5000);
+    EXPECT_EQ(cr_runtime->component_count, (size_t)5002);
+
+    g_gc_rows = 0;
+    test_gc_frame();
+    EXPECT_EQ(g_gc_unmounts, 10000);
+    EXPECT_EQ(cr_runtime->component_count, (size_t)2);
+}
+
 TEST_SUITE_SETUP(clay_react_suite_setup) {
     init_clay_once();
     cr_init();
@@ -496,15 +496,14 @@ $component(TodoRow, TodoRowProps) {
             if (props->is_editing) {
                 Button((ButtonParams){
                     .id = cr_idi("TodoSave", (uint32_t)item->id),
-                    .label = "Save",
+                    .label_str = $lit("Save"),
                     .on_click = ^{
                         if (!props->state || !props->set_state || !item) {
                             return;
                         }
                         TodoState next = *props->state;
                         if (item->input && item->input->length > 0) {
-                            strncpy(next.items[props->index].title, item->input->buffer, TITLE_MAX - 1);
-                            next.items[props->index].title[TITLE_MAX - 1] = '\0';
+                            _cr_text_input_copy(item->input, next.items[props->index].title, TITLE_MAX);
                         }
                         next.editing_id = -1;
                         next.version++;
@@ -527,7 +526,7 @@ $component(TodoRow, TodoRowProps) {
 
                 IconButton((IconButtonParams){
                     .id = cr_idi("TodoCancel", (uint32_t)item->id),
-                    .icon = "x",
+                    .icon_str = $lit("x"),
                     .on_click = ^{
                         if (!props->state || !props->set_state) {
                             return;
@@ -574,7 +573,7 @@ $component(TodoRow, TodoRowProps) {
                 if (confirm->get()) {
                     Button((ButtonParams){
                     .id = cr_idi("TodoConfirm", (uint32_t)item->id),
-                    .label = "Sure",
+                    .label_str = $lit("Sure"),
                     .on_click = ^{
                         if (!props->state || !props->set_state || props->index < 0 || props->index >= props->state->count) {
                             return;
@@ -583,13 +582,7 @@ $component(TodoRow, TodoRowProps) {
                         TodoItem *next_item = &next.items[props->index];
                         int deleted_id = next_item->id;
 
-                        if (_cr_focused_input == next_item->input) {
-                            _cr_unfocus_input();
-                        }
-                        if (next_item->input) {
-                            free(next_item->input->buffer);
-                            free(next_item->input);
-                        }
+                        _cr_free_text_input(next_item->input);
 
                         for (int i = props->index; i < next.count - 1; i++) {
                             next.items[i] = next.items[i + 1];
@@ -617,7 +610,7 @@ $component(TodoRow, TodoRowProps) {
 
                     IconButton((IconButtonParams){
                         .id = cr_idi("TodoCancelDelete", (uint32_t)item->id),
-                        .icon = "x",
+                        .icon_str = $lit("x"),
                         .on_click = ^{
                             if (confirm) confirm->set(false);
                         },
@@ -630,7 +623,7 @@ $component(TodoRow, TodoRowProps) {
                 } else {
                     IconButton((IconButtonParams){
                         .id = cr_idi("TodoDelete", (uint32_t)item->id),
-                        .icon = "del",
+                        .icon_str = $lit("del"),
                         .on_click = ^{
                             if (confirm) confirm->set(true);
                         },
@@ -739,8 +732,7 @@ $component(TodoAppView) {
         item->pinned = false;
         item->priority = next.draft_priority;
         item->tag = next.draft_tag;
-        strncpy(item->title, new_input->buffer, TITLE_MAX - 1);
-        item->title[TITLE_MAX - 1] = '\0';
+        _cr_text_input_copy(new_input, item->title, TITLE_MAX);
         item->input = _cr_alloc_text_input(TITLE_MAX);
         _cr_text_input_set_text(item->input, item->title);
 
@@ -763,13 +755,7 @@ $component(TodoAppView) {
         for (int i = 0; i < next.count; i++) {
             TodoItem *item = &next.items[i];
             if (item->done) {
-                if (_cr_focused_input == item->input) {
-                    _cr_unfocus_input();
-                }
-                if (item->input) {
-                    free(item->input->buffer);
-                    free(item->input);
-                }
+                _cr_free_text_input(item->input);
                 continue;
             }
 
@@ -816,12 +802,16 @@ $component(TodoAppView) {
     int visible[MAX_TODOS];
     int visible_count = 0;
     int *visible_ptr = visible;
+    char query[TITLE_MAX];
+    if (search_input) {
+        _cr_text_input_copy(search_input, query, sizeof(query));
+    }
     for (int i = 0; i < state->ptr->count; i++) {
         TodoItem *item = &state->ptr->items[i];
         if (state->ptr->filter == TODO_FILTER_ACTIVE && item->done) continue;
         if (state->ptr->filter == TODO_FILTER_DONE && !item->done) continue;
         if (!state->ptr->show_done && item->done) continue;
-        if (search_input && !todo_contains_case_insensitive(item->title, search_input->buffer)) continue;
+        if (search_input && !todo_contains_case_insensitive(item->title, query)) continue;
         visible[visible_count++] = i;
     }
     todo_sort_indices(visible, visible_count, state->ptr->items, state->ptr->sort);
@@ -885,7 +875,7 @@ $component(TodoAppView) {
         TextInput((TextInputParams){
             .id = search_input_id,
             .state = search_input,
-            .placeholder = "Search tasks",
+            .placeholder_str = $lit("Search tasks"),
             .text = text_style_body(theme),
             .placeholder_text = text_style_muted(theme),
             .style = {
@@ -908,7 +898,7 @@ $component(TodoAppView) {
         TextInput((TextInputParams){
             .id = new_input_id,
             .state = new_input,
-            .placeholder = "Add a task",
+            .placeholder_str = $lit("Add a task"),
             .text = text_style_body(theme),
             .placeholder_text = text_style_muted(theme),
             .style = {
@@ -930,7 +920,7 @@ $component(TodoAppView) {
     VoidBlock render_add_button = ^{
         Button((ButtonParams){
             .id = cr_id("TodoAdd"),
-            .label = "Add",
+            .label_str = $lit("Add"),
             .on_click = add_todo,
             .style = {
                 .layout = {
@@ -966,7 +956,7 @@ $component(TodoAppView) {
             Column((BoxParams){ .style.layout.childGap = todo_px(12) }, ^{
                 Column((BoxParams){ .style.layout.childGap = todo_px(4) }, ^{
                     Text((TextParams){
-                        .text = "Todo Atlas",
+                        .str = $lit("Todo Atlas"),
                         .style = text_style_title(theme),
                     });
                     Text((TextParams){
@@ -1007,7 +997,7 @@ $component(TodoAppView) {
             Row((BoxParams){ .style.layout.childGap = todo_px(16) }, ^{
                 Column((BoxParams){ .style.layout.childGap = todo_px(4) }, ^{
                     Text((TextParams){
-                        .text = "Todo Atlas",
+                        .str = $lit("Todo Atlas"),
                         .style = text_style_title(theme),
                     });
                     Text((TextParams){
@@ -1111,7 +1101,7 @@ $component(TodoAppView) {
                 Column((BoxParams){
                     .style = { .layout = { .childGap = todo_px(6) } },
                 }, ^{
-                    Text((TextParams){ .text = "Priority", .style = text_style_muted(theme) });
+                    Text((TextParams){ .str = $lit("Priority"), .style = text_style_muted(theme) });
                     Row((BoxParams){
                         .style = { .layout = { .childGap = todo_px(8) } },
                     }, ^{
@@ -1149,7 +1139,7 @@ $component(TodoAppView) {
                 Column((BoxParams){
                     .style = { .layout = { .childGap = todo_px(6) } },
                 }, ^{
-                    Text((TextParams){ .text = "Tag", .style = text_style_muted(theme) });
+                    Text((TextParams){ .str = $lit("Tag"), .style = text_style_muted(theme) });
                     Row((BoxParams){
                         .style = { .layout = { .childGap = todo_px(8) } },
                     }, ^{
@@ -1221,7 +1211,7 @@ $component(TodoAppView) {
                 Row((BoxParams){
                     .style = { .layout = { .childGap = todo_px(8) } },
                 }, ^{
-                    Text((TextParams){ .text = "Priority", .style = text_style_muted(theme) });
+                    Text((TextParams){ .str = $lit("Priority"), .style = text_style_muted(theme) });
                     for (int i = 0; i < 3; i++) {
                         bool active = state->ptr->draft_priority == (TodoPriority)i;
                         Clay_Color pr = todo_priority_color((TodoPriority)i, theme);
@@ -1255,7 +1245,7 @@ $component(TodoAppView) {
                 Row((BoxParams){
                     .style = { .layout = { .childGap = todo_px(8) } },
                 }, ^{
-                    Text((TextParams){ .text = "Tag", .style = text_style_muted(theme) });
+                    Text((TextParams){ .str = $lit("Tag"), .style = text_style_muted(theme) });
                     for (int i = 0; i < todo_tag_count(); i++) {
                         bool active = state->ptr->draft_tag == (uint8_t)i;
                         Clay_Color tag = k_tag_colors[i];
@@ -1317,7 +1307,7 @@ $component(TodoAppView) {
                     },
                 }, ^{
                     Text((TextParams){
-                        .text = "No tasks here. Add one above.",
+                        .str = $lit("No tasks here. Add one above."),
                         .style = text_style_muted(theme),
                     });
                 });
@@ -1346,14 +1336,14 @@ $component(TodoAppView) {
                     .border_color = theme->text_muted,
                     .size = todo_px(18),
                 });
-                Text((TextParams){ .text = "Show done", .style = text_style_muted(theme) });
+                Text((TextParams){ .str = $lit("Show done"), .style = text_style_muted(theme) });
             });
 
             Spacer();
 
             Button((ButtonParams){
                 .id = cr_id("TodoClearDone"),
-                .label = "Clear done",
+                .label_str = $lit("Clear done"),
                 .on_click = clear_done,
                 .style = {
                     .layout = {
@@ -1369,7 +1359,7 @@ $component(TodoAppView) {
 
             Button((ButtonParams){
                 .id = cr_id("TodoToggleAll"),
-                .label = "Toggle all",
+                .label_str = $lit("Toggle all"),
                 .on_click = toggle_all,
                 .style = {
                     .layout = {
@@ -9,7 +9,7 @@ set_toolchains("clang")
 option("clay-backend")
     set_default("sdl3")
     set_showmenu(true)
-    set_values("sdl3", "sdl2", "cairo", "xcb", "raylib", "sokol", "terminal", "web", "win32_gdi", "playdate")
+    set_values("sdl3", "sdl2", "cairo", "xcb", "raylib", "sokol", "terminal", "headless", "web", "win32_gdi", "playdate")
     set_description("Clay renderer backend for Clay React apps")
 option_end()
 
@@ -101,11 +101,39 @@ local clay_react_test_cases = {
     "test_callback",
     "test_ref",
     "test_use_id",
+    "test_id_hash",
+    "test_str",
+    "test_compiled_style",
+    "test_hover_scroll_events",
+    "test_paint_frame",
+    "test_event_routing",
+    "test_key_shortcut_keeps_editing",
+    "test_scroll_momentum",
+    "test_scroll_translation",
+    "test_scroll_wheel_distance",
+    "test_scroll_drag_coast",
+    "test_scroll_taller_than_window",
+    "test_formatted_text",
+    "test_paragraph",
+    "test_state_snapshot",
+    "test_frame_trace",
     "test_text_input",
+    "test_text_input_editing",
+    "test_text_input_view",
+    "test_text_area",
     "test_click_handler_props",
     "test_keyed_components",
     "test_context",
     "test_signal",
+    "test_post",
+    "test_post_from_thread",
+    "test_runtime_instances",
+    "test_runtime_threads",
+    "test_animation",
+    "test_timers",
+    "test_idle_effects",
+    "test_keep_alive",
+    "test_incremental_gc",
 }
 
 includes("reflect", "clay_react", "clay-react++", "todo_app", "todo-app++")
@@ -138,6 +166,38 @@ target("clay_react_tests")
     add_deps("clay_react", "reflect")
     add_packages("clay")
     add_links("BlocksRuntime")
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
     for _, name in ipairs(clay_react_test_cases) do
         add_tests(name, {runargs = name})
     end
+
+-- Clay React benchmarks (xmake f -m release; xmake run clay_react_bench [workload] [frames])
+target("clay_react_bench")
+    set_kind("binary")
+    set_default(false)
+    add_files("tests/clay_react_bench.c")
+    add_cflags("-Wno-missing-braces")
+    add_cflags("-fblocks")
+    add_includedirs("clay_react/src", "reflect/src")
+    add_deps("clay_react", "reflect")
+    add_packages("clay")
+    add_links("BlocksRuntime")
+
+-- Clay React trace replay (record with CR_APP_TRACE=<file>; xmake run clay_react_replay <file> [loops] [font])
+target("clay_react_replay")
+    set_kind("binary")
+    set_default(false)
+    add_files("tests/clay_react_replay.c")
+    add_cflags("-Wno-missing-braces")
+    add_cflags("-fblocks")
+    add_includedirs("clay_react/src", "reflect/src")
+    add_deps("clay_react")
+    add_packages("clay")
+    add_links("BlocksRuntime")
+    if renderer == "sdl3" then
+        add_defines("CLAY_RENDERER_SDL3")
+    elseif renderer == "xcb" then
+        add_defines("CLAY_RENDERER_XCB")
+    end